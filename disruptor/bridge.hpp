@@ -0,0 +1,641 @@
+/** Network bridge: distributors that send the batches a ring hands them to another machine, and receivers that publish
+ *  them into a remote Sequencer with range claims. UDP (unicast or multicast) recovers lost packets by replay, TCP relies
+ *  on the stream.
+ *  Add a bridge distributor to a ParallelDistributor with make_connector(), it then sends one burst of packets per
+ *  batch the ring makes available. */
+/** Wire format:
+ *    every packet starts with a BridgePacketHeader. Data packets carry count events numbered from first_sequence, the
+ *    bridge's own sequence starting at 0. A receiver seeing data past the next sequence it expects drops it and sends a
+ *    Replay packet asking for the events from that sequence; the sender answers with Data, or with Gone for the events
+ *    already out of its history, which the receiver skips and counts in lost().
+ *  Events are sent in host byte order, both ends must share the event layout.
+ */
+#ifndef __DISRUPTOR__BRIDGE_HPP__
+#define __DISRUPTOR__BRIDGE_HPP__
+#include "handler.hpp"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace disruptor {
+
+constexpr uint32_t kBridgeMagic = 0x47445242; // "BRDG"
+constexpr uint16_t kBridgeVersion = 1;
+constexpr size_t kMaxBridgeDatagram = 65507; //largest UDP payload over IPv4
+
+enum class BridgePacketKind : uint16_t { Data = 1, Replay = 2, Gone = 3 };
+
+struct BridgePacketHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t kind;
+    uint32_t event_size;
+    uint32_t count;
+    int64_t first_sequence;
+};
+
+/** IPv4 address of a bridge end, throws std::invalid_argument if host is not a dotted address. */
+inline sockaddr_in bridgeAddress(const std::string& host, uint16_t port) {
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    if (inet_pton(AF_INET, host.c_str(), &address.sin_addr) != 1)
+        throw std::invalid_argument("not an IPv4 address: " + host);
+    return address;
+}
+
+/** Port a socket is bound to, e.g. after binding port 0. */
+inline uint16_t bridgePort(int fd) {
+    sockaddr_in address;
+    socklen_t length = sizeof(address);
+    if (getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length) != 0) return 0;
+    return ntohs(address.sin_port);
+}
+
+inline BridgePacketHeader bridgeHeader(BridgePacketKind kind, size_t event_size, int64_t first, size_t count) {
+    return BridgePacketHeader{kBridgeMagic, kBridgeVersion, static_cast<uint16_t>(kind),
+                              static_cast<uint32_t>(event_size), static_cast<uint32_t>(count), first};
+}
+
+inline bool isBridgeHeader(const BridgePacketHeader& header, size_t event_size) {
+    return header.magic == kBridgeMagic && header.version == kBridgeVersion && header.event_size == event_size;
+}
+
+/** Wait for fd to be ready, false on timeout. */
+inline bool bridgeWait(int fd, short events, std::chrono::milliseconds timeout) {
+    pollfd ready{fd, events, 0};
+    return poll(&ready, 1, static_cast<int>(timeout.count())) > 0;
+}
+
+struct UdpBridgeOptions {
+    /** Events kept for replays, a power of 2. */
+    size_t history = 1ul << 16;
+    /** Events per datagram, 0 to fill a 1500 bytes MTU. */
+    size_t events_per_packet = 0;
+    /** Datagrams handed to a single sendmmsg/recvmmsg. */
+    size_t packets_per_call = 32;
+    /** Multicast hops, and whether the sending host receives its own multicast packets. */
+    int multicast_ttl = 1;
+    bool multicast_loop = true;
+    /** Minimum time between two replay requests for the same gap. */
+    std::chrono::microseconds replay_interval{1000};
+};
+
+/** Sends each batch of events as sequenced datagrams, several per sendmmsg, to a unicast or multicast address.
+ *  Events are copied once, into the replay history the datagrams are sent from. Replay requests are served on each
+ *  flush, call serviceReplays() to serve them while no event is sent. */
+template <class T>
+class UdpBridgeDistributor : public Distributor<T> {
+public:
+    using DATA_TYPE = T;
+    static_assert(std::is_trivially_copyable<T>::value, "bridged events must be trivially copyable");
+
+    UdpBridgeDistributor(const std::string& host, uint16_t port, const UdpBridgeOptions& options_ = UdpBridgeOptions())
+    : options(options_)
+    , destination(bridgeAddress(host, port))
+    {
+        if (sizeof(BridgePacketHeader) + sizeof(T) > kMaxBridgeDatagram)
+            throw std::invalid_argument("events do not fit in a datagram");
+        if (options.events_per_packet == 0)
+            options.events_per_packet = std::max<size_t>(1, (1472 - sizeof(BridgePacketHeader)) / sizeof(T));
+        options.events_per_packet = std::min(options.events_per_packet,
+                                             (kMaxBridgeDatagram - sizeof(BridgePacketHeader)) / sizeof(T));
+        if (options.packets_per_call == 0) options.packets_per_call = 1;
+        if (!disruptor::IsPowerOfTwo(options.history) || options.history < options.events_per_packet * options.packets_per_call)
+            throw std::invalid_argument("the history must be a power of 2 holding a full send");
+        history.reset(new T[options.history]);
+        fd = socket(AF_INET, SOCK_DGRAM, 0);
+        if (fd < 0) throw std::system_error(errno, std::generic_category(), "socket");
+        if (IN_MULTICAST(ntohl(destination.sin_addr.s_addr))) {
+            const unsigned char ttl = static_cast<unsigned char>(options.multicast_ttl);
+            const unsigned char loop = options.multicast_loop ? 1 : 0;
+            setsockopt(fd, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+            setsockopt(fd, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop));
+        }
+        messages.resize(options.packets_per_call);
+        headers.resize(options.packets_per_call);
+        iovs.resize(3 * options.packets_per_call);
+    }
+
+    virtual ~UdpBridgeDistributor() {
+        flush();
+        close(fd);
+    }
+
+    virtual void distribute(const DATA_TYPE* pMD) noexcept override { distributeEvent(pMD, next_sequence, true); }
+
+    virtual void distributeEvent(const DATA_TYPE* pMD, int64_t /*sequence*/, bool end_of_batch) noexcept override {
+        history[next_sequence & (options.history - 1)] = *pMD;
+        ++next_sequence;
+        if (end_of_batch || next_sequence - unsent >= static_cast<int64_t>(options.events_per_packet * options.packets_per_call))
+            flush();
+    }
+
+    virtual void distributeBatch(const DATA_TYPE* events, size_t n) noexcept override {
+        for(size_t i = 0; i < n; ++i) distributeEvent(events + i, next_sequence, i + 1 == n);
+    }
+
+    /** Send the events not sent yet, then serve the pending replay requests. */
+    void flush() noexcept {
+        if (unsent < next_sequence) sendRange(destination, unsent, next_sequence);
+        unsent = next_sequence;
+        serviceReplays();
+    }
+
+    /** Answer the replay requests received so far, without waiting for more. */
+    void serviceReplays() noexcept {
+        BridgePacketHeader request;
+        sockaddr_in from;
+        socklen_t length = sizeof(from);
+        while (recvfrom(fd, &request, sizeof(request), MSG_DONTWAIT, reinterpret_cast<sockaddr*>(&from), &length)
+               == static_cast<ssize_t>(sizeof(request))) {
+            length = sizeof(from);
+            if (!isBridgeHeader(request, sizeof(T)) || request.kind != static_cast<uint16_t>(BridgePacketKind::Replay)) continue;
+            int64_t first = std::max<int64_t>(request.first_sequence, 0);
+            const int64_t end = std::min<int64_t>(request.first_sequence + request.count, unsent);
+            const int64_t oldest = std::max<int64_t>(0, next_sequence - static_cast<int64_t>(options.history));
+            if (first < oldest) {
+                //the events were overwritten in the history, the receiver skips them
+                BridgePacketHeader gone = bridgeHeader(BridgePacketKind::Gone, sizeof(T), first, std::min(oldest, end) - first);
+                sendto(fd, &gone, sizeof(gone), 0, reinterpret_cast<const sockaddr*>(&from), sizeof(from));
+                first = oldest;
+            }
+            if (first < end) {
+                sendRange(from, first, end);
+                replayed_ += end - first;
+            }
+        }
+    }
+
+    /** Events handed to the bridge, the next bridge sequence. */
+    int64_t sent() const noexcept { return next_sequence; }
+    /** Events sent again on replay requests. */
+    uint64_t replayed() const noexcept { return replayed_; }
+    /** Datagrams the socket refused, receivers recover them by replay. */
+    uint64_t sendErrors() const noexcept { return send_errors; }
+    size_t eventsPerPacket() const noexcept { return options.events_per_packet; }
+
+protected:
+    /** Send the events [first, end) of the history to an address, packets_per_call datagrams at a time. */
+    void sendRange(const sockaddr_in& to, int64_t first, int64_t end) noexcept {
+        while (first < end) {
+            size_t packets = 0;
+            for(; packets < options.packets_per_call && first < end; ++packets) {
+                const size_t count = std::min<int64_t>(end - first, options.events_per_packet);
+                headers[packets] = bridgeHeader(BridgePacketKind::Data, sizeof(T), first, count);
+                iovec* iov = &iovs[3 * packets];
+                iov[0] = iovec{&headers[packets], sizeof(BridgePacketHeader)};
+                //a packet wrapping the history is sent from its two spans
+                const size_t slot = first & (options.history - 1);
+                const size_t head = std::min(count, options.history - slot);
+                iov[1] = iovec{&history[slot], head * sizeof(T)};
+                iov[2] = iovec{&history[0], (count - head) * sizeof(T)};
+                msghdr& message = messages[packets].msg_hdr;
+                std::memset(&messages[packets], 0, sizeof(mmsghdr));
+                message.msg_name = const_cast<sockaddr_in*>(&to);
+                message.msg_namelen = sizeof(to);
+                message.msg_iov = iov;
+                message.msg_iovlen = head < count ? 3 : 2;
+                first += count;
+            }
+            sendPackets(messages.data(), packets);
+        }
+    }
+
+    /** Hand datagrams to the socket, the ones it refuses are counted and left to replays. */
+    virtual void sendPackets(mmsghdr* batch, size_t packets) noexcept {
+        size_t done = 0;
+        while (done < packets) {
+            const int sent_now = sendmmsg(fd, batch + done, packets - done, 0);
+            if (sent_now > 0) done += sent_now;
+            else if (errno != EINTR) {
+                send_errors += packets - done;
+                return;
+            }
+        }
+    }
+
+    UdpBridgeOptions options;
+    sockaddr_in destination;
+    int fd = -1;
+    std::unique_ptr<T[]> history;
+    int64_t next_sequence = 0;
+    int64_t unsent = 0; //first event not sent yet
+    uint64_t replayed_ = 0;
+    uint64_t send_errors = 0;
+    std::vector<mmsghdr> messages;
+    std::vector<BridgePacketHeader> headers;
+    std::vector<iovec> iovs;
+};
+
+/** Receives a UdpBridgeDistributor's datagrams, recvmmsg at a time, and publishes them in order into a remote sequencer
+ *  with one range claim per datagram. Gaps are replayed from the sender, a loss is noticed with the next datagram
+ *  received and asked again while none comes, the sender answers when it flushes or serves its replays. The receiver starts at the first sequence it
+ *  receives, so one joining late starts with the live stream. */
+template <class T, std::size_t N = 1024ul, typename C = disruptor::kDefaultClaimStrategyTemplate<N>, typename W = disruptor::kDefaultWaitStrategy>
+class UdpBridgeReceiver {
+public:
+    using DATA_TYPE = T;
+    using SEQUENCER_TYPE = disruptor::Sequencer<T, N, C, W>;
+    static_assert(std::is_trivially_copyable<T>::value, "bridged events must be trivially copyable");
+
+    /** Receive on port, 0 for any (see port()), joining the multicast group when one is given.
+     *  The sequencer's consumers must be gating it already. */
+    UdpBridgeReceiver(SEQUENCER_TYPE& sequencer_, uint16_t port_, const std::string& group = "",
+                      const UdpBridgeOptions& options_ = UdpBridgeOptions())
+    : sequencer(sequencer_)
+    , options(options_)
+    {
+        if (options.packets_per_call == 0) options.packets_per_call = 1;
+        fd = socket(AF_INET, SOCK_DGRAM, 0);
+        if (fd < 0) throw std::system_error(errno, std::generic_category(), "socket");
+        const int reuse = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        sockaddr_in local = bridgeAddress("0.0.0.0", port_);
+        if (bind(fd, reinterpret_cast<sockaddr*>(&local), sizeof(local)) != 0) {
+            close(fd);
+            throw std::system_error(errno, std::generic_category(), "bind");
+        }
+        if (!group.empty()) {
+            ip_mreq membership;
+            membership.imr_multiaddr = bridgeAddress(group, port_).sin_addr;
+            membership.imr_interface.s_addr = htonl(INADDR_ANY);
+            if (setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership, sizeof(membership)) != 0) {
+                close(fd);
+                throw std::system_error(errno, std::generic_category(), "join " + group);
+            }
+        }
+        buffers.resize(options.packets_per_call * kMaxBridgeDatagram);
+        messages.resize(options.packets_per_call);
+        iovs.resize(options.packets_per_call);
+        sources.resize(options.packets_per_call);
+    }
+
+    virtual ~UdpBridgeReceiver() {
+        stop();
+        close(fd);
+    }
+
+    /** Receive from a thread of its own until stop(). */
+    void start() {
+        if (work_thread.joinable()) return;
+        stopping.store(false, std::memory_order_release);
+        work_thread = std::thread([this] {
+            while (!stopping.load(std::memory_order_acquire)) receive(std::chrono::milliseconds(100));
+        });
+    }
+    void stop() noexcept {
+        stopping.store(true, std::memory_order_release);
+        if (work_thread.joinable()) work_thread.join();
+    }
+
+    /** Publish the datagrams received within timeout, returns the number of events published.
+     *  Only call it from one thread, and not once start() was called. */
+    size_t receive(std::chrono::milliseconds timeout) {
+        if (!bridgeWait(fd, POLLIN, timeout)) {
+            //nothing came to reveal the gap again, ask once more
+            const int64_t expected = expected_.load(std::memory_order_relaxed);
+            if (highest > expected) requestReplay(expected, highest, gap_source);
+            return 0;
+        }
+        for(size_t i = 0; i < options.packets_per_call; ++i) {
+            iovs[i] = iovec{&buffers[i * kMaxBridgeDatagram], kMaxBridgeDatagram};
+            std::memset(&messages[i], 0, sizeof(mmsghdr));
+            messages[i].msg_hdr.msg_iov = &iovs[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+            messages[i].msg_hdr.msg_name = &sources[i];
+            messages[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+        }
+        const int packets = recvmmsg(fd, messages.data(), options.packets_per_call, MSG_DONTWAIT, nullptr);
+        size_t published = 0;
+        for(int i = 0; i < packets; ++i) {
+            published += handle(&buffers[i * kMaxBridgeDatagram], messages[i].msg_len, sources[i]);
+        }
+        return published;
+    }
+
+    uint16_t port() const noexcept { return bridgePort(fd); }
+    /** Next bridge sequence expected, -1 until the first datagram. */
+    int64_t expected() const noexcept { return expected_.load(std::memory_order_acquire); }
+    /** Events published into the sequencer. */
+    uint64_t received() const noexcept { return received_.load(std::memory_order_relaxed); }
+    /** Replay requests sent for gaps. */
+    uint64_t replayRequests() const noexcept { return replay_requests.load(std::memory_order_relaxed); }
+    /** Events the sender could not replay any more, skipped. */
+    uint64_t lost() const noexcept { return lost_.load(std::memory_order_relaxed); }
+    /** Datagrams dropped as already published or malformed. */
+    uint64_t discarded() const noexcept { return discarded_.load(std::memory_order_relaxed); }
+
+protected:
+    size_t handle(const char* packet, size_t length, const sockaddr_in& source) {
+        BridgePacketHeader header;
+        if (length < sizeof(header)) return discard();
+        std::memcpy(&header, packet, sizeof(header));
+        if (!isBridgeHeader(header, sizeof(T))) return discard();
+        int64_t expected = expected_.load(std::memory_order_relaxed);
+        if (expected < 0) expected = header.first_sequence;
+        const int64_t end = header.first_sequence + header.count;
+        if (header.kind == static_cast<uint16_t>(BridgePacketKind::Gone)) {
+            if (header.first_sequence <= expected && expected < end) {
+                lost_.fetch_add(end - expected, std::memory_order_relaxed);
+                expected_.store(end, std::memory_order_release);
+            }
+            return 0;
+        }
+        if (header.kind != static_cast<uint16_t>(BridgePacketKind::Data) ||
+            length < sizeof(header) + header.count * sizeof(T)) return discard();
+        if (end <= expected) return discard();
+        if (header.first_sequence > expected) {
+            //go back to the gap: later datagrams are dropped until the replay fills it
+            highest = std::max(highest, end);
+            gap_source = source;
+            requestReplay(expected, highest, source);
+            expected_.store(expected, std::memory_order_release);
+            return discard();
+        }
+        const T* events = reinterpret_cast<const T*>(packet + sizeof(header)) + (expected - header.first_sequence);
+        size_t remaining = end - expected;
+        while (remaining > 0) {
+            const size_t n = std::min(remaining, sequencer.size());
+            disruptor::SequenceRange<T> range = sequencer.ClaimRange(n);
+            std::memcpy(range.head(), events, range.head_size() * sizeof(T));
+            std::memcpy(range.tail(), events + range.head_size(), range.tail_size() * sizeof(T));
+            sequencer.Publish(range);
+            events += n;
+            remaining -= n;
+        }
+        received_.fetch_add(end - expected, std::memory_order_relaxed);
+        expected_.store(end, std::memory_order_release);
+        return end - expected;
+    }
+
+    void requestReplay(int64_t first, int64_t end, const sockaddr_in& source) {
+        const auto now = std::chrono::steady_clock::now();
+        if (first == requested && now - requested_at < options.replay_interval) return;
+        requested = first;
+        requested_at = now;
+        BridgePacketHeader request = bridgeHeader(BridgePacketKind::Replay, sizeof(T), first, end - first);
+        sendto(fd, &request, sizeof(request), 0, reinterpret_cast<const sockaddr*>(&source), sizeof(source));
+        replay_requests.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    size_t discard() {
+        discarded_.fetch_add(1, std::memory_order_relaxed);
+        return 0;
+    }
+
+    SEQUENCER_TYPE& sequencer;
+    UdpBridgeOptions options;
+    int fd = -1;
+    std::vector<char> buffers;
+    std::vector<mmsghdr> messages;
+    std::vector<iovec> iovs;
+    std::vector<sockaddr_in> sources;
+    std::atomic<int64_t> expected_{-1};
+    std::atomic<uint64_t> received_{0};
+    std::atomic<uint64_t> replay_requests{0};
+    std::atomic<uint64_t> lost_{0};
+    std::atomic<uint64_t> discarded_{0};
+    int64_t highest = -1; //end of the datagrams dropped past a gap
+    sockaddr_in gap_source;
+    int64_t requested = -1; //gap of the last replay request
+    std::chrono::steady_clock::time_point requested_at;
+    std::atomic<bool> stopping{false};
+    std::thread work_thread;
+};
+
+/** Sends each batch of events with a single sendmsg of a BridgePacketHeader and the events, over a TCP connection.
+ *  The stream is reliable, the sequence numbers let the receiver count what a reconnection lost. A connection closed
+ *  by the receiver counts send errors, it never raises SIGPIPE. */
+template <class T>
+class TcpBridgeDistributor : public Distributor<T> {
+public:
+    using DATA_TYPE = T;
+    static_assert(std::is_trivially_copyable<T>::value, "bridged events must be trivially copyable");
+
+    /** Connect to a TcpBridgeReceiver, batches larger than max_batch events are sent in several writes. */
+    TcpBridgeDistributor(const std::string& host, uint16_t port, size_t max_batch_ = 1024)
+    : max_batch(std::max<size_t>(1, max_batch_))
+    {
+        const sockaddr_in address = bridgeAddress(host, port);
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) throw std::system_error(errno, std::generic_category(), "socket");
+        if (connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+            const int error = errno;
+            close(fd);
+            throw std::system_error(error, std::generic_category(), "connect " + host);
+        }
+        const int nodelay = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+#ifdef SO_NOSIGPIPE
+        const int nosigpipe = 1;
+        setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &nosigpipe, sizeof(nosigpipe));
+#endif
+        pending.reserve(max_batch);
+    }
+
+    virtual ~TcpBridgeDistributor() {
+        flush();
+        close(fd);
+    }
+
+    virtual void distribute(const DATA_TYPE* pMD) noexcept override { distributeEvent(pMD, next_sequence, true); }
+
+    virtual void distributeEvent(const DATA_TYPE* pMD, int64_t /*sequence*/, bool end_of_batch) noexcept override {
+        pending.push_back(*pMD);
+        if (end_of_batch || pending.size() == max_batch) flush();
+    }
+
+    /** Bursts are written straight from the caller's events. */
+    virtual void distributeBatch(const DATA_TYPE* events, size_t n) noexcept override {
+        flush();
+        for(size_t done = 0; done < n; done += max_batch) write(events + done, std::min(max_batch, n - done));
+    }
+
+    void flush() noexcept {
+        if (pending.empty()) return;
+        write(pending.data(), pending.size());
+        pending.clear();
+    }
+
+    int64_t sent() const noexcept { return next_sequence; }
+    /** Events that could not be written, the connection is unusable after the first one. */
+    uint64_t sendErrors() const noexcept { return send_errors; }
+
+protected:
+    void write(const T* events, size_t n) noexcept {
+        BridgePacketHeader header = bridgeHeader(BridgePacketKind::Data, sizeof(T), next_sequence, n);
+        next_sequence += n;
+        iovec iov[2] = {{&header, sizeof(header)}, {const_cast<T*>(events), n * sizeof(T)}};
+        msghdr message;
+        std::memset(&message, 0, sizeof(message));
+        message.msg_iov = iov;
+        message.msg_iovlen = 2;
+        iovec*& next = message.msg_iov;
+        auto& count = message.msg_iovlen;
+        while (count > 0) {
+            const ssize_t written = sendmsg(fd, &message, kSendFlags);
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                send_errors += n;
+                return;
+            }
+            //skip what a partial write already sent
+            size_t left = written;
+            while (count > 0 && left >= next->iov_len) {
+                left -= next->iov_len;
+                ++next;
+                --count;
+            }
+            if (count > 0) {
+                next->iov_base = static_cast<char*>(next->iov_base) + left;
+                next->iov_len -= left;
+            }
+        }
+    }
+
+#ifdef MSG_NOSIGNAL
+    static constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+    static constexpr int kSendFlags = 0; //SO_NOSIGPIPE is set instead
+#endif
+
+    const size_t max_batch;
+    int fd = -1;
+    std::vector<T> pending;
+    int64_t next_sequence = 0;
+    uint64_t send_errors = 0;
+};
+
+/** Accepts TcpBridgeDistributor connections one at a time and publishes their batches into a remote sequencer, a
+ *  ring worth of events per range claim. A batch is read whole before its first range is claimed, so a connection
+ *  broken or stopped in the middle of a batch never publishes partial batches. */
+template <class T, std::size_t N = 1024ul, typename C = disruptor::kDefaultClaimStrategyTemplate<N>, typename W = disruptor::kDefaultWaitStrategy>
+class TcpBridgeReceiver {
+public:
+    using DATA_TYPE = T;
+    using SEQUENCER_TYPE = disruptor::Sequencer<T, N, C, W>;
+    static_assert(std::is_trivially_copyable<T>::value, "bridged events must be trivially copyable");
+
+    /** Listen on port, 0 for any (see port()). The sequencer's consumers must be gating it already. */
+    TcpBridgeReceiver(SEQUENCER_TYPE& sequencer_, uint16_t port_)
+    : sequencer(sequencer_)
+    {
+        listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (listen_fd < 0) throw std::system_error(errno, std::generic_category(), "socket");
+        const int reuse = 1;
+        setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        sockaddr_in local = bridgeAddress("0.0.0.0", port_);
+        if (bind(listen_fd, reinterpret_cast<sockaddr*>(&local), sizeof(local)) != 0 || listen(listen_fd, 1) != 0) {
+            const int error = errno;
+            close(listen_fd);
+            throw std::system_error(error, std::generic_category(), "listen");
+        }
+    }
+
+    virtual ~TcpBridgeReceiver() {
+        stop();
+        close(listen_fd);
+    }
+
+    /** Receive from a thread of its own until stop(). */
+    void start() {
+        if (work_thread.joinable()) return;
+        stopping.store(false, std::memory_order_release);
+        work_thread = std::thread([this] { this->run(); });
+    }
+    void stop() noexcept {
+        stopping.store(true, std::memory_order_release);
+        if (work_thread.joinable()) work_thread.join();
+    }
+
+    uint16_t port() const noexcept { return bridgePort(listen_fd); }
+    int64_t expected() const noexcept { return expected_.load(std::memory_order_acquire); }
+    uint64_t received() const noexcept { return received_.load(std::memory_order_relaxed); }
+    /** Events missing between two connections, e.g. sent while reconnecting. */
+    uint64_t lost() const noexcept { return lost_.load(std::memory_order_relaxed); }
+
+protected:
+    void run() {
+        while (!stopping.load(std::memory_order_acquire)) {
+            if (!bridgeWait(listen_fd, POLLIN, std::chrono::milliseconds(100))) continue;
+            const int fd = accept(listen_fd, nullptr, nullptr);
+            if (fd < 0) continue;
+            while (readBatch(fd)) {}
+            close(fd);
+        }
+    }
+
+    /** Read a batch into the sequencer, false once the connection is closed, broken or stopped. */
+    bool readBatch(int fd) {
+        BridgePacketHeader header;
+        if (!readFully(fd, &header, sizeof(header)) || !isBridgeHeader(header, sizeof(T)) ||
+            header.kind != static_cast<uint16_t>(BridgePacketKind::Data)) return false;
+        const int64_t expected = expected_.load(std::memory_order_relaxed);
+        if (expected >= 0 && header.first_sequence > expected) lost_.fetch_add(header.first_sequence - expected, std::memory_order_relaxed);
+        staging.resize(header.count * sizeof(T));
+        if (!readFully(fd, staging.data(), staging.size())) return false;
+        size_t remaining = header.count;
+        int64_t next = header.first_sequence;
+        const char* events = staging.data();
+        while (remaining > 0) {
+            const size_t n = std::min(remaining, sequencer.size());
+            disruptor::SequenceRange<T> range = sequencer.ClaimRange(n);
+            std::memcpy(range.head(), events, range.head_size() * sizeof(T));
+            std::memcpy(range.tail(), events + range.head_size() * sizeof(T), range.tail_size() * sizeof(T));
+            sequencer.Publish(range);
+            events += n * sizeof(T);
+            remaining -= n;
+            next += n;
+            received_.fetch_add(n, std::memory_order_relaxed);
+            expected_.store(next, std::memory_order_release);
+        }
+        return true;
+    }
+
+    bool readFully(int fd, void* buffer, size_t length) {
+        char* next = static_cast<char*>(buffer);
+        while (length > 0) {
+            if (stopping.load(std::memory_order_acquire)) return false;
+            if (!bridgeWait(fd, POLLIN, std::chrono::milliseconds(100))) continue;
+            const ssize_t read_now = recv(fd, next, length, 0);
+            if (read_now == 0) return false;
+            if (read_now < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            next += read_now;
+            length -= read_now;
+        }
+        return true;
+    }
+
+    SEQUENCER_TYPE& sequencer;
+    int listen_fd = -1;
+    std::vector<char> staging; //events of the batch being read
+    std::atomic<int64_t> expected_{-1};
+    std::atomic<uint64_t> received_{0};
+    std::atomic<uint64_t> lost_{0};
+    std::atomic<bool> stopping{false};
+    std::thread work_thread;
+};
+
+}
+#endif
@@ -0,0 +1,242 @@
+// Copyright (c) 2011-2015, Francois Saint-Jacques
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the disruptor-- nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL FRANCOIS SAINT-JACQUES BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef DISRUPTOR_BYTE_RING_H_  // NOLINT
+#define DISRUPTOR_BYTE_RING_H_  // NOLINT
+
+#include <cstdint>
+#include <stdexcept>
+
+#include "claim_strategy.h"
+#include "wait_strategy.h"
+#include "sequence_barrier.h"
+
+namespace disruptor {
+
+constexpr size_t kDefaultByteRingSize = 1 << 16;
+
+// Records start on kByteRecordAlignment boundaries.
+constexpr size_t kByteRecordAlignment = 8;
+
+// Header of a record: the payload length, or for padding the number of bytes
+// skipped up to the next record.
+struct ByteRecordHeader {
+  uint32_t length;
+  uint32_t flags;
+};
+
+constexpr uint32_t kByteRecordPadding = 1;
+
+// View of a record payload.
+struct ByteRecord {
+  const uint8_t* data;
+  size_t size;
+};
+
+// Bytes claimed for one record, see ByteSequencer::Claim(). The payload is
+// contiguous, records never wrap around the end of the ring.
+struct ByteClaim {
+  int64_t first;
+  int64_t last;
+  uint8_t* data;
+  size_t size;
+
+  bool empty() const { return data == nullptr; }
+};
+
+// Coordinator of a ring of variable length records. Sequences count bytes:
+// the cursor and the consumers' {@link Sequence}s are the last byte
+// published or consumed, so the claim and wait strategies and the
+// {@link SequenceBarrier}s are the ones of the fixed size Sequencer with N
+// counted in bytes.
+//
+// The bytes claimed for a record that would cross the end of the ring are
+// published as a padding record and the record is claimed again after them.
+template <size_t N = kDefaultByteRingSize,
+          typename C = kDefaultClaimStrategyTemplate<N>,
+          typename W = kDefaultWaitStrategy>
+class ByteSequencer {
+  static_assert(N > 0 && (N & (N - 1)) == 0, "the ring size must be a power of 2");
+  static_assert(N % kByteRecordAlignment == 0, "the ring must hold whole records");
+
+ public:
+  ByteSequencer() {}
+
+  // Get the number of bytes of the ring.
+  static constexpr size_t size() { return N; }
+
+  // Get the largest payload a record may carry, a record takes at most half
+  // of the ring so that it fits after a padding record.
+  static constexpr size_t max_length() {
+    return N / 2 - sizeof(ByteRecordHeader);
+  }
+
+  // Get the bytes taken in the ring by a record.
+  //
+  // @param length of the payload.
+  static constexpr size_t RecordSize(size_t length) {
+    return (sizeof(ByteRecordHeader) + length + kByteRecordAlignment - 1) /
+           kByteRecordAlignment * kByteRecordAlignment;
+  }
+
+  // Set the sequences that will gate publishers to prevent the buffer
+  // wrapping.
+  //
+  // @param sequences to be gated on.
+  void set_gating_sequences(const std::vector<Sequence*>& sequences) {
+    gating_sequences_ = sequences;
+  }
+
+  // Create a {@link SequenceBarrier} that gates on the cursor and a list of
+  // {@link Sequence}s.
+  //
+  // @param sequences_to_track this barrier will track.
+  // @return the barrier gated as required.
+  SequenceBarrier<W>* NewBarrier(const std::vector<Sequence*>& dependents) {
+    return new SequenceBarrier<W>(wait_strategy_, cursor_, dependents);
+  }
+
+  // Get the value of the cursor indicating the last published byte.
+  int64_t GetCursor() { return cursor_.sequence(); }
+
+  // Claim the bytes of a record, waiting for the consumers to free them.
+  //
+  // @param length of the payload, at most max_length().
+  // @return the claimed record to be filled and published.
+  ByteClaim Claim(size_t length) {
+    CheckLength(length);
+    const size_t record_size = RecordSize(length);
+    while (true) {
+      const int64_t last =
+          claim_strategy_.IncrementAndGet(gating_sequences_, record_size);
+      ByteClaim claim = ClaimOf(last, record_size, length);
+      if (!claim.empty()) return claim;
+    }
+  }
+
+  // Claim the bytes of a record only if the ring has room for it right now.
+  //
+  // @param length of the payload, at most max_length().
+  // @return the claimed record, empty if nothing was claimed.
+  ByteClaim TryClaim(size_t length) {
+    CheckLength(length);
+    const size_t record_size = RecordSize(length);
+    while (true) {
+      const int64_t last =
+          claim_strategy_.TryIncrementAndGet(gating_sequences_, record_size);
+      if (last == kInsufficientCapacitySignal) return ByteClaim{0, 0, nullptr, 0};
+      ByteClaim claim = ClaimOf(last, record_size, length);
+      if (!claim.empty()) return claim;
+    }
+  }
+
+  // Publish a claimed record and make it visible to the consumers.
+  //
+  // @param claim to be published.
+  void Publish(const ByteClaim& claim) {
+    Header(claim.first)->length = static_cast<uint32_t>(claim.size);
+    Header(claim.first)->flags = 0;
+    Publish(claim.last, claim.last - claim.first + 1);
+  }
+
+  // Visit the records between two byte sequences, padding is skipped.
+  //
+  // @param from first byte of a record, one past a consumer's sequence.
+  // @param to   last byte available to the consumer, from its barrier.
+  // @param f    called with each record and whether it is the last of the
+  //             batch, as f(const ByteRecord&, bool).
+  // @return the last byte visited, the consumer's new sequence.
+  template <typename F>
+  int64_t ForEach(int64_t from, int64_t to, F f) {
+    int64_t position = SkipPadding(from, to);
+    while (position <= to) {
+      const ByteRecordHeader* header = Header(position);
+      const int64_t next = SkipPadding(position + RecordSize(header->length), to);
+      f(ByteRecord{reinterpret_cast<const uint8_t*>(header + 1), header->length},
+        next > to);
+      position = next;
+    }
+    return position - 1;
+  }
+
+  // Claims that stalled on a full ring, empty unless DISRUPTOR_METRICS is
+  // defined.
+  ClaimMetricsSnapshot claim_metrics() const {
+    return claim_strategy_.metrics().Snapshot();
+  }
+
+ private:
+  void CheckLength(size_t length) const {
+    if (length == 0 || length > max_length())
+      throw std::invalid_argument("record length out of the byte ring bounds");
+  }
+
+  // Turn a claim crossing the end of the ring into a published padding
+  // record, the caller claims again.
+  ByteClaim ClaimOf(int64_t last, size_t record_size, size_t length) {
+    const int64_t first = last - record_size + 1;
+    const size_t offset = first & (N - 1);
+    if (offset + record_size <= N) {
+      return ByteClaim{first, last, reinterpret_cast<uint8_t*>(Header(first) + 1),
+                       length};
+    }
+    Header(first)->length = static_cast<uint32_t>(record_size);
+    Header(first)->flags = kByteRecordPadding;
+    Publish(last, record_size);
+    return ByteClaim{0, 0, nullptr, 0};
+  }
+
+  int64_t SkipPadding(int64_t position, int64_t to) {
+    while (position <= to && Header(position)->flags & kByteRecordPadding)
+      position += Header(position)->length;
+    return position;
+  }
+
+  void Publish(int64_t last, size_t delta) {
+    claim_strategy_.Publish(last, cursor_, delta);
+    wait_strategy_.SignalAllWhenBlocking();
+  }
+
+  ByteRecordHeader* Header(int64_t sequence) {
+    return reinterpret_cast<ByteRecordHeader*>(&buffer_[sequence & (N - 1)]);
+  }
+
+  // Members
+  alignas(kByteRecordAlignment) uint8_t buffer_[N];
+
+  Sequence cursor_;
+
+  C claim_strategy_;
+
+  W wait_strategy_;
+
+  std::vector<Sequence*> gating_sequences_;
+
+  DISALLOW_COPY_MOVE_AND_ASSIGN(ByteSequencer);
+};
+
+};  // namespace disruptor
+
+#endif  // DISRUPTOR_BYTE_RING_H_ NOLINT
@@ -26,8 +26,10 @@
 #ifndef DISRUPTOR_CLAIM_STRATEGY_H_  // NOLINT
 #define DISRUPTOR_CLAIM_STRATEGY_H_  // NOLINT
 
+#include <memory>
 #include <thread>
 
+#include "metrics.h"
 #include "sequence.h"
 #include "ring_buffer.h"
 
@@ -55,39 +57,76 @@ class ClaimStrategy {
   // @return last claimed sequence.
   bool HasAvailableCapacity(const std::vector<Sequence*>& dependents);
 
+  // Claim sequences only if they are free right now, never waiting.
+  //
+  // @param dependents  dependents sequences to wait on (mostly consumers).
+  // @param delta       sequences to claim [default: 1].
+  //
+  // @return last claimed sequence, or kInsufficientCapacitySignal when the
+  //         ring is too full and nothing was claimed.
+  int64_t TryIncrementAndGet(const std::vector<Sequence*>& dependents,
+                             size_t delta = 1);
+
   void SynchronizePublishing(const int64_t& sequence, const Sequence& cursor,
                              const size_t& delta) {}
+
+  // Make the claimed sequences visible by advancing the cursor.
+  //
+  // @param sequence    last sequence of the claimed batch.
+  // @param cursor      sequencer's cursor.
+  // @param delta       number of sequences in the batch.
+  void Publish(const int64_t& sequence, Sequence& cursor, const size_t& delta);
+
+  // Whether the strategy collects metrics, see metrics.h. Part of the type
+  // so that translation units built with and without DISRUPTOR_METRICS do
+  // not share a layout under one name.
+  static constexpr bool kMetrics;
+
+  // Claims that had to wait for the consumers, see metrics.h.
+  const BasicClaimMetrics<kMetrics>& metrics() const;
 };
 */
 
-template <size_t N>
+template <size_t N = kDefaultRingBufferSize, bool M = kMetricsEnabled>
 class SingleThreadedStrategy;
+template <size_t N = kDefaultRingBufferSize, bool M = kMetricsEnabled>
+class MultiThreadedStrategy;
+template <size_t N = kDefaultRingBufferSize, bool M = kMetricsEnabled>
+class MultiProducerStrategy;
 //this is a dangerous practice, may result into different knowledge of N being used as template argument in sequencer
 //using kDefaultClaimStrategy = SingleThreadedStrategy<kDefaultRingBufferSize>;
 template <size_t N> using kDefaultClaimStrategyTemplate = SingleThreadedStrategy<N>;
 // Optimised strategy can be used when there is a single publisher thread.
-template <size_t N = kDefaultRingBufferSize>
-class SingleThreadedStrategy {
+template <size_t N, bool M>
+class SingleThreadedStrategy : public RingSize<N>, private BasicClaimMetrics<M> {
  public:
-  SingleThreadedStrategy()
-      : last_claimed_sequence_(kInitialCursorValue),
+  static constexpr bool kMetrics = M;
+
+  // @param size of the ring, only needed when N is kRuntimeRingBufferSize.
+  explicit SingleThreadedStrategy(size_t size = N)
+      : RingSize<N>(size),
+        last_claimed_sequence_(kInitialCursorValue),
         last_consumer_sequence_(kInitialCursorValue) {}
 
   int64_t IncrementAndGet(const std::vector<Sequence*>& dependents,
                           size_t delta = 1) {
     const int64_t next_sequence = (last_claimed_sequence_ += delta);
-    const int64_t wrap_point = next_sequence - N;
+    const int64_t wrap_point = next_sequence - this->size();
     if (last_consumer_sequence_ < wrap_point) {
-      while (GetMinimumSequence(dependents) < wrap_point) {
-        // TODO: configurable yield strategy
-        std::this_thread::yield();
+      if (GetMinimumSequence(dependents) < wrap_point) {
+        const typename BasicClaimMetrics<M>::Stall stall = this->StallBegin();
+        do {
+          // TODO: configurable yield strategy
+          std::this_thread::yield();
+        } while (GetMinimumSequence(dependents) < wrap_point);
+        this->StallEnd(stall);
       }
     }
     return next_sequence;
   }
 
   bool HasAvailableCapacity(const std::vector<Sequence*>& dependents) {
-    const int64_t wrap_point = last_claimed_sequence_ + 1L - N;
+    const int64_t wrap_point = last_claimed_sequence_ + 1L - this->size();
     if (wrap_point > last_consumer_sequence_) {
       const int64_t min_sequence = GetMinimumSequence(dependents);
       last_consumer_sequence_ = min_sequence;
@@ -96,9 +135,31 @@ class SingleThreadedStrategy {
     return true;
   }
 
+  int64_t TryIncrementAndGet(const std::vector<Sequence*>& dependents,
+                             size_t delta = 1) {
+    const int64_t next_sequence = last_claimed_sequence_ + delta;
+    const int64_t wrap_point = next_sequence - this->size();
+    if (last_consumer_sequence_ < wrap_point) {
+      const int64_t min_sequence = GetMinimumSequence(dependents);
+      last_consumer_sequence_ = min_sequence;
+      if (min_sequence < wrap_point) return kInsufficientCapacitySignal;
+    }
+    return last_claimed_sequence_ = next_sequence;
+  }
+
   void SynchronizePublishing(const int64_t& sequence, const Sequence& cursor,
                              const size_t& delta) {}
 
+  // The single publisher is the only writer of the cursor and publishes in
+  // claim order, a plain release store is enough to advance it.
+  void Publish(const int64_t& sequence, Sequence& cursor,
+               const size_t& /*delta*/) {
+    cursor.set_sequence(sequence);
+  }
+
+  // Claims that had to wait for the consumers, see metrics.h.
+  const BasicClaimMetrics<M>& metrics() const { return *this; }
+
  private:
   // We do not need to use atomic values since this function is called by a
   // single publisher.
@@ -109,26 +170,34 @@ class SingleThreadedStrategy {
 };
 
 // Optimised strategy can be used when there is a single publisher thread.
-template <size_t N = kDefaultRingBufferSize>
-class MultiThreadedStrategy {
+template <size_t N, bool M>
+class MultiThreadedStrategy : public RingSize<N>, private BasicClaimMetrics<M> {
  public:
-  MultiThreadedStrategy() {}
+  static constexpr bool kMetrics = M;
+
+  // @param size of the ring, only needed when N is kRuntimeRingBufferSize.
+  explicit MultiThreadedStrategy(size_t size = N) : RingSize<N>(size) {}
 
   int64_t IncrementAndGet(const std::vector<Sequence*>& dependents,
                           size_t delta = 1) {
     const int64_t next_sequence = last_claimed_sequence_.IncrementAndGet(delta);
-    const int64_t wrap_point = next_sequence - N;
+    const int64_t wrap_point = next_sequence - this->size();
     if (last_consumer_sequence_.sequence() < wrap_point) {
-      while (GetMinimumSequence(dependents) < wrap_point) {
-        // TODO: configurable yield strategy
-        std::this_thread::yield();
+      if (GetMinimumSequence(dependents) < wrap_point) {
+        const typename BasicClaimMetrics<M>::Stall stall = this->StallBegin();
+        do {
+          // TODO: configurable yield strategy
+          std::this_thread::yield();
+        } while (GetMinimumSequence(dependents) < wrap_point);
+        this->StallEnd(stall);
       }
     }
     return next_sequence;
   }
 
   bool HasAvailableCapacity(const std::vector<Sequence*>& dependents) {
-    const int64_t wrap_point = last_claimed_sequence_.sequence() + 1L - N;
+    const int64_t wrap_point =
+        last_claimed_sequence_.sequence() + 1L - this->size();
     if (wrap_point > last_consumer_sequence_.sequence()) {
       const int64_t min_sequence = GetMinimumSequence(dependents);
       last_consumer_sequence_.set_sequence(min_sequence);
@@ -137,6 +206,25 @@ class MultiThreadedStrategy {
     return true;
   }
 
+  // Unlike HasAvailableCapacity() followed by IncrementAndGet(), the check
+  // and the claim cannot be split by another publisher.
+  int64_t TryIncrementAndGet(const std::vector<Sequence*>& dependents,
+                             size_t delta = 1) {
+    int64_t current_sequence, next_sequence;
+    do {
+      current_sequence = last_claimed_sequence_.sequence();
+      next_sequence = current_sequence + delta;
+      const int64_t wrap_point = next_sequence - this->size();
+      if (last_consumer_sequence_.sequence() < wrap_point) {
+        const int64_t min_sequence = GetMinimumSequence(dependents);
+        last_consumer_sequence_.set_sequence(min_sequence);
+        if (min_sequence < wrap_point) return kInsufficientCapacitySignal;
+      }
+    } while (!last_claimed_sequence_.CompareAndSet(current_sequence,
+                                                   next_sequence));
+    return next_sequence;
+  }
+
   void SynchronizePublishing(const int64_t& sequence, const Sequence& cursor,
                              const size_t& delta) {
     int64_t my_first_sequence = sequence - delta;
@@ -147,6 +235,14 @@ class MultiThreadedStrategy {
     }
   }
 
+  void Publish(const int64_t& sequence, Sequence& cursor, const size_t& delta) {
+    SynchronizePublishing(sequence, cursor, delta);
+    cursor.IncrementAndGet(delta);
+  }
+
+  // Claims that had to wait for the consumers, see metrics.h.
+  const BasicClaimMetrics<M>& metrics() const { return *this; }
+
  private:
   Sequence last_claimed_sequence_;
   Sequence last_consumer_sequence_;
@@ -154,6 +250,122 @@ class MultiThreadedStrategy {
   DISALLOW_COPY_MOVE_AND_ASSIGN(MultiThreadedStrategy);
 };
 
+// Strategy for multiple publisher threads that never waits on other
+// publishers.
+//
+// Every published slot is marked in an availability buffer with the sequence
+// it holds. A publisher then moves the cursor over the contiguous run of
+// available slots, on behalf of whoever published them, so a descheduled
+// publisher only holds back the cursor, never the other publishers. The
+// cursor therefore always points at the highest contiguous published
+// sequence and barriers can keep waiting on it as usual.
+template <size_t N, bool M>
+class MultiProducerStrategy : public RingSize<N>, private BasicClaimMetrics<M> {
+ public:
+  static constexpr bool kMetrics = M;
+
+  // @param size of the ring, only needed when N is kRuntimeRingBufferSize.
+  explicit MultiProducerStrategy(size_t size = N)
+      : RingSize<N>(size), available_(new std::atomic<int64_t>[size]) {
+    for (size_t i = 0; i < size; ++i)
+      available_[i].store(kInitialCursorValue,
+                          std::memory_order_relaxed);
+  }
+
+  int64_t IncrementAndGet(const std::vector<Sequence*>& dependents,
+                          size_t delta = 1) {
+    const int64_t next_sequence = last_claimed_sequence_.IncrementAndGet(delta);
+    const int64_t wrap_point = next_sequence - this->size();
+    if (last_consumer_sequence_.sequence() < wrap_point) {
+      int64_t min_sequence = GetMinimumSequence(dependents);
+      if (min_sequence < wrap_point) {
+        const typename BasicClaimMetrics<M>::Stall stall = this->StallBegin();
+        do {
+          // TODO: configurable yield strategy
+          std::this_thread::yield();
+        } while ((min_sequence = GetMinimumSequence(dependents)) < wrap_point);
+        this->StallEnd(stall);
+      }
+      last_consumer_sequence_.set_sequence(min_sequence);
+    }
+    return next_sequence;
+  }
+
+  bool HasAvailableCapacity(const std::vector<Sequence*>& dependents) {
+    const int64_t wrap_point =
+        last_claimed_sequence_.sequence() + 1L - this->size();
+    if (wrap_point > last_consumer_sequence_.sequence()) {
+      const int64_t min_sequence = GetMinimumSequence(dependents);
+      last_consumer_sequence_.set_sequence(min_sequence);
+      if (wrap_point > min_sequence) return false;
+    }
+    return true;
+  }
+
+  // See MultiThreadedStrategy::TryIncrementAndGet().
+  int64_t TryIncrementAndGet(const std::vector<Sequence*>& dependents,
+                             size_t delta = 1) {
+    int64_t current_sequence, next_sequence;
+    do {
+      current_sequence = last_claimed_sequence_.sequence();
+      next_sequence = current_sequence + delta;
+      const int64_t wrap_point = next_sequence - this->size();
+      if (last_consumer_sequence_.sequence() < wrap_point) {
+        const int64_t min_sequence = GetMinimumSequence(dependents);
+        last_consumer_sequence_.set_sequence(min_sequence);
+        if (min_sequence < wrap_point) return kInsufficientCapacitySignal;
+      }
+    } while (!last_claimed_sequence_.CompareAndSet(current_sequence,
+                                                   next_sequence));
+    return next_sequence;
+  }
+
+  // Publishers do not synchronize with each other, see Publish().
+  void SynchronizePublishing(const int64_t& sequence, const Sequence& cursor,
+                             const size_t& delta) {}
+
+  void Publish(const int64_t& sequence, Sequence& cursor, const size_t& delta) {
+    for (int64_t s = sequence - delta + 1; s <= sequence; ++s)
+      available_[s & (this->size() - 1)].store(
+          s, std::memory_order_release);
+
+    // Two publishers could otherwise both read the other's slot before it is
+    // marked and leave the cursor behind a published sequence.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    int64_t current = cursor.sequence();
+    while (true) {
+      int64_t highest = current;
+      while (IsAvailable(highest + 1)) ++highest;
+      // nothing left to advance, or a later publisher will take over.
+      if (highest == current) return;
+      if (cursor.CompareAndSet(current, highest))
+        current = highest;
+      else
+        current = cursor.sequence();
+    }
+  }
+
+  // Verify if a given sequence has been published.
+  //
+  // @param sequence to verify.
+  // @return true if the slot currently holds the published sequence.
+  bool IsAvailable(const int64_t& sequence) const {
+    return available_[sequence & (this->size() - 1)].load(
+               std::memory_order_acquire) == sequence;
+  }
+
+  // Claims that had to wait for the consumers, see metrics.h.
+  const BasicClaimMetrics<M>& metrics() const { return *this; }
+
+ private:
+  Sequence last_claimed_sequence_;
+  Sequence last_consumer_sequence_;
+  std::unique_ptr<std::atomic<int64_t>[]> available_;
+
+  DISALLOW_COPY_MOVE_AND_ASSIGN(MultiProducerStrategy);
+};
+
 };  // namespace disruptor
 
 #endif  // DISRUPTOR_CLAIM_STRATEGY_H_ NOLINT
@@ -0,0 +1,257 @@
+// Copyright (c) 2011-2015, Francois Saint-Jacques
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the disruptor-- nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL FRANCOIS SAINT-JACQUES BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef DISRUPTOR_COROUTINE_H_  // NOLINT
+#define DISRUPTOR_COROUTINE_H_  // NOLINT
+
+// Coroutine consumers need C++20, the header is empty for older standards.
+#if __cplusplus >= 202002L && defined(__cpp_impl_coroutine)
+
+#include <poll.h>
+
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <exception>
+#include <utility>
+#include <vector>
+
+#include "sequence_barrier.h"
+
+namespace disruptor {
+
+// Coroutine of a consumer run by a {@link CoroutineScheduler}. It starts
+// suspended, the scheduler it is spawned on resumes it.
+class ConsumerTask {
+ public:
+  struct promise_type {
+    ConsumerTask get_return_object() {
+      return ConsumerTask(
+          std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    std::suspend_always final_suspend() noexcept { return {}; }
+    void return_void() {}
+    void unhandled_exception() { std::terminate(); }
+  };
+
+  ConsumerTask(ConsumerTask&& other) noexcept
+      : handle_(std::exchange(other.handle_, nullptr)) {}
+  ConsumerTask& operator=(ConsumerTask&& other) noexcept {
+    if (this != &other) {
+      if (handle_) handle_.destroy();
+      handle_ = std::exchange(other.handle_, nullptr);
+    }
+    return *this;
+  }
+  ~ConsumerTask() {
+    if (handle_) handle_.destroy();
+  }
+
+  bool done() const { return !handle_ || handle_.done(); }
+
+  std::coroutine_handle<> handle() const { return handle_; }
+
+ private:
+  explicit ConsumerTask(std::coroutine_handle<promise_type> handle)
+      : handle_(handle) {}
+
+  std::coroutine_handle<promise_type> handle_;
+};
+
+// Single threaded scheduler multiplexing many {@link ConsumerTask}s waiting
+// on {@link SequenceBarrier}s with the same wait strategy. When none of them
+// can make progress, the scheduler parks: on the eventfds of the barriers
+// with EventFdStrategy, otherwise in the wait strategy of the first waiting
+// barrier, for at most the idle timeout.
+template <typename W = kDefaultWaitStrategy>
+class CoroutineScheduler {
+ public:
+  CoroutineScheduler() {}
+
+  // Maximum time parked before checking every barrier again.
+  //
+  // @param timeout also bounds the latency of barriers a scheduler cannot
+  //                park on, such as barriers of other sequencers.
+  template <class R, class P>
+  void set_idle_timeout(const std::chrono::duration<R, P>& timeout) {
+    idle_timeout_ =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(timeout);
+  }
+
+  // Hand a consumer to the scheduler, it first runs in Run().
+  void Spawn(ConsumerTask task) {
+    ready_.push_back(task.handle());
+    tasks_.push_back(std::move(task));
+  }
+
+  // Run the consumers on the calling thread until they all return or Stop()
+  // is called.
+  void Run() {
+    CoroutineScheduler* const previous = current_;
+    current_ = this;
+    stopped_.store(false, std::memory_order_release);
+    while (!stopped_.load(std::memory_order_acquire) &&
+           !Finished()) {
+      std::vector<std::coroutine_handle<> > ready;
+      ready.swap(ready_);
+      for (auto& handle : ready) handle.resume();
+      Poll();
+      if (ready_.empty() && !waiters_.empty()) Park();
+    }
+    current_ = previous;
+  }
+
+  // Make Run() return once the current round of consumers is resumed, from
+  // any thread.
+  void Stop() { stopped_.store(true, std::memory_order_release); }
+
+  // Get the scheduler running on the calling thread, if any.
+  static CoroutineScheduler* current() { return current_; }
+
+  // Register a suspended consumer until sequence is available.
+  void Wait(SequenceBarrier<W>* barrier, const int64_t& sequence,
+            int64_t* available, std::coroutine_handle<> handle) {
+    waiters_.push_back(Waiter{barrier, sequence, available, handle});
+  }
+
+ private:
+  struct Waiter {
+    SequenceBarrier<W>* barrier;
+    int64_t sequence;
+    int64_t* available;
+    std::coroutine_handle<> handle;
+  };
+
+  bool Finished() const {
+    for (auto& task : tasks_)
+      if (!task.done()) return false;
+    return true;
+  }
+
+  // Move the waiters whose sequence is available to the ready list.
+  void Poll() {
+    for (size_t i = 0; i < waiters_.size();) {
+      Waiter& waiter = waiters_[i];
+      const int64_t available = waiter.barrier->TryWaitFor(waiter.sequence);
+      if (available >= waiter.sequence || available == kAlertedSignal) {
+        *waiter.available = available;
+        ready_.push_back(waiter.handle);
+        waiter = waiters_.back();
+        waiters_.pop_back();
+      } else {
+        ++i;
+      }
+    }
+  }
+
+  void Park() {
+    if constexpr (requires(W& strategy) { strategy.Subscribe(); }) {
+      // one eventfd per distinct barrier, waiters often share theirs.
+      std::vector<SequenceBarrier<W>*> barriers;
+      std::vector<pollfd> fds;
+      for (auto& waiter : waiters_) {
+        bool seen = false;
+        for (auto barrier : barriers) seen |= (barrier == waiter.barrier);
+        if (seen) continue;
+        barriers.push_back(waiter.barrier);
+        const int fd = waiter.barrier->wait_fd();
+        // published while arming, or no eventfd left: do not sleep on it.
+        if (waiter.barrier->ArmWaitFd(waiter.sequence) >= waiter.sequence)
+          return;
+        if (fd < 0) {
+          waiter.barrier->WaitFor(waiter.sequence, idle_timeout_);
+          return;
+        }
+        fds.push_back(pollfd{fd, POLLIN, 0});
+      }
+      const auto timeout =
+          std::chrono::duration_cast<std::chrono::milliseconds>(idle_timeout_);
+      poll(fds.data(), fds.size(), static_cast<int>(timeout.count()) + 1);
+    } else {
+      const Waiter& waiter = waiters_.front();
+      waiter.barrier->WaitFor(waiter.sequence, idle_timeout_);
+    }
+  }
+
+  static thread_local CoroutineScheduler* current_;
+
+  std::vector<ConsumerTask> tasks_;
+  std::vector<std::coroutine_handle<> > ready_;
+  std::vector<Waiter> waiters_;
+  std::atomic<bool> stopped_{false};
+  std::chrono::nanoseconds idle_timeout_{std::chrono::milliseconds(1)};
+
+  DISALLOW_COPY_MOVE_AND_ASSIGN(CoroutineScheduler);
+};
+
+template <typename W>
+thread_local CoroutineScheduler<W>* CoroutineScheduler<W>::current_ = nullptr;
+
+// Awaitable resuming a consumer once a sequence is available through a
+// barrier, see NextBatch().
+template <typename W>
+class NextBatchAwaitable {
+ public:
+  NextBatchAwaitable(SequenceBarrier<W>& barrier, const int64_t& sequence)
+      : barrier_(barrier), sequence_(sequence), available_(0) {}
+
+  bool await_ready() {
+    available_ = barrier_.TryWaitFor(sequence_);
+    return available_ >= sequence_ || available_ == kAlertedSignal;
+  }
+
+  void await_suspend(std::coroutine_handle<> handle) {
+    CoroutineScheduler<W>::current()->Wait(&barrier_, sequence_, &available_,
+                                           handle);
+  }
+
+  int64_t await_resume() const { return available_; }
+
+ private:
+  SequenceBarrier<W>& barrier_;
+  int64_t sequence_;
+  int64_t available_;
+};
+
+// Wait, within a consumer run by a {@link CoroutineScheduler} with the same
+// wait strategy, for the batch of sequences starting at sequence:
+// co_await NextBatch(barrier, sequence).
+//
+// @param barrier  gating the consumer, it may be shared by many consumers.
+// @param sequence to wait for.
+// @return kAlertedSignal if the barrier signaled an alert, otherwise the
+//         greatest available sequence, the batch ends there.
+template <typename W>
+NextBatchAwaitable<W> NextBatch(SequenceBarrier<W>& barrier,
+                                const int64_t& sequence) {
+  return NextBatchAwaitable<W>(barrier, sequence);
+}
+
+};  // namespace disruptor
+
+#endif  // __cplusplus >= 202002L
+
+#endif  // DISRUPTOR_COROUTINE_H_ NOLINT
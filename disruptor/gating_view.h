@@ -0,0 +1,143 @@
+// Copyright (c) 2011-2015, Francois Saint-Jacques
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the disruptor-- nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL FRANCOIS SAINT-JACQUES BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef DISRUPTOR_GATING_VIEW_H_  // NOLINT
+#define DISRUPTOR_GATING_VIEW_H_  // NOLINT
+
+#include <climits>
+#include <vector>
+
+#include "sequence.h"
+
+namespace disruptor {
+
+/*
+// View used by a {@link WaitStrategy} to read the sequences gating a
+// consumer. There is one view per dependency shape so the spin loops are
+// statically dispatched and inlined.
+//
+class GatingView {
+ public:
+  // Get the greatest sequence available to the consumer.
+  //
+  // @param requested sequence the consumer is waiting for.
+  //
+  // @return a sequence such that every sequence up to it is available, it
+  //         may be lower than requested.
+  int64_t Get(const int64_t& requested);
+
+  // Get the sequencer's cursor.
+  const Sequence& cursor() const;
+};
+*/
+
+// View of a consumer without dependents, gated on the cursor only.
+class CursorGatingView {
+ public:
+  CursorGatingView(const Sequence& cursor,
+                   const std::vector<Sequence*>& /*dependents*/ = {})
+      : cursor_(cursor) {}
+
+  int64_t Get(const int64_t& /*requested*/) const { return cursor_.sequence(); }
+
+  const Sequence& cursor() const { return cursor_; }
+
+ private:
+  const Sequence& cursor_;
+};
+
+// View of a consumer gated on a single dependent.
+//
+// The last observed value is cached, the dependent's cache line is only read
+// again when the cached value is behind the requested sequence.
+class SingleGatingView {
+ public:
+  SingleGatingView(const Sequence& cursor,
+                   const std::vector<Sequence*>& dependents)
+      : cursor_(cursor),
+        dependent_(dependents.empty() ? nullptr : dependents[0]),
+        cached_(kInitialCursorValue) {}
+
+  int64_t Get(const int64_t& requested) {
+    if (cached_ >= requested) return cached_;
+    return cached_ = dependent_->sequence();
+  }
+
+  const Sequence& cursor() const { return cursor_; }
+
+ private:
+  const Sequence& cursor_;
+  const Sequence* dependent_;
+  int64_t cached_;
+};
+
+// View of a consumer gated on many dependents.
+//
+// The cached minimum is returned as long as it covers the requested
+// sequence. Otherwise the dependents are read starting from the one found
+// lagging during the previous call, and the scan stops at the first one still
+// behind the requested sequence, so a waiting consumer usually reads a single
+// cache line per spin.
+class MultiGatingView {
+ public:
+  MultiGatingView(const Sequence& cursor,
+                  const std::vector<Sequence*>& dependents)
+      : cursor_(cursor),
+        dependents_(dependents),
+        cached_(kInitialCursorValue),
+        laggard_(0) {}
+
+  int64_t Get(const int64_t& requested) {
+    if (cached_ >= requested) return cached_;
+
+    const size_t size = dependents_.size();
+    int64_t minimum = LONG_MAX;
+    size_t index = laggard_;
+    for (size_t n = 0; n < size; ++n) {
+      const int64_t sequence = dependents_[index]->sequence();
+      if (sequence < requested) {
+        laggard_ = index;
+        // the cached minimum is still a valid lower bound.
+        return cached_;
+      }
+      minimum = minimum < sequence ? minimum : sequence;
+      if (++index == size) index = 0;
+    }
+
+    return cached_ = minimum;
+  }
+
+  const Sequence& cursor() const { return cursor_; }
+
+ private:
+  const Sequence& cursor_;
+  std::vector<Sequence*> dependents_;
+  int64_t cached_;
+  size_t laggard_;
+};
+
+};  // namespace disruptor
+
+#endif  // DISRUPTOR_GATING_VIEW_H_ NOLINT
@@ -11,8 +11,22 @@
  */
 #ifndef __DISRUPTOR__HANDLER_HPP__
 #define __DISRUPTOR__HANDLER_HPP__
+#include "metrics.h"
+#include "placement.h"
 #include "sequencer.h"
+#include "tracing.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <map>
 #include <memory>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace disruptor {
 
@@ -21,7 +35,25 @@ template <class T>
 class Handler {
 public:
     using DATA_TYPE = T;
+    /** Fills an event in place, see distributeWith() */
+    using TRANSLATOR_TYPE = std::function<void(DATA_TYPE&)>;
     virtual void process(const DATA_TYPE* pMD) noexcept {}
+    /** Batch aware variant called by async distributors: sequence is the event position in the ring and end_of_batch
+     *  flags the last event of the range made available at once, handlers can group their work(one write, one flush) per batch. */
+    virtual void processEvent(const DATA_TYPE* pMD, int64_t /*sequence*/, bool /*end_of_batch*/) noexcept { process(pMD); }
+    /** Process a burst of contiguous events. */
+    virtual void processBatch(const DATA_TYPE* events, size_t n) noexcept {
+        for(size_t i = 0; i < n; ++i) process(events + i);
+    }
+    /** Process an event built by a translator, ring backed handlers let it fill their slot directly. */
+    virtual void processWith(const TRANSLATOR_TYPE& fill) noexcept {
+        DATA_TYPE event;
+        fill(event);
+        process(&event);
+    }
+    /** Sequence handlers running after this one gate on instead of the processed one, e.g. once events are durable.
+     *  It must never be ahead of the processed sequence, nullptr(the default) to gate on the processed one. */
+    virtual disruptor::Sequence* gatingSequence() noexcept { return nullptr; }
     //for async distributor
     virtual void start() {}
     virtual void join() noexcept {}
@@ -35,10 +67,23 @@ class Distributor {
 public:
     using DATA_TYPE = T;
     using BASE_HANDLER_TYPE = Handler<T>;
+    using TRANSLATOR_TYPE = typename Handler<T>::TRANSLATOR_TYPE;
 
     virtual BASE_HANDLER_TYPE* addHandler(BASE_HANDLER_TYPE* rcv) { return nullptr; }
     virtual BASE_HANDLER_TYPE* removeHandler(BASE_HANDLER_TYPE* rcv) { return nullptr; }
     virtual void distribute(const DATA_TYPE* pMD) noexcept {}
+    virtual void distributeEvent(const DATA_TYPE* pMD, int64_t /*sequence*/, bool /*end_of_batch*/) noexcept { distribute(pMD); }
+    /** Distribute a burst of contiguous events, ring backed distributors claim and publish it at once. */
+    virtual void distributeBatch(const DATA_TYPE* events, size_t n) noexcept {
+        for(size_t i = 0; i < n; ++i) distribute(events + i);
+    }
+    /** Distribute an event constructed in place by fill, which is invoked once per ring the event is published to,
+     *  plain handlers get a temporary. */
+    virtual void distributeWith(const TRANSLATOR_TYPE& fill) noexcept {
+        DATA_TYPE event;
+        fill(event);
+        distribute(&event);
+    }
     //for async distributor
     virtual void start() {}
     virtual void join() noexcept {}
@@ -60,6 +105,15 @@ public:
 
     virtual ~Connector() { distributor.reset(); }
     virtual void process(const DATA_TYPE* pMD) noexcept override { if (distributor) distributor->distribute(pMD); }
+    virtual void processEvent(const DATA_TYPE* pMD, int64_t sequence, bool end_of_batch) noexcept override {
+        if (distributor) distributor->distributeEvent(pMD, sequence, end_of_batch);
+    }
+    virtual void processWith(const typename BASE_HANDLER_TYPE::TRANSLATOR_TYPE& fill) noexcept override {
+        if (distributor) distributor->distributeWith(fill);
+    }
+    virtual void processBatch(const DATA_TYPE* events, size_t n) noexcept override {
+        if (distributor) distributor->distributeBatch(events, n);
+    }
     virtual void start() override { if (distributor) distributor->start(); }
     virtual void join() noexcept override { if (distributor) distributor->join(); }
     virtual void signal(int64_t stop_signal = disruptor::kDefaultStopSignal) noexcept override { if (distributor) distributor->signal(stop_signal); }
@@ -85,6 +139,15 @@ public:
     }
 
     virtual void distribute(const DATA_TYPE* pMD) noexcept override { if (handler_) handler_->process(pMD); }
+    virtual void distributeEvent(const DATA_TYPE* pMD, int64_t sequence, bool end_of_batch) noexcept override {
+        if (handler_) handler_->processEvent(pMD, sequence, end_of_batch);
+    }
+    virtual void distributeWith(const typename Distributor<T>::TRANSLATOR_TYPE& fill) noexcept override {
+        if (handler_) handler_->processWith(fill);
+    }
+    virtual void distributeBatch(const DATA_TYPE* events, size_t n) noexcept override {
+        if (handler_) handler_->processBatch(events, n);
+    }
     virtual void start() override { if (handler_) handler_->start(); }
     virtual void join() noexcept override { if (handler_) handler_->join(); }
     virtual void signal(int64_t stop_signal = kDefaultStopSignal) noexcept override { if (handler_) handler_->signal(stop_signal); }
@@ -122,6 +185,27 @@ public:
             if (rcv) rcv->process(pMD);
         }
     }
+    virtual void distributeEvent(const DATA_TYPE* pMD, int64_t sequence, bool end_of_batch) noexcept override {
+        for(auto& rcv : chain) {
+            if (rcv) rcv->processEvent(pMD, sequence, end_of_batch);
+        }
+    }
+    /** fill runs once, in the slot of the first handler taking the event, the others get a copy of it. */
+    virtual void distributeWith(const typename Distributor<T>::TRANSLATOR_TYPE& fill) noexcept override {
+        DATA_TYPE event;
+        bool built = false;
+        for(auto& rcv : chain) {
+            if (!rcv) continue;
+            //a handler dropping the event never calls its translator, the next one builds it then
+            if (built) rcv->processWith([&event](DATA_TYPE& slot) { slot = event; });
+            else rcv->processWith([&fill, &event, &built](DATA_TYPE& slot) { fill(slot); event = slot; built = true; });
+        }
+    }
+    virtual void distributeBatch(const DATA_TYPE* events, size_t n) noexcept override {
+        for(auto& rcv : chain) {
+            if (rcv) rcv->processBatch(events, n);
+        }
+    }
     virtual void start() override {
         for(auto &handler : chain) {
             if (handler) handler->start();
@@ -146,8 +230,11 @@ protected:
 
 template <class T, std::size_t N, typename C = disruptor::kDefaultClaimStrategyTemplate<N>, typename W = disruptor::kDefaultWaitStrategy>
 class ParallelDistributor : public Distributor<T> {
+    //metrics are collected when C collects them, an empty base otherwise
+    using CONSUMER_METRICS_TYPE = disruptor::BasicConsumerMetrics<C::kMetrics>;
+
     /** Async receiver, receive message from a disruptor queue. */
-    class AsyncHandlerWrapper
+    class AsyncHandlerWrapper : private CONSUMER_METRICS_TYPE
     {
     public:
         using DATA_TYPE = T;
@@ -162,6 +249,13 @@ class ParallelDistributor : public Distributor<T> {
         SEQUENCER_TYPE* sequencer;
         disruptor::Sequence*  sequence;
         std::chrono::nanoseconds timeout_interval{100000}; //timeout_interval check every 100us
+        size_t prefetch_distance = 0; //events fetched ahead of the one handled, 0 for none
+        size_t max_batch = 0; //the sequence is published at least every max_batch events, 0 for once per batch
+        disruptor::ThreadPlacement placement;
+        const disruptor::Sequence* claimed = nullptr; //observers only, last sequence the producer claimed
+        std::atomic<uint64_t> lost{0};
+        disruptor::TraceRing* trace = nullptr; //stamped by the producer when tracing
+        size_t trace_stage = 0;
 
     public:
         AsyncHandlerWrapper(BASE_HANDLER_TYPE* handler_)
@@ -188,45 +282,67 @@ class ParallelDistributor : public Distributor<T> {
         }
         void signal(int64_t stop_signal) noexcept {
             if (work_thread) {
-                stopSequence.store(stop_signal, std::memory_order::memory_order_release);
+                stopSequence.store(stop_signal, std::memory_order_release);
             }
         }
         void signal_pause() noexcept {
             if (work_thread) {
-                pauseFlag.store(true, std::memory_order::memory_order_release);
+                pauseFlag.store(true, std::memory_order_release);
             }
         }
         void signal_resume() noexcept {
             if (work_thread) {
-                pauseFlag.store(false, std::memory_order::memory_order_release);
+                pauseFlag.store(false, std::memory_order_release);
             }
         }
 
         template <class R, class P>
         void set_time_out(const std::chrono::duration<R, P>& timeout_) { timeout_interval = timeout_; }
         void disable_timeout() { timeout_interval = 0; }
+        /** Prefetch the event distance_ slots ahead of the one being handled, when it is already published. Set before attach. */
+        void set_prefetch_distance(size_t distance_) { prefetch_distance = distance_; }
+        /** Publish the sequence every max_batch_ events of a large batch so the producer is released sooner, end_of_batch
+         *  still flags the last available event only. Set before attach. */
+        void set_max_batch(size_t max_batch_) { max_batch = max_batch_; }
+        /** Placement applied by the work thread before it starts processing, set before attach. */
+        void setPlacement(const disruptor::ThreadPlacement& placement_) { placement = placement_; }
+        /** Observe the ring instead of gating it, claimed_ tells which slots the producer may be overwriting. Set before attach. */
+        void setObserver(const disruptor::Sequence* claimed_) { claimed = claimed_; }
+        /** Record the latency of each event handled as stage_ of trace_'s tracer. Set before attach. */
+        void setTrace(disruptor::TraceRing* trace_, size_t stage_) { trace = trace_; trace_stage = stage_; }
+        /** Events an observer was lapped on. */
+        uint64_t getLost() const noexcept { return lost.load(std::memory_order_relaxed); }
+        /** Batches and wait time of the work thread, its lag is left to the owner of the cursor. */
+        disruptor::ConsumerMetricsSnapshot getMetrics() const noexcept { return this->Snapshot(); }
 
         disruptor::Sequence* getSequence() noexcept { return sequence; }
+        bool isObserving() const noexcept { return claimed != nullptr; }
 
-        std::thread* attach(SEQUENCER_TYPE* sequencer_) noexcept {
+        /** Start processing the events of sequencer_ once every dependents sequence has moved past them. */
+        std::thread* attach(SEQUENCER_TYPE* sequencer_, const std::vector<disruptor::Sequence*>& dependents = {},
+                            int64_t init_idx = disruptor::kInitialCursorValue) noexcept {
             //create the work thread to start processing data
             if (work_thread) {
                 signal(kStopImmediatelySignal);
                 join(); //wait
             }
-            pauseFlag.store(false, std::memory_order::memory_order_release);
-            stopSequence.store(kDefaultStopSignal, std::memory_order::memory_order_release);
-            work_thread = new std::thread([this, sequencer_] { this->doWork(sequencer_); });
+            pauseFlag.store(false, std::memory_order_release);
+            stopSequence.store(kDefaultStopSignal, std::memory_order_release);
+            work_thread = new std::thread([this, sequencer_, dependents, init_idx] {
+                this->placement.Apply();
+                if (this->claimed) this->doObserve(sequencer_);
+                else this->doWork(sequencer_, dependents, init_idx);
+            });
             sequencer = sequencer_;
             return work_thread;
         }
         std::thread* getWorkThread() noexcept { return work_thread; }
 
     protected:
-        void doWork(SEQUENCER_TYPE* sequencer_, int64_t init_idx = disruptor::kInitialCursorValue) noexcept {
+        void doWork(SEQUENCER_TYPE* sequencer_, const std::vector<disruptor::Sequence*>& dependents,
+                    int64_t init_idx = disruptor::kInitialCursorValue) noexcept {
             //the body of the async handler, it kept checking the sequencer and process data when new ones comes in
-            std::vector<disruptor::Sequence*> dep(0);
-            BARRIER_TYPE *barrier = sequencer_->NewBarrier(dep);
+            BARRIER_TYPE *barrier = sequencer_->NewBarrier(dependents);
             sequence->set_sequence(init_idx);
             int64_t idx = init_idx;
             int64_t stopIdx = kDefaultStopSignal;
@@ -234,20 +350,79 @@ class ParallelDistributor : public Distributor<T> {
                 //allow timeout_interval to make sure we can stop even if there's no new publication
                 if (stopIdx == kDefaultStopSignal) {
                     do{
-                        stopIdx = stopSequence.load(std::memory_order::memory_order_acquire);
+                        stopIdx = stopSequence.load(std::memory_order_acquire);
+                        if (stopIdx != kDefaultStopSignal) break;
+                    } while(pauseFlag.load(std::memory_order_acquire));
+                    if (stopIdx == kStopImmediatelySignal) break;
+                }
+                if (stopIdx != kDefaultStopSignal && idx >= stopIdx) break; //do not wait past the stop sequence
+                //wait for the next unprocessed sequence, upstream handlers are only read again once it is ready
+                const typename CONSUMER_METRICS_TYPE::Wait wait = this->WaitBegin();
+                int64_t cursor=(timeout_interval <= std::chrono::nanoseconds(0) ? barrier->WaitFor(idx + 1) : barrier->WaitFor(idx + 1, timeout_interval));
+                this->WaitEnd(wait);
+                if (cursor > idx) this->Batch(cursor - idx);
+                const int64_t prefetch_end = cursor - static_cast<int64_t>(prefetch_distance);
+                for(size_t i = 1; i <= prefetch_distance && idx + static_cast<int64_t>(i) <= cursor; ++i) {
+                    disruptor::PrefetchForRead(&((*sequencer_)[idx + i]));
+                }
+                while(idx < cursor) {
+                    const int64_t end = (max_batch > 0 && cursor - idx > static_cast<int64_t>(max_batch)) ? idx + max_batch : cursor;
+                    while(idx < end) {
+                        ++idx;
+                        if (prefetch_distance > 0 && idx <= prefetch_end) disruptor::PrefetchForRead(&((*sequencer_)[idx + prefetch_distance]));
+                        const DATA_TYPE* msg = &((*sequencer_)[idx]);
+                        //events the handler publishes down a chain keep the origin of this one
+                        if (trace) disruptor::TraceOrigin() = trace->origin(idx);
+                        handler->processEvent(msg, idx, idx == cursor);
+                        if (trace) trace->Handled(trace_stage, idx);
+                    }
+                    if (end < cursor) sequence->set_sequence(idx);
+                }
+                if (trace) disruptor::TraceOrigin() = 0;
+                sequence->set_sequence(idx);
+                if (stopIdx != kDefaultStopSignal && idx >= stopIdx) break;
+            } while(true);
+            delete barrier;
+        }
+
+        /** doWork for an observer: its sequence gates nobody, so each event is copied then validated against the
+         *  producer's claims, and the events the producer overwrote first are skipped and counted as lost. */
+        void doObserve(SEQUENCER_TYPE* sequencer_) noexcept {
+            BARRIER_TYPE *barrier = sequencer_->NewBarrier({});
+            const int64_t size = sequencer_->size();
+            sequence->set_sequence(disruptor::kInitialCursorValue);
+            int64_t idx = disruptor::kInitialCursorValue;
+            int64_t stopIdx = kDefaultStopSignal;
+            do {
+                if (stopIdx == kDefaultStopSignal) {
+                    do{
+                        stopIdx = stopSequence.load(std::memory_order_acquire);
                         if (stopIdx != kDefaultStopSignal) break;
-                    } while(pauseFlag.load(std::memory_order::memory_order_acquire));
+                    } while(pauseFlag.load(std::memory_order_acquire));
                     if (stopIdx == kStopImmediatelySignal) break;
                 }
-                int64_t cursor=(timeout_interval <= std::chrono::nanoseconds(0) ? barrier->WaitFor(idx) : barrier->WaitFor(idx, timeout_interval));
+                if (stopIdx != kDefaultStopSignal && idx >= stopIdx) break;
+                const typename CONSUMER_METRICS_TYPE::Wait wait = this->WaitBegin();
+                int64_t cursor=(timeout_interval <= std::chrono::nanoseconds(0) ? barrier->WaitFor(idx + 1) : barrier->WaitFor(idx + 1, timeout_interval));
+                this->WaitEnd(wait);
+                if (cursor > idx) this->Batch(cursor - idx);
                 while(idx < cursor) {
                     ++idx;
-                    const DATA_TYPE* msg = &((*sequencer_)[idx]);
-                    handler->process(msg);
+                    DATA_TYPE msg = (*sequencer_)[idx];
+                    //pairs with the fence between advertising a claim and writing its slot
+                    std::atomic_thread_fence(std::memory_order_acquire);
+                    const int64_t oldest = claimed->sequence() - size + 1; //older slots may be overwritten
+                    if (idx < oldest) {
+                        lost.fetch_add(oldest - idx, std::memory_order_relaxed);
+                        idx = oldest - 1;
+                        continue;
+                    }
+                    handler->processEvent(&msg, idx, idx == cursor);
                 }
                 sequence->set_sequence(idx);
                 if (stopIdx != kDefaultStopSignal && idx >= stopIdx) break;
             } while(true);
+            delete barrier;
         }
     };
 
@@ -256,10 +431,51 @@ public:
     using BASE_HANDLER_TYPE = Handler<T>;
     using SEQUENCER_TYPE = disruptor::Sequencer<T, N, C, W>;
     using STOP_CHECK_FUNCTION_TYPE = std::function<bool(const DATA_TYPE*)>;
+    using TRANSLATOR_TYPE = typename Distributor<T>::TRANSLATOR_TYPE;
+
+    /** What distribution does when handlers fall behind and the ring is full:
+     *  Block waits for a free slot, DropNewest discards the incoming event, CountAndDrop discards it and counts it in dropped(). */
+    enum class Backpressure { Block, DropNewest, CountAndDrop };
+
+    /** RAII handle on a claimed ring slot: the event is built in place and published when the handle is destroyed.
+     *  An empty handle(false) is returned when the distributor is not started, nothing is published then.
+     *  A thread holds at most one handle per distributor: slots are published in claim order, a second handle destroyed
+     *  first would either wait forever on the first one or publish it unfilled, so claim() returns an empty one.
+     *  A handle moved to another thread is published there, the claiming thread gets handles again once it is. */
+    class Slot {
+    public:
+        Slot() : owner(nullptr), sequence_(disruptor::kInitialCursorValue) {}
+        Slot(ParallelDistributor* owner_, int64_t sequence__) : owner(owner_), sequence_(sequence__) {
+            openSlots().emplace_back(owner, sequence_);
+        }
+        Slot(Slot&& other) noexcept : owner(other.owner), sequence_(other.sequence_) { other.owner = nullptr; }
+        Slot(const Slot&) = delete;
+        Slot& operator=(const Slot&) = delete;
+        ~Slot() {
+            if (!owner) return;
+            //only listed on the claiming thread, see claim()
+            OPEN_SLOTS_TYPE& open = openSlots();
+            auto it = std::find(open.begin(), open.end(), OPEN_SLOT_TYPE(owner, sequence_));
+            if (it != open.end()) open.erase(it);
+            owner->publish(sequence_);
+        }
+
+        explicit operator bool() const noexcept { return owner != nullptr; }
+        DATA_TYPE& operator*() noexcept { return owner->data_sequencer[sequence_]; }
+        DATA_TYPE* operator->() noexcept { return &(owner->data_sequencer[sequence_]); }
+        int64_t sequence() const noexcept { return sequence_; }
+    private:
+        ParallelDistributor* owner;
+        int64_t sequence_;
+    };
 
     ParallelDistributor()
     : data_sequencer()
     { }
+    /** Distributor over a ring sized at runtime, N must be disruptor::kRuntimeRingBufferSize. */
+    explicit ParallelDistributor(size_t size, const disruptor::RingBufferOptions& options = disruptor::RingBufferOptions())
+    : data_sequencer(size, options)
+    { }
 
     virtual ~ParallelDistributor() {
         for(auto it=receivers.begin(); it != receivers.end(); ++it) {
@@ -269,23 +485,86 @@ public:
             }
         }
         receivers.clear();
+        for(auto& rcv : retired) delete rcv;
+        retired.clear();
     }
 
+    /** Also adds a handler to a running distributor, see attachHandler(). */
     virtual BASE_HANDLER_TYPE* addHandler(BASE_HANDLER_TYPE* rcv) override {
-        if (started_ || rcv == nullptr) return nullptr;
+        if (rcv == nullptr) return nullptr;
+        if (started_) return attachHandler(rcv, disruptor::ThreadPlacement());
         if (std::find(chain.begin(), chain.end(), rcv) == chain.end()) chain.push_back(rcv);
         return rcv;
     }
+    /** Add a handler that only sees an event once every handler in after is done with it, all in the same ring.
+     *  The handlers in after must have been added already, e.g. B and C after {A}, then D after {B, C} for a diamond.
+     *  Only the handlers nothing runs after gate the producer. */
+    BASE_HANDLER_TYPE* addHandlerAfter(BASE_HANDLER_TYPE* rcv, const std::vector<BASE_HANDLER_TYPE*>& after,
+                                       const disruptor::ThreadPlacement& placement = disruptor::ThreadPlacement()) {
+        if (started_ || rcv == nullptr || std::find(chain.begin(), chain.end(), rcv) != chain.end()) return nullptr;
+        for(auto& upstream : after) {
+            if (std::find(chain.begin(), chain.end(), upstream) == chain.end() || isObserver(upstream)) return nullptr;
+        }
+        chain.push_back(rcv);
+        upstreams[rcv] = after;
+        if (!placement.empty()) placements[rcv] = placement;
+        return rcv;
+    }
+    /** Add a handler whose work thread runs with the given placement. */
+    BASE_HANDLER_TYPE* addHandler(BASE_HANDLER_TYPE* rcv, const disruptor::ThreadPlacement& placement) {
+        if (started_) return rcv == nullptr ? nullptr : attachHandler(rcv, placement);
+        if (addHandler(rcv) == nullptr) return nullptr;
+        placements[rcv] = placement;
+        return rcv;
+    }
+    /** Add a lossy handler, e.g. for monitoring, that never gates the producer. When it falls a ring behind, it skips
+     *  the events overwritten under it and counts them in lost(). An observer cannot be run after. */
+    BASE_HANDLER_TYPE* addObserver(BASE_HANDLER_TYPE* rcv, const disruptor::ThreadPlacement& placement = disruptor::ThreadPlacement()) {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "observers copy slots the producer may be overwriting, events must be trivially copyable");
+        if (started_ || rcv == nullptr || std::find(chain.begin(), chain.end(), rcv) != chain.end()) return nullptr;
+        chain.push_back(rcv);
+        observers.push_back(rcv);
+        if (!placement.empty()) placements[rcv] = placement;
+        return rcv;
+    }
+    /** Also removes a handler from a running distributor, see detachHandler(). */
     virtual BASE_HANDLER_TYPE* removeHandler(BASE_HANDLER_TYPE* rcv) override {
-        if (started_) return nullptr;
+        if (isUpstream(rcv)) return nullptr; //keep the handlers running after rcv wired
+        if (started_) return detachHandler(rcv);
         for(auto it = chain.begin(); it != chain.end(); ++it) {
             if (*it == rcv) {
                 chain.erase(it);
+                placements.erase(rcv);
+                upstreams.erase(rcv);
+                observers.erase(std::remove(observers.begin(), observers.end(), rcv), observers.end());
                 return rcv;
             }
         }
         return nullptr;
     }
+    /** Events an observer skipped since start() because the producer lapped it. */
+    uint64_t lost(BASE_HANDLER_TYPE* observer) const noexcept {
+        for(size_t i = 0; i < receivers.size(); ++i) {
+            if (chain[i] == observer) return receivers[i]->getLost();
+        }
+        return 0;
+    }
+    /** Batches, wait time and lag behind the cursor of a started handler, empty unless DISRUPTOR_METRICS is defined. */
+    disruptor::ConsumerMetricsSnapshot metrics(BASE_HANDLER_TYPE* rcv) const noexcept {
+        for(size_t i = 0; i < receivers.size(); ++i) {
+            if (chain[i] != rcv) continue;
+            disruptor::ConsumerMetricsSnapshot snapshot = receivers[i]->getMetrics();
+            if (disruptor::kMetricsEnabled)
+                snapshot.lag = data_sequencer.GetCursor() - receivers[i]->getSequence()->sequence();
+            return snapshot;
+        }
+        return disruptor::ConsumerMetricsSnapshot();
+    }
+    /** Claims of the producer that stalled on a full ring, empty unless DISRUPTOR_METRICS is defined. */
+    disruptor::ClaimMetricsSnapshot claimMetrics() const noexcept { return data_sequencer.claim_metrics(); }
+    /** The ring, for a producer publishing ranges into it directly, like a bridge receiver, once started. */
+    SEQUENCER_TYPE& sequencer() noexcept { return data_sequencer; }
     virtual void join() noexcept override {
         if (started_) {
             for(auto& rcv : receivers) {
@@ -294,18 +573,100 @@ public:
             started_ = false;
         }
     }
+
+    /** Add a handler to the running ring: it starts after the current cursor and gates the producer from then on.
+     *  The producer picks the new gating set up on its next claim, lock free, so distribution never stops. */
+    BASE_HANDLER_TYPE* attachHandler(BASE_HANDLER_TYPE* rcv, const disruptor::ThreadPlacement& placement) {
+        if (!started_ || std::find(chain.begin(), chain.end(), rcv) != chain.end()) return nullptr;
+        freeRetired();
+        AsyncHandlerWrapper* arcv = new AsyncHandlerWrapper(rcv);
+        arcv->setPlacement(placement);
+        configure(arcv);
+        traceStage(arcv, chain.size());
+        //claims made against the previous gating set may have gone past the first cursor, only start after the
+        //cursor read once the new set is in place, see Sequencer::AddGatingSequence()
+        arcv->getSequence()->set_sequence(data_sequencer.GetCursor());
+        data_sequencer.AddGatingSequence(arcv->getSequence());
+        const int64_t cursor = data_sequencer.GetCursor();
+        arcv->getSequence()->set_sequence(cursor);
+        arcv->attach(&data_sequencer, {}, cursor);
+        chain.push_back(rcv);
+        receivers.push_back(arcv);
+        if (!placement.empty()) placements[rcv] = placement;
+        return rcv;
+    }
+
+    /** Stop a handler of the running ring right after its current batch, without stopping the others.
+     *  Handlers that only rcv ran after gate the producer from then on. */
+    BASE_HANDLER_TYPE* detachHandler(BASE_HANDLER_TYPE* rcv) {
+        if (!started_ || isUpstream(rcv)) return nullptr;
+        auto it = std::find(chain.begin(), chain.end(), rcv);
+        if (it == chain.end()) return nullptr;
+        AsyncHandlerWrapper* arcv = receivers[it - chain.begin()];
+        auto after = upstreams.find(rcv);
+        if (after != upstreams.end()) {
+            const std::vector<BASE_HANDLER_TYPE*> released = after->second;
+            upstreams.erase(after);
+            for(auto& upstream : released) {
+                if (isUpstream(upstream)) continue;
+                data_sequencer.AddGatingSequence(receivers[std::find(chain.begin(), chain.end(), upstream) - chain.begin()]->getSequence());
+            }
+        }
+        //rcv gates the producer until its current batch is done
+        arcv->signal(kStopImmediatelySignal);
+        arcv->join();
+        if (!isObserver(rcv)) data_sequencer.RemoveGatingSequence(arcv->getSequence());
+        //the producer may still read its sequence through a previous gating set, even from a claim waiting on it,
+        //which must not wait on it forever
+        arcv->getSequence()->set_sequence(std::numeric_limits<int64_t>::max());
+        retired.push_back(arcv);
+        receivers.erase(receivers.begin() + (it - chain.begin()));
+        chain.erase(it);
+        placements.erase(rcv);
+        observers.erase(std::remove(observers.begin(), observers.end(), rcv), observers.end());
+        freeRetired();
+        return rcv;
+    }
     //REMAIN: start right now is initialize + start, could separate to make it more dynamic
     virtual void start() override {
         if (!started_) {
+            if (first_touch_ && !chain.empty()) {
+                //fault the ring in from where the first handler runs so its pages land on the consumers' node
+                std::thread([this] {
+                    placementOf(chain.front()).Apply();
+                    data_sequencer.Prefault();
+                }).join();
+            }
+            //wrappers of a previous run were joined, receivers follow the chain order
+            for(auto& rcv : receivers) delete rcv;
+            receivers.clear();
+            std::map<BASE_HANDLER_TYPE*, AsyncHandlerWrapper*> wrappers;
             std::vector<disruptor::Sequence*> seq;
+            claimed_idx.set_sequence(last_claimed_idx.load(std::memory_order_relaxed));
             for(auto &handler : chain) {
                 AsyncHandlerWrapper* arcv = new AsyncHandlerWrapper(handler);
+                arcv->setPlacement(placementOf(handler));
+                configure(arcv);
                 receivers.emplace_back(arcv);
-                seq.emplace_back(arcv->getSequence());
+                wrappers[handler] = arcv;
+                //upstream handlers are gated by their downstream ones, only the terminal ones gate the producer
+                if (isObserver(handler)) arcv->setObserver(&claimed_idx);
+                else if (!isUpstream(handler)) seq.emplace_back(arcv->getSequence());
+                traceStage(arcv, receivers.size() - 1);
             }
             data_sequencer.set_gating_sequences(seq);
-            for(auto & arcv : receivers) {
-                arcv->attach(&data_sequencer);
+            //observers are only added before start(), the producer never reads the chain
+            observing_.store(!observers.empty(), std::memory_order_relaxed);
+            for(auto &handler : chain) {
+                std::vector<disruptor::Sequence*> dependents;
+                auto it = upstreams.find(handler);
+                if (it != upstreams.end()) {
+                    for(auto& upstream : it->second) {
+                        disruptor::Sequence* gating = upstream->gatingSequence();
+                        dependents.emplace_back(gating ? gating : wrappers[upstream]->getSequence());
+                    }
+                }
+                wrappers[handler]->attach(&data_sequencer, dependents);
             }
             started_ = true;
         }
@@ -314,19 +675,126 @@ public:
     //REMAIN: stop right now is pause + dispose, could separate to make it more dynamic
     virtual void signal(int64_t stop_signal = kDefaultStopSignal) noexcept override {
         if (started_) {
-            int64_t signal = (stop_signal == kDefaultStopSignal ? last_claimed_idx : stop_signal);
+            int64_t signal = (stop_signal == kDefaultStopSignal ? last_claimed_idx.load(std::memory_order_relaxed) : stop_signal);
             for(auto& rcv : receivers) {
                 rcv->signal(signal);
             }
         }
     }
 
+    /** Fault the ring in at start() from a thread placed like the first handler, so a runtime sized ring that was not
+     *  prefaulted nor bound to a node is allocated on the consumers' NUMA node. Only set before start(). */
+    void set_first_touch(bool first_touch) noexcept { first_touch_ = first_touch; }
+
+    /** Only set before start(). */
+    void set_backpressure(Backpressure policy) noexcept { backpressure_ = policy; }
+    /** Handlers prefetch the event distance slots ahead of the one they handle, worth it for events spanning several
+     *  cache lines. 0, the default, disables it. Only set before start(). */
+    void set_prefetch_distance(size_t distance) noexcept { prefetch_distance_ = distance; }
+    /** Handlers publish their sequence at least every max_batch events instead of once per available batch, so the
+     *  producer and downstream handlers do not wait for the end of a large batch. 0, the default, disables it.
+     *  Only set before start(). */
+    void set_max_batch(size_t max_batch) noexcept { max_batch_ = max_batch; }
+    Backpressure backpressure() const noexcept { return backpressure_; }
+    /** Trace the publish to handle latency of every event into tracer, the handlers being its stages first_stage,
+     *  first_stage + 1... in the chain order at start(), a handler attached later taking the stage after the last one.
+     *  Timestamps are kept in a side array, see disruptor::TraceRing. Observers are not traced. Only set before start(). */
+    void setTracer(disruptor::Tracer* tracer, size_t first_stage = 0) {
+        trace_ring_.reset(tracer ? new disruptor::TraceRing(data_sequencer.size(), tracer) : nullptr);
+        trace_first_stage_ = first_stage;
+    }
+    /** Timestamps of the traced events, null unless setTracer() was called. */
+    const disruptor::TraceRing* traceRing() const noexcept { return trace_ring_.get(); }
+    /** Events discarded under Backpressure::CountAndDrop. */
+    uint64_t dropped() const noexcept { return dropped_.load(std::memory_order_relaxed); }
+
     virtual void distribute(const DATA_TYPE* pMD) noexcept override
     {
         if (!started_) return; //discard any data that came in before we are started
-        last_claimed_idx = data_sequencer.Claim();
-        std::memcpy(&(data_sequencer[last_claimed_idx]), pMD, sizeof(DATA_TYPE));
-        data_sequencer.Publish(last_claimed_idx);
+        const int64_t idx = claimNext();
+        if (idx == disruptor::kInsufficientCapacitySignal) return;
+        data_sequencer[idx] = *pMD;
+        publish(idx);
+    }
+
+    /** Distribute without ever waiting on the handlers, whatever the policy.
+     *  @return false if the ring was full and the event was discarded. */
+    bool tryDistribute(const DATA_TYPE* pMD) noexcept
+    {
+        if (!started_) return false;
+        const int64_t idx = data_sequencer.TryClaim();
+        if (idx == disruptor::kInsufficientCapacitySignal) {
+            drop(1);
+            return false;
+        }
+        setLastClaimed(idx);
+        data_sequencer[idx] = *pMD;
+        publish(idx);
+        return true;
+    }
+
+    virtual void distributeWith(const TRANSLATOR_TYPE& fill) noexcept override
+    {
+        if (!started_) return;
+        const int64_t idx = claimNext();
+        if (idx == disruptor::kInsufficientCapacitySignal) return;
+        fill(data_sequencer[idx]);
+        publish(idx);
+    }
+
+    /** Copy a burst of events with one claim, one cursor update and one signal per ring size worth of events.
+     *  Under a dropping policy, a chunk that does not fit in the ring is discarded as a whole. */
+    virtual void distributeBatch(const DATA_TYPE* events, size_t n) noexcept override
+    {
+        if (!started_) return;
+        while (n > 0) {
+            const size_t delta = n < data_sequencer.size() ? n : data_sequencer.size();
+            auto range = claimRange(delta);
+            if (!range.empty()) {
+                std::copy(events, events + range.head_size(), range.head());
+                std::copy(events + range.head_size(), events + delta, range.tail());
+                publishRange(range);
+            }
+            events += delta;
+            n -= delta;
+        }
+    }
+
+    /** Claim n slots at once, 0 < n <= size(), to fill them and hand them to publishRange().
+     *  The range is empty when not started or when the backpressure policy drops the n events. */
+    disruptor::SequenceRange<DATA_TYPE> claimRange(size_t n) noexcept
+    {
+        if (!started_) return disruptor::SequenceRange<DATA_TYPE>();
+        auto range = (backpressure_ == Backpressure::Block ? data_sequencer.ClaimRange(n) : data_sequencer.TryClaimRange(n));
+        if (range.empty()) drop(n);
+        else setLastClaimed(range.last());
+        return range;
+    }
+    /** Publish a range from claimRange() with one cursor update and one signal. */
+    void publishRange(const disruptor::SequenceRange<DATA_TYPE>& range) noexcept
+    {
+        if (range.empty()) return;
+        if (trace_ring_) {
+            const uint64_t ticks = disruptor::TraceRing::PublishTicks();
+            for(int64_t idx = range.first(); idx <= range.last(); ++idx) trace_ring_->Stamp(idx, ticks);
+        }
+        data_sequencer.Publish(range);
+    }
+    size_t size() const noexcept { return data_sequencer.size(); }
+
+    /** Claim the next slot to build an event in place, see Slot. The handle is also empty when the policy drops the event,
+     *  or when the calling thread still holds a handle of this distributor. */
+    Slot claim() noexcept {
+        if (!started_) return Slot();
+        OPEN_SLOTS_TYPE& open = openSlots();
+        for(auto it = open.begin(); it != open.end(); ) {
+            if (it->first != this) ++it;
+            else if (it->second <= data_sequencer.GetCursor()) it = open.erase(it); //moved and published by another thread
+            else return Slot();
+        }
+        const int64_t idx = claimNext();
+        if (idx == disruptor::kInsufficientCapacitySignal) return Slot();
+        return Slot(this, idx);
     }
 
     void signal_pause_all() noexcept {
@@ -344,12 +812,774 @@ public:
         }
     }
 protected:
+    using OPEN_SLOT_TYPE = std::pair<const ParallelDistributor*, int64_t>;
+    using OPEN_SLOTS_TYPE = std::vector<OPEN_SLOT_TYPE>;
+    /** Distributors and sequences of the Slots the calling thread claimed and did not publish. */
+    static OPEN_SLOTS_TYPE& openSlots() noexcept {
+        static thread_local OPEN_SLOTS_TYPE open;
+        return open;
+    }
+    /** Claim one slot according to the backpressure policy, kInsufficientCapacitySignal if the event is dropped.
+     *  Producers fill and publish the sequence returned, last_claimed_idx may already be another producer's. */
+    int64_t claimNext() noexcept {
+        const int64_t idx = (backpressure_ == Backpressure::Block ? data_sequencer.Claim() : data_sequencer.TryClaim());
+        if (idx == disruptor::kInsufficientCapacitySignal) {
+            drop(1);
+            return idx;
+        }
+        setLastClaimed(idx);
+        return idx;
+    }
+    void publish(int64_t idx) noexcept {
+        if (trace_ring_) trace_ring_->Stamp(idx, disruptor::TraceRing::PublishTicks());
+        data_sequencer.Publish(idx);
+    }
+    /** Free the detached handlers once no publisher can read their sequences, see Sequencer::HasRetiredGatingSequences(). */
+    void freeRetired() {
+        if (retired.empty() || data_sequencer.HasRetiredGatingSequences()) return;
+        for(auto& rcv : retired) delete rcv;
+        retired.clear();
+    }
+    void configure(AsyncHandlerWrapper* arcv) {
+        arcv->set_prefetch_distance(prefetch_distance_);
+        arcv->set_max_batch(max_batch_);
+    }
+    void traceStage(AsyncHandlerWrapper* arcv, size_t position) {
+        const size_t stage = trace_first_stage_ + position;
+        if (trace_ring_ && !arcv->isObserving() && stage < trace_ring_->stages()) arcv->setTrace(trace_ring_.get(), stage);
+    }
+    /** Keep the highest claim for signal(), and observers must see a claim before its slots are written, see
+     *  AsyncHandlerWrapper::doObserve(). With several producers claims complete out of order, only move forward. */
+    void setLastClaimed(int64_t idx) noexcept {
+        if (kSingleProducer) {
+            last_claimed_idx.store(idx, std::memory_order_relaxed);
+        } else {
+            int64_t last = last_claimed_idx.load(std::memory_order_relaxed);
+            while (last < idx && !last_claimed_idx.compare_exchange_weak(last, idx, std::memory_order_relaxed)) {}
+        }
+        if (observing_.load(std::memory_order_relaxed)) {
+            if (kSingleProducer) {
+                claimed_idx.set_sequence(idx);
+            } else {
+                int64_t last = claimed_idx.sequence();
+                while (last < idx && !claimed_idx.CompareAndSet(last, idx)) last = claimed_idx.sequence();
+            }
+            std::atomic_thread_fence(std::memory_order_release);
+        }
+    }
+    bool isObserver(BASE_HANDLER_TYPE* rcv) const {
+        return std::find(observers.begin(), observers.end(), rcv) != observers.end();
+    }
+    bool isUpstream(BASE_HANDLER_TYPE* rcv) const {
+        for(auto& downstream : upstreams) {
+            if (std::find(downstream.second.begin(), downstream.second.end(), rcv) != downstream.second.end()) return true;
+        }
+        return false;
+    }
+    disruptor::ThreadPlacement placementOf(BASE_HANDLER_TYPE* rcv) const {
+        auto it = placements.find(rcv);
+        return it == placements.end() ? disruptor::ThreadPlacement() : it->second;
+    }
+    void drop(size_t n) noexcept {
+        if (backpressure_ == Backpressure::CountAndDrop) dropped_.fetch_add(n, std::memory_order_relaxed);
+    }
+
     bool started_ = false; //no change to the chain once we've started the distribution(so we don't need to handle syncronization issue
-    int64_t last_claimed_idx = disruptor::kInitialCursorValue;
+    Backpressure backpressure_ = Backpressure::Block;
+    bool first_touch_ = false;
+    size_t prefetch_distance_ = 0;
+    size_t max_batch_ = 0;
+    std::map<BASE_HANDLER_TYPE*, disruptor::ThreadPlacement> placements;
+    std::map<BASE_HANDLER_TYPE*, std::vector<BASE_HANDLER_TYPE*> > upstreams; //handlers each handler runs after
+    std::atomic<uint64_t> dropped_{0};
+    static constexpr bool kSingleProducer = std::is_same<C, disruptor::SingleThreadedStrategy<N, C::kMetrics> >::value;
+    std::atomic<int64_t> last_claimed_idx{disruptor::kInitialCursorValue}; //highest claim of any producer
+    disruptor::Sequence claimed_idx; //last_claimed_idx as seen by the observers
+    std::atomic<bool> observing_{false}; //observers were started, read by the producer instead of observers
+    std::unique_ptr<disruptor::TraceRing> trace_ring_;
+    size_t trace_first_stage_ = 0;
+    std::vector<BASE_HANDLER_TYPE* > observers;
     std::vector<BASE_HANDLER_TYPE* > chain;
     SEQUENCER_TYPE data_sequencer;
-    std::vector<AsyncHandlerWrapper* > receivers;
+    std::vector<AsyncHandlerWrapper* > receivers; //in the chain order
+    std::vector<AsyncHandlerWrapper* > retired; //detached while running, see freeRetired()
+
+};
+
+/** Route each event to one ring per handler by a key hash, so events with equal keys are processed in order by the
+ *  same handler while different keys are processed in parallel. A burst claims and publishes once per shard. */
+template<class T, std::size_t N=1024ul, typename C = disruptor::kDefaultClaimStrategyTemplate<N>, typename W = disruptor::kDefaultWaitStrategy>
+class ShardedDistributor : public Distributor<T> {
+public:
+    using DATA_TYPE = T;
+    using BASE_HANDLER_TYPE = Handler<T>;
+    using SHARD_TYPE = ParallelDistributor<T, N, C, W>;
+    /** Hash of the event key, e.g. its instrument id. */
+    using KEY_FUNCTION_TYPE = std::function<size_t(const DATA_TYPE&)>;
+
+    explicit ShardedDistributor(const KEY_FUNCTION_TYPE& key_)
+    : key(key_)
+    { }
+
+    virtual ~ShardedDistributor() {
+        for(auto& shard : shards) delete shard;
+        shards.clear();
+    }
+
+    /** Every handler processes its own shard, in its own ring. */
+    virtual BASE_HANDLER_TYPE* addHandler(BASE_HANDLER_TYPE* rcv) override {
+        return addHandler(rcv, disruptor::ThreadPlacement());
+    }
+    BASE_HANDLER_TYPE* addHandler(BASE_HANDLER_TYPE* rcv, const disruptor::ThreadPlacement& placement) {
+        if (started_ || rcv == nullptr) return nullptr;
+        if (std::find(chain.begin(), chain.end(), rcv) != chain.end()) return nullptr;
+        SHARD_TYPE* shard = new SHARD_TYPE();
+        shard->addHandler(rcv, placement);
+        chain.push_back(rcv);
+        shards.push_back(shard);
+        return rcv;
+    }
+    virtual BASE_HANDLER_TYPE* removeHandler(BASE_HANDLER_TYPE* rcv) override {
+        if (started_) return nullptr;
+        auto it = std::find(chain.begin(), chain.end(), rcv);
+        if (it == chain.end()) return nullptr;
+        auto shard = shards.begin() + (it - chain.begin());
+        delete *shard;
+        shards.erase(shard);
+        chain.erase(it);
+        return rcv;
+    }
+
+    virtual void start() override {
+        if (!started_) {
+            for(auto& shard : shards) shard->start();
+            ranges.resize(shards.size());
+            filled.resize(shards.size());
+            routes.reserve(N);
+            started_ = true;
+        }
+    }
+    virtual void join() noexcept override {
+        if (started_) {
+            for(auto& shard : shards) shard->join();
+            started_ = false;
+        }
+    }
+    /** The default stop signal stops every shard after its own last event. */
+    virtual void signal(int64_t stop_signal = kDefaultStopSignal) noexcept override {
+        if (started_) {
+            for(auto& shard : shards) shard->signal(stop_signal);
+        }
+    }
+
+    size_t shardOf(const DATA_TYPE& event) const { return key(event) % shards.size(); }
+
+    virtual void distribute(const DATA_TYPE* pMD) noexcept override
+    {
+        if (!started_ || shards.empty()) return;
+        shards[shardOf(*pMD)]->distribute(pMD);
+    }
+
+    /** Claim every shard's share of a window of at most N events at once, then fill and publish each shard once. */
+    virtual void distributeBatch(const DATA_TYPE* events, size_t n) noexcept override
+    {
+        if (!started_ || shards.empty()) return;
+        while (n > 0) {
+            const size_t window = n < N ? n : N;
+            std::fill(filled.begin(), filled.end(), 0);
+            routes.clear();
+            for(size_t i = 0; i < window; ++i) {
+                routes.push_back(shardOf(events[i]));
+                ++filled[routes.back()];
+            }
+            for(size_t shard = 0; shard < shards.size(); ++shard) {
+                ranges[shard] = (filled[shard] > 0 ? shards[shard]->claimRange(filled[shard]) : disruptor::SequenceRange<DATA_TYPE>());
+                filled[shard] = 0;
+            }
+            //a shard whose range is empty dropped its share, see ParallelDistributor::Backpressure
+            for(size_t i = 0; i < window; ++i) {
+                auto& range = ranges[routes[i]];
+                if (!range.empty()) range[filled[routes[i]]++] = events[i];
+            }
+            for(size_t shard = 0; shard < shards.size(); ++shard) shards[shard]->publishRange(ranges[shard]);
+            events += window;
+            n -= window;
+        }
+    }
+
+    /** Shards are only reachable before start(), e.g. to set their backpressure policy. */
+    SHARD_TYPE* shard(size_t index) noexcept { return started_ || index >= shards.size() ? nullptr : shards[index]; }
+
+protected:
+    bool started_ = false;
+    KEY_FUNCTION_TYPE key;
+    std::vector<BASE_HANDLER_TYPE*> chain;
+    std::vector<SHARD_TYPE*> shards;
+    //scratch space of distributeBatch(), sized at start()
+    std::vector<disruptor::SequenceRange<DATA_TYPE> > ranges;
+    std::vector<size_t> filled;
+    std::vector<size_t> routes;
+};
+
+/** Deliver only the latest event of each key, e.g. the last quote of an instrument, to consumers that cannot keep up
+ *  with the event rate. The producer overwrites the key's slot of a table under a seqlock and, when the key is not
+ *  already pending for a handler, queues the key in that handler's own ring of dirty keys. A handler reads the current
+ *  value of each dirty key, so its work scales with the number of distinct changed keys and it never gates the producer:
+ *  a key is queued at most twice per handler, and the dirty key rings hold 2 * keys entries.
+ *  Events must come from a single producer thread, whatever the key: every key is queued through the same dirty key
+ *  rings, and the default claim strategy C is single threaded. A handler may see the same value twice. */
+template<class T, std::size_t N=1024ul, typename C = disruptor::kDefaultClaimStrategyTemplate<N>, typename W = disruptor::kDefaultWaitStrategy>
+class ConflatingDistributor : public Distributor<T> {
+public:
+    using DATA_TYPE = T;
+    using BASE_HANDLER_TYPE = Handler<T>;
+    /** Index of the event key in [0, keys), e.g. a dense instrument id. */
+    using KEY_FUNCTION_TYPE = std::function<size_t(const DATA_TYPE&)>;
+    static_assert(std::is_trivially_copyable<T>::value, "conflated events are copied under a seqlock");
+
+protected:
+    using KEY_RING_TYPE = ParallelDistributor<size_t, N, C, W>;
+
+    struct Slot {
+        std::atomic<uint64_t> version{0}; //odd while the value is written
+        DATA_TYPE value;
+    };
+
+    /** Handler of a dirty key ring, hands the current value of each key to the conflated handler. */
+    class KeyReader : public Handler<size_t> {
+    public:
+        KeyReader(ConflatingDistributor* owner_, BASE_HANDLER_TYPE* target_)
+        : owner(owner_)
+        , target(target_)
+        , dirty(new std::atomic<bool>[owner_->keys]) {
+            for(size_t key = 0; key < owner->keys; ++key) dirty[key].store(false, std::memory_order_relaxed);
+        }
+        virtual void process(const size_t* key) noexcept override { processEvent(key, 0, true); }
+        virtual void processEvent(const size_t* key, int64_t sequence, bool end_of_batch) noexcept override {
+            //cleared first, so that a later write queues the key again
+            dirty[*key].store(false, std::memory_order_release);
+            T value;
+            owner->read(*key, value);
+            target->processEvent(&value, sequence, end_of_batch);
+        }
+        /** True when the key is newly pending and must be queued. */
+        bool mark(size_t key) noexcept { return !dirty[key].exchange(true, std::memory_order_acq_rel); }
+
+        ConflatingDistributor* owner;
+        BASE_HANDLER_TYPE* target;
+        std::unique_ptr<std::atomic<bool>[]> dirty;
+        KEY_RING_TYPE ring;
+    };
+
+public:
+    ConflatingDistributor(size_t keys_, const KEY_FUNCTION_TYPE& key_)
+    : keys(keys_)
+    , key(key_)
+    , table(new Slot[keys_]) {
+        if (keys_ == 0 || 2 * keys_ > N) throw std::invalid_argument("dirty key rings must hold twice the number of keys");
+    }
+
+    virtual ~ConflatingDistributor() {
+        for(auto& reader : readers) delete reader;
+        readers.clear();
+    }
+
+    /** Every handler gets its own dirty keys and its own ring. */
+    virtual BASE_HANDLER_TYPE* addHandler(BASE_HANDLER_TYPE* rcv) override {
+        return addHandler(rcv, disruptor::ThreadPlacement());
+    }
+    BASE_HANDLER_TYPE* addHandler(BASE_HANDLER_TYPE* rcv, const disruptor::ThreadPlacement& placement) {
+        if (started_ || rcv == nullptr) return nullptr;
+        for(auto& reader : readers) if (reader->target == rcv) return nullptr;
+        KeyReader* reader = new KeyReader(this, rcv);
+        reader->ring.addHandler(reader, placement);
+        readers.push_back(reader);
+        return rcv;
+    }
+    virtual BASE_HANDLER_TYPE* removeHandler(BASE_HANDLER_TYPE* rcv) override {
+        if (started_) return nullptr;
+        for(auto it = readers.begin(); it != readers.end(); ++it) {
+            if ((*it)->target == rcv) {
+                delete *it;
+                readers.erase(it);
+                return rcv;
+            }
+        }
+        return nullptr;
+    }
+
+    virtual void start() override {
+        if (!started_) {
+            for(auto& reader : readers) reader->ring.start();
+            started_ = true;
+        }
+    }
+    virtual void join() noexcept override {
+        if (started_) {
+            for(auto& reader : readers) reader->ring.join();
+            started_ = false;
+        }
+    }
+    /** The default stop signal stops every handler after the keys pending for it. */
+    virtual void signal(int64_t stop_signal = kDefaultStopSignal) noexcept override {
+        if (started_) {
+            for(auto& reader : readers) reader->ring.signal(stop_signal);
+        }
+    }
+
+    /** Overwrite the value of the event key, events whose key is out of range are counted in dropped(). */
+    virtual void distribute(const DATA_TYPE* pMD) noexcept override
+    {
+        const size_t index = key(*pMD);
+        if (index >= keys) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        Slot& slot = table[index];
+        const uint64_t version = slot.version.load(std::memory_order_relaxed);
+        slot.version.store(version + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(&slot.value, pMD, sizeof(DATA_TYPE));
+        slot.version.store(version + 2, std::memory_order_release);
+        if (!started_) return;
+        for(auto& reader : readers) {
+            if (reader->mark(index)) reader->ring.distribute(&index);
+        }
+    }
+
+    /** Copy the latest value of a key, false when nothing was distributed for it yet. */
+    bool latest(size_t index, DATA_TYPE& value) const noexcept {
+        if (index >= keys) return false;
+        return read(index, value) > 0;
+    }
+
+    size_t size() const noexcept { return keys; }
+    uint64_t dropped() const noexcept { return dropped_.load(std::memory_order_relaxed); }
+
+protected:
+    /** Seqlock read of a slot, returns its version. */
+    uint64_t read(size_t index, DATA_TYPE& value) const noexcept {
+        const Slot& slot = table[index];
+        while (true) {
+            const uint64_t before = slot.version.load(std::memory_order_acquire);
+            if (before & 1) {
+                disruptor::CpuRelax();
+                continue;
+            }
+            std::memcpy(&value, &slot.value, sizeof(DATA_TYPE));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.version.load(std::memory_order_relaxed) == before) return before;
+        }
+    }
+
+    bool started_ = false;
+    const size_t keys;
+    KEY_FUNCTION_TYPE key;
+    std::unique_ptr<Slot[]> table;
+    std::vector<KeyReader*> readers;
+    std::atomic<uint64_t> dropped_{0};
+};
+
+/** Distribute each event to exactly one of its handlers, the pool shares a single ring.
+ *  Every worker claims the next sequences from a shared work sequence with a CAS, claim_batch at a time, then waits
+ *  for them to be published. The producer is gated on the slowest worker only: before claiming, a worker advertises
+ *  the work sequence it read, so the slots it may get stay protected until it has processed them. */
+template<class T, std::size_t N=1024ul, typename C = disruptor::kDefaultClaimStrategyTemplate<N>, typename W = disruptor::kDefaultWaitStrategy>
+class WorkerPoolDistributor : public Distributor<T> {
+    class Worker
+    {
+    public:
+        using DATA_TYPE = T;
+        using BASE_HANDLER_TYPE = Handler<T>;
+        using SEQUENCER_TYPE = disruptor::Sequencer<T, N, C, W>;
+        using BARRIER_TYPE = disruptor::SequenceBarrier<W>;
+
+        Worker(BASE_HANDLER_TYPE* handler_, const disruptor::ThreadPlacement& placement_)
+        : handler(handler_)
+        , placement(placement_)
+        , stopSequence(disruptor::kDefaultStopSignal)
+        , work_thread(nullptr)
+        { }
+
+        ~Worker() {
+            signal(kStopImmediatelySignal);
+            join();
+        }
+
+        void join() noexcept {
+            if (work_thread) {
+                work_thread->join();
+                delete work_thread;
+                work_thread = nullptr;
+            }
+        }
+        void signal(int64_t stop_signal) noexcept {
+            stopSequence.store(stop_signal, std::memory_order_release);
+        }
+
+        disruptor::Sequence* getSequence() noexcept { return &sequence; }
+
+        std::thread* attach(SEQUENCER_TYPE* sequencer_, disruptor::Sequence* work_sequence_, size_t claim_batch_) noexcept {
+            stopSequence.store(kDefaultStopSignal, std::memory_order_release);
+            work_thread = new std::thread([this, sequencer_, work_sequence_, claim_batch_] {
+                this->placement.Apply();
+                this->doWork(sequencer_, work_sequence_, claim_batch_);
+            });
+            return work_thread;
+        }
+
+    protected:
+        //true once the worker must not process sequence
+        bool stopped(int64_t sequence_) const noexcept {
+            const int64_t stopIdx = stopSequence.load(std::memory_order_acquire);
+            return stopIdx == kStopImmediatelySignal || (stopIdx != kDefaultStopSignal && sequence_ > stopIdx);
+        }
+
+        void doWork(SEQUENCER_TYPE* sequencer_, disruptor::Sequence* work_sequence_, size_t claim_batch_) noexcept {
+            std::unique_ptr<BARRIER_TYPE> barrier(sequencer_->NewBarrier({}));
+            int64_t available = disruptor::kInitialCursorValue;
+            while (true) {
+                int64_t current, last;
+                do {
+                    current = work_sequence_->sequence();
+                    sequence.set_sequence(current);
+                    last = current + claim_batch_;
+                } while (!work_sequence_->CompareAndSet(current, last));
+
+                for(int64_t idx = current + 1; idx <= last; ++idx) {
+                    //allow timeout_interval to make sure we can stop even if there's no new publication
+                    while (available < idx) {
+                        if (stopped(idx)) return;
+                        const int64_t cursor = barrier->WaitFor(idx, timeout_interval);
+                        if (cursor >= idx) available = cursor;
+                    }
+                    handler->processEvent(&((*sequencer_)[idx]), idx, idx == last || idx == available);
+                    sequence.set_sequence(idx);
+                }
+            }
+        }
+
+        BASE_HANDLER_TYPE* handler;
+        disruptor::ThreadPlacement placement;
+        std::atomic<int64_t> stopSequence;
+        std::thread* work_thread;
+        disruptor::Sequence sequence;
+        std::chrono::nanoseconds timeout_interval{100000}; //timeout_interval check every 100us
+    };
+
+public:
+    using DATA_TYPE = T;
+    using BASE_HANDLER_TYPE = Handler<T>;
+    using SEQUENCER_TYPE = disruptor::Sequencer<T, N, C, W>;
+    using TRANSLATOR_TYPE = typename Distributor<T>::TRANSLATOR_TYPE;
+
+    WorkerPoolDistributor()
+    : data_sequencer()
+    { }
+
+    /** Pool over a ring sized at runtime, N must be disruptor::kRuntimeRingBufferSize. */
+    explicit WorkerPoolDistributor(size_t size, const disruptor::RingBufferOptions& options = disruptor::RingBufferOptions())
+    : data_sequencer(size, options)
+    { }
+
+    virtual ~WorkerPoolDistributor() {
+        for(auto& worker : workers) delete worker;
+        workers.clear();
+    }
+
+    /** Every handler added is a worker of the pool, each event is processed by only one of them. */
+    virtual BASE_HANDLER_TYPE* addHandler(BASE_HANDLER_TYPE* rcv) override {
+        return addHandler(rcv, disruptor::ThreadPlacement());
+    }
+    BASE_HANDLER_TYPE* addHandler(BASE_HANDLER_TYPE* rcv, const disruptor::ThreadPlacement& placement) {
+        if (started_ || rcv == nullptr) return nullptr;
+        if (std::find(chain.begin(), chain.end(), rcv) != chain.end()) return nullptr;
+        chain.push_back(rcv);
+        placements.push_back(placement);
+        return rcv;
+    }
+    virtual BASE_HANDLER_TYPE* removeHandler(BASE_HANDLER_TYPE* rcv) override {
+        if (started_) return nullptr;
+        auto it = std::find(chain.begin(), chain.end(), rcv);
+        if (it == chain.end()) return nullptr;
+        placements.erase(placements.begin() + (it - chain.begin()));
+        chain.erase(it);
+        return rcv;
+    }
+
+    /** Number of sequences a worker claims at once, larger batches mean fewer CAS on the work sequence but a coarser
+     *  balance between workers. Only set before start(). */
+    void set_claim_batch(size_t claim_batch) noexcept { if (claim_batch > 0) claim_batch_ = claim_batch; }
+
+    virtual void start() override {
+        if (!started_) {
+            std::vector<disruptor::Sequence*> seq;
+            for(size_t i = 0; i < chain.size(); ++i) {
+                Worker* worker = new Worker(chain[i], placements[i]);
+                workers.push_back(worker);
+                seq.push_back(worker->getSequence());
+            }
+            data_sequencer.set_gating_sequences(seq);
+            for(auto& worker : workers) worker->attach(&data_sequencer, &work_sequence, claim_batch_);
+            started_ = true;
+        }
+    }
+    virtual void join() noexcept override {
+        if (started_) {
+            for(auto& worker : workers) worker->join();
+            started_ = false;
+        }
+    }
+    virtual void signal(int64_t stop_signal = kDefaultStopSignal) noexcept override {
+        if (started_) {
+            int64_t signal = (stop_signal == kDefaultStopSignal ? last_claimed_idx.load(std::memory_order_relaxed) : stop_signal);
+            for(auto& worker : workers) worker->signal(signal);
+        }
+    }
+
+    virtual void distribute(const DATA_TYPE* pMD) noexcept override
+    {
+        if (!started_) return;
+        const int64_t idx = data_sequencer.Claim();
+        setLastClaimed(idx);
+        data_sequencer[idx] = *pMD;
+        data_sequencer.Publish(idx);
+    }
+    virtual void distributeWith(const TRANSLATOR_TYPE& fill) noexcept override
+    {
+        if (!started_) return;
+        const int64_t idx = data_sequencer.Claim();
+        setLastClaimed(idx);
+        fill(data_sequencer[idx]);
+        data_sequencer.Publish(idx);
+    }
+    virtual void distributeBatch(const DATA_TYPE* events, size_t n) noexcept override
+    {
+        if (!started_) return;
+        while (n > 0) {
+            const size_t delta = n < data_sequencer.size() ? n : data_sequencer.size();
+            auto range = data_sequencer.ClaimRange(delta);
+            std::copy(events, events + range.head_size(), range.head());
+            std::copy(events + range.head_size(), events + delta, range.tail());
+            setLastClaimed(range.last());
+            data_sequencer.Publish(range);
+            events += delta;
+            n -= delta;
+        }
+    }
+
+protected:
+    /** See ParallelDistributor::setLastClaimed(), workers have no observers. */
+    void setLastClaimed(int64_t idx) noexcept {
+        if (kSingleProducer) {
+            last_claimed_idx.store(idx, std::memory_order_relaxed);
+            return;
+        }
+        int64_t last = last_claimed_idx.load(std::memory_order_relaxed);
+        while (last < idx && !last_claimed_idx.compare_exchange_weak(last, idx, std::memory_order_relaxed)) {}
+    }
+
+    static constexpr bool kSingleProducer = std::is_same<C, disruptor::SingleThreadedStrategy<N, C::kMetrics> >::value;
+
+    bool started_ = false;
+    size_t claim_batch_ = 1;
+    std::atomic<int64_t> last_claimed_idx{disruptor::kInitialCursorValue}; //highest claim of any producer
+    std::vector<BASE_HANDLER_TYPE*> chain;
+    std::vector<disruptor::ThreadPlacement> placements;
+    SEQUENCER_TYPE data_sequencer;
+    disruptor::Sequence work_sequence; //last sequence claimed by a worker
+    std::vector<Worker*> workers;
+};
+
+/** Merge many producers into one consumer without producers ever contending: every producer publishes into its own
+ *  single producer ring, see producer(), and the consumer thread polls all of them and hands every event to its
+ *  handler. Rings are drained round-robin, or merged by timestamp, taking the earliest available event first.
+ *  end_of_batch flags the last event of a polling sweep over the rings. M collects the producers' claim metrics. */
+template<class T, std::size_t N=1024ul, typename W = disruptor::kDefaultWaitStrategy, bool M = disruptor::kMetricsEnabled>
+class FanInDistributor {
+public:
+    using DATA_TYPE = T;
+    using BASE_HANDLER_TYPE = Handler<T>;
+    using SEQUENCER_TYPE = disruptor::Sequencer<T, N, disruptor::SingleThreadedStrategy<N, M>, W>;
+    using BARRIER_TYPE = disruptor::SequenceBarrier<W>;
+    using TRANSLATOR_TYPE = typename Distributor<T>::TRANSLATOR_TYPE;
+    /** Timestamp of an event for merging by timestamp. */
+    using TIMESTAMP_FUNCTION_TYPE = std::function<int64_t(const DATA_TYPE&)>;
+
+    /** Publishing side of one producer's ring, only to be used by a single thread. Events published before start()
+     *  are discarded. */
+    class Producer : public Distributor<T> {
+    public:
+        explicit Producer(const std::atomic<bool>& started__) : started_(started__) {}
 
+        virtual void distribute(const DATA_TYPE* pMD) noexcept override
+        {
+            if (!started_.load(std::memory_order_acquire)) return;
+            const int64_t idx = sequencer.Claim();
+            sequencer[idx] = *pMD;
+            sequencer.Publish(idx);
+        }
+        virtual void distributeWith(const TRANSLATOR_TYPE& fill) noexcept override
+        {
+            if (!started_.load(std::memory_order_acquire)) return;
+            const int64_t idx = sequencer.Claim();
+            fill(sequencer[idx]);
+            sequencer.Publish(idx);
+        }
+        virtual void distributeBatch(const DATA_TYPE* events, size_t n) noexcept override
+        {
+            if (!started_.load(std::memory_order_acquire)) return;
+            while (n > 0) {
+                const size_t delta = n < N ? n : N;
+                auto range = sequencer.ClaimRange(delta);
+                std::copy(events, events + range.head_size(), range.head());
+                std::copy(events + range.head_size(), events + delta, range.tail());
+                sequencer.Publish(range);
+                events += delta;
+                n -= delta;
+            }
+        }
+
+    private:
+        friend class FanInDistributor;
+        const std::atomic<bool>& started_;
+        SEQUENCER_TYPE sequencer;
+        disruptor::Sequence consumed; //gates the producer on the consumer
+    };
+
+    /** Round-robin fan-in of producers rings. */
+    explicit FanInDistributor(size_t producers)
+    : handler(nullptr)
+    , started_(false)
+    , draining(false)
+    , stopping(false)
+    , work_thread(nullptr)
+    {
+        for(size_t i = 0; i < producers; ++i) {
+            producers_.emplace_back(new Producer(started_));
+            producers_.back()->sequencer.set_gating_sequences({&producers_.back()->consumed});
+        }
+    }
+    /** Fan-in merging producers rings by timestamp. */
+    FanInDistributor(size_t producers, const TIMESTAMP_FUNCTION_TYPE& timestamp_)
+    : FanInDistributor(producers)
+    {
+        timestamp = timestamp_;
+    }
+
+    virtual ~FanInDistributor() {
+        signal(kStopImmediatelySignal);
+        join();
+    }
+
+    /** The single consumer handler of the fan-in. */
+    BASE_HANDLER_TYPE* addHandler(BASE_HANDLER_TYPE* rcv) {
+        if (started_ || handler != nullptr || rcv == nullptr) return nullptr;
+        handler = rcv;
+        return rcv;
+    }
+
+    Producer& producer(size_t index) noexcept { return *producers_[index]; }
+    size_t producers() const noexcept { return producers_.size(); }
+
+    void start(const disruptor::ThreadPlacement& placement = disruptor::ThreadPlacement()) {
+        if (started_ || handler == nullptr) return;
+        draining.store(false, std::memory_order_release);
+        stopping.store(false, std::memory_order_release);
+        work_thread = new std::thread([this, placement] {
+            placement.Apply();
+            this->doWork();
+        });
+        started_.store(true, std::memory_order_release);
+    }
+    void join() noexcept {
+        if (work_thread) {
+            work_thread->join();
+            delete work_thread;
+            work_thread = nullptr;
+            started_.store(false, std::memory_order_release);
+        }
+    }
+    /** The default stop signal stops once every event published so far, in every ring, has been processed.
+     *  Rings have unrelated sequences, any other signal stops immediately. */
+    void signal(int64_t stop_signal = kDefaultStopSignal) noexcept {
+        if (!work_thread) return;
+        if (stop_signal == kDefaultStopSignal) {
+            stop_at.clear();
+            for(auto& p : producers_) stop_at.push_back(p->sequencer.GetCursor());
+            draining.store(true, std::memory_order_release);
+        } else {
+            stopping.store(true, std::memory_order_release);
+        }
+    }
+
+protected:
+    void doWork() noexcept {
+        const size_t size = producers_.size();
+        std::vector<std::unique_ptr<BARRIER_TYPE> > barriers;
+        std::vector<int64_t> next(size), available(size);
+        for(auto& p : producers_) {
+            barriers.emplace_back(p->sequencer.NewBarrier({}));
+            next[barriers.size() - 1] = p->consumed.sequence() + 1;
+        }
+        size_t idle = 0;
+        do {
+            if (stopping.load(std::memory_order_acquire)) break;
+            //read before polling, so that drained() covers every event up to stop_at
+            const bool drain = draining.load(std::memory_order_acquire);
+            size_t pending = 0;
+            for(size_t r = 0; r < size; ++r) {
+                available[r] = barriers[r]->TryWaitFor(next[r]);
+                if (available[r] >= next[r]) pending += available[r] - next[r] + 1;
+            }
+            if (pending == 0) {
+                if (drain && drained()) break;
+                //nothing to block on across rings, back off from spinning to yielding
+                if (++idle < kIdleSpins) disruptor::CpuRelax();
+                else std::this_thread::yield();
+                continue;
+            }
+            idle = 0;
+            if (timestamp) {
+                while (pending > 0) {
+                    size_t earliest = size;
+                    int64_t earliest_ts = 0;
+                    for(size_t r = 0; r < size; ++r) {
+                        if (next[r] > available[r]) continue;
+                        const int64_t ts = timestamp(producers_[r]->sequencer[next[r]]);
+                        if (earliest == size || ts < earliest_ts) { earliest = r; earliest_ts = ts; }
+                    }
+                    --pending;
+                    handler->processEvent(&(producers_[earliest]->sequencer[next[earliest]]), next[earliest], pending == 0);
+                    ++next[earliest];
+                }
+            } else {
+                for(size_t r = 0; r < size; ++r) {
+                    for(; next[r] <= available[r]; ++next[r]) {
+                        --pending;
+                        handler->processEvent(&(producers_[r]->sequencer[next[r]]), next[r], pending == 0);
+                    }
+                }
+            }
+            for(size_t r = 0; r < size; ++r) producers_[r]->consumed.set_sequence(next[r] - 1);
+        } while(true);
+    }
+    bool drained() const noexcept {
+        for(size_t r = 0; r < producers_.size(); ++r) {
+            if (producers_[r]->consumed.sequence() < stop_at[r]) return false;
+        }
+        return true;
+    }
+
+    static constexpr size_t kIdleSpins = 1000;
+    BASE_HANDLER_TYPE* handler;
+    TIMESTAMP_FUNCTION_TYPE timestamp;
+    std::atomic<bool> started_;
+    std::atomic<bool> draining;
+    std::atomic<bool> stopping;
+    std::vector<int64_t> stop_at; //cursor of each ring when signaled, published by draining
+    std::thread* work_thread;
+    std::vector<std::unique_ptr<Producer> > producers_;
 };
 
 template <class T>
@@ -367,16 +1597,35 @@ public:
         derived.clear();
     }
     virtual void signal(int64_t stop_signal = kDefaultStopSignal) noexcept override { SequentialDistributor<T>::signal(stop_signal); }
+    /** Trace the async handlers added from now on into tracer, each taking the next stage in the order they are added.
+     *  A sequential group is a single stage, worker pools are not traced. */
+    void setTracer(disruptor::Tracer* tracer) noexcept { tracer_ = tracer; }
     /** connect each rcv async.(wrap with an AsyncHandler)  with an AsyncGateway(a newly spawn queue). */
     template<std::size_t N=1024ul, typename C = disruptor::kDefaultClaimStrategyTemplate<N>, typename W = disruptor::kDefaultWaitStrategy>
-    BASE_HANDLER_TYPE* addAsyncHandlerParellel(const std::vector<BASE_HANDLER_TYPE *>& rcvs)
+    BASE_HANDLER_TYPE* addAsyncHandlerParellel(const std::vector<BASE_HANDLER_TYPE *>& rcvs,
+                                               const std::vector<disruptor::ThreadPlacement>& placements = {})
     {
+        //placements[i], when given, places the work thread of rcvs[i]
         ParallelDistributor<T, N, C, W>* pd = new ParallelDistributor<T, N, C, W>();
-        for(auto& rcv : rcvs) pd->addHandler(rcv);
+        for(size_t i = 0; i < rcvs.size(); ++i) {
+            if (i < placements.size()) pd->addHandler(rcvs[i], placements[i]);
+            else pd->addHandler(rcvs[i]);
+        }
+        traceStages(pd, rcvs.size());
         BASE_HANDLER_TYPE* res = this->addHandler(make_connector(pd));
         derived.push_back(res);
         return res;
     }
+    /** connect rcvs as a pool of workers, each event reaching exactly one of them. */
+    template<std::size_t N=1024ul, typename C = disruptor::kDefaultClaimStrategyTemplate<N>, typename W = disruptor::kDefaultWaitStrategy>
+    BASE_HANDLER_TYPE* addAsyncWorkerPool(const std::vector<BASE_HANDLER_TYPE *>& rcvs)
+    {
+        WorkerPoolDistributor<T, N, C, W>* wd = new WorkerPoolDistributor<T, N, C, W>();
+        for(auto& rcv : rcvs) wd->addHandler(rcv);
+        BASE_HANDLER_TYPE* res = this->addHandler(make_connector(wd));
+        derived.push_back(res);
+        return res;
+    }
     template<std::size_t N=1024ul, typename C = disruptor::kDefaultClaimStrategyTemplate<N>, typename W = disruptor::kDefaultWaitStrategy>
     BASE_HANDLER_TYPE* addAsyncHandlerSequential(const std::vector<BASE_HANDLER_TYPE *>& rcvs)
     {
@@ -384,6 +1633,7 @@ public:
         for(auto& rcv : rcvs) sd->addHandler(rcv);
         ParallelDistributor<T, N, C, W>* pd = new ParallelDistributor<T, N, C, W>();
         pd->addHandler(make_connector(sd));
+        traceStages(pd, 1);
         BASE_HANDLER_TYPE* res = this->addHandler(make_connector(pd));
         derived.push_back(res);
         return res;
@@ -407,7 +1657,16 @@ public:
         return d;
     }
 protected:
+    template <class PD>
+    void traceStages(PD* pd, size_t stages) {
+        if (!tracer_) return;
+        pd->setTracer(tracer_, next_stage_);
+        next_stage_ += stages;
+    }
+
     std::vector<BASE_HANDLER_TYPE*> derived;
+    disruptor::Tracer* tracer_ = nullptr;
+    size_t next_stage_ = 0;
 };
 }
 #endif
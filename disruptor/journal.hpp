@@ -0,0 +1,421 @@
+/** Journaling handler: appends events to memory mapped, pre-allocated segment files and makes them durable per batch
+ *  from a flusher thread, so the journaling stage never waits on the disk.
+ *  Replayer: reads a journal back into a ring with range claims, as fast as possible or paced by the journal clock. */
+/** Layout:
+ *    a journal is a directory of segments named <prefix>-<index>.journal, indexes starting at 0 without gaps.
+ *    A segment starts with a JournalSegmentHeader followed by fixed size records: a JournalRecordHeader and the event.
+ *    The record tag is written last, a record without it was never completely appended.
+ */
+#ifndef __DISRUPTOR__JOURNAL_HPP__
+#define __DISRUPTOR__JOURNAL_HPP__
+#include "handler.hpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace disruptor {
+
+constexpr uint64_t kJournalMagic = 0x4c4e52554f4a5344ULL; // "DSJOURNL"
+constexpr uint32_t kJournalVersion = 1;
+constexpr uint64_t kJournalRecordTag = 0x44524f434552ULL; // "RECORD"
+
+struct JournalSegmentHeader {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t record_size;
+    uint64_t event_size;
+    uint64_t records; //capacity of the segment
+    int64_t first_sequence;
+    uint64_t padding[3];
+};
+
+struct JournalRecordHeader {
+    std::atomic<uint64_t> tag;
+    int64_t sequence;
+    int64_t timestamp; //system clock nanoseconds when journaled
+};
+
+/** Name of the index-th segment of a journal. */
+inline std::string journalSegmentPath(const std::string& directory, const std::string& prefix, size_t index) {
+    char suffix[32];
+    std::snprintf(suffix, sizeof(suffix), "-%010zu.journal", index);
+    return directory + "/" + prefix + suffix;
+}
+
+template <class T>
+class JournalHandler : public Handler<T> {
+public:
+    using DATA_TYPE = T;
+    static_assert(std::is_trivially_copyable<T>::value, "journaled events must be trivially copyable");
+
+    static constexpr size_t kRecordSize = (sizeof(JournalRecordHeader) + sizeof(T) + 7) / 8 * 8;
+
+    /** Journal into directory, appending after its existing segments.
+     *  @param segment_size   bytes pre-allocated per segment file.
+     *  @param sync_interval  minimum time between two syncs, 0 to sync every batch as soon as it ends. */
+    JournalHandler(const std::string& directory_, size_t segment_size_ = 64ul << 20,
+                   std::chrono::nanoseconds sync_interval_ = std::chrono::nanoseconds(0),
+                   const std::string& prefix_ = "events")
+    : directory(directory_)
+    , prefix(prefix_)
+    , records_per_segment((segment_size_ - sizeof(JournalSegmentHeader)) / kRecordSize)
+    , sync_interval(sync_interval_)
+    {
+        if (segment_size_ < sizeof(JournalSegmentHeader) + kRecordSize)
+            throw std::invalid_argument("journal segments must hold at least one record");
+        next_index = 0;
+        struct stat status;
+        while (stat(journalSegmentPath(directory, prefix, next_index).c_str(), &status) == 0) ++next_index;
+        flusher = std::thread([this] { this->flush(); });
+    }
+
+    /** Makes every appended event durable before returning. */
+    virtual ~JournalHandler() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (current.base != nullptr) written = {current.base, current.used, last_sequence};
+            stopping = true;
+        }
+        wakeup.notify_one();
+        flusher.join();
+        release(current);
+    }
+
+    virtual void process(const DATA_TYPE* pMD) noexcept override { processEvent(pMD, last_sequence + 1, true); }
+
+    virtual void processEvent(const DATA_TYPE* pMD, int64_t sequence, bool end_of_batch) noexcept override {
+        if (failed_.load(std::memory_order_relaxed)) return;
+        if (current.base == nullptr || current.used == records_per_segment) roll(sequence);
+        if (current.base == nullptr || current.used == records_per_segment) {
+            //could not create a segment: the event is lost, stop journaling so that durable never moves past it
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (current.base != nullptr) written = {current.base, current.used, last_sequence};
+                failed_.store(true, std::memory_order_relaxed);
+            }
+            wakeup.notify_one();
+            return;
+        }
+        char* record = current.base + sizeof(JournalSegmentHeader) + current.used * kRecordSize;
+        JournalRecordHeader* header = reinterpret_cast<JournalRecordHeader*>(record);
+        header->sequence = sequence;
+        header->timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        std::memcpy(record + sizeof(JournalRecordHeader), pMD, sizeof(T));
+        header->tag.store(kJournalRecordTag, std::memory_order_release);
+        ++current.used;
+        last_sequence = sequence;
+        if (end_of_batch) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                written = {current.base, current.used, sequence};
+            }
+            wakeup.notify_one();
+        }
+    }
+
+    /** Downstream handlers gate on the journaled events, see durableSequence(). */
+    virtual disruptor::Sequence* gatingSequence() noexcept override { return &durable; }
+
+    /** Last sequence synced to disk. */
+    disruptor::Sequence* durableSequence() noexcept { return &durable; }
+
+    /** Number of failed syncs, the durable sequence does not move past them. */
+    size_t syncErrors() const noexcept { return sync_errors.load(std::memory_order_relaxed); }
+
+    /** True once a segment could not be created: that event and every later one are dropped, and the durable
+     *  sequence stops at the last event appended before it, so downstream handlers never pass a lost event. */
+    bool failed() const noexcept { return failed_.load(std::memory_order_relaxed); }
+
+protected:
+    struct Segment {
+        int fd = -1;
+        char* base = nullptr;
+        size_t size = 0;
+        size_t used = 0; //records appended
+    };
+    struct Mark {
+        char* base;
+        size_t used;
+        int64_t sequence;
+    };
+
+    void roll(int64_t first_sequence) noexcept {
+        Segment next;
+        next.size = sizeof(JournalSegmentHeader) + records_per_segment * kRecordSize;
+        const std::string path = journalSegmentPath(directory, prefix, next_index);
+        next.fd = open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+        if (next.fd >= 0 && posix_fallocate(next.fd, 0, next.size) == 0) {
+            void* base = mmap(nullptr, next.size, PROT_READ | PROT_WRITE, MAP_SHARED, next.fd, 0);
+            if (base != MAP_FAILED) next.base = static_cast<char*>(base);
+        }
+        if (next.base == nullptr) {
+            if (next.fd >= 0) close(next.fd);
+            sync_errors.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        ++next_index;
+        JournalSegmentHeader* header = reinterpret_cast<JournalSegmentHeader*>(next.base);
+        header->magic = kJournalMagic;
+        header->version = kJournalVersion;
+        header->record_size = kRecordSize;
+        header->event_size = sizeof(T);
+        header->records = records_per_segment;
+        header->first_sequence = first_sequence;
+        //full segments are synced and released by the flusher
+        std::lock_guard<std::mutex> lock(mutex);
+        if (current.base != nullptr) retired.push_back(current);
+        current = next;
+    }
+
+    /** Flusher thread: syncs what the handler appended up to its last batch end, then advances the durable sequence. */
+    void flush() noexcept {
+        auto last_sync = std::chrono::steady_clock::now() - sync_interval;
+        size_t synced_used = 0; //records of the current segment already synced
+        char* synced_base = nullptr;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            wakeup.wait(lock, [this] { return stopping || written.sequence > durable.sequence(); });
+            if (!stopping) {
+                const auto due = last_sync + sync_interval;
+                if (std::chrono::steady_clock::now() < due) {
+                    wakeup.wait_until(lock, due, [this] { return stopping; });
+                }
+            }
+            const Mark mark = written;
+            std::vector<Segment> full;
+            full.swap(retired);
+            const bool done = stopping;
+            lock.unlock();
+
+            bool synced = true;
+            bool mark_retired = false;
+            for(auto& segment : full) {
+                const size_t from = (segment.base == synced_base ? synced_used : 0);
+                synced &= syncRecords(segment.base, from, segment.used);
+                mark_retired |= (segment.base == mark.base);
+                if (segment.base == synced_base) synced_base = nullptr; //the address may be mapped again
+                release(segment);
+            }
+            if (!mark_retired && mark.base != nullptr && mark.sequence > durable.sequence()) {
+                const size_t from = (mark.base == synced_base ? synced_used : 0);
+                if (syncRecords(mark.base, from, mark.used)) {
+                    synced_base = mark.base;
+                    synced_used = mark.used;
+                } else {
+                    synced = false;
+                }
+            }
+            if (synced) {
+                if (mark.sequence > durable.sequence()) durable.set_sequence(mark.sequence);
+            } else {
+                sync_errors.fetch_add(1, std::memory_order_relaxed);
+            }
+            last_sync = std::chrono::steady_clock::now();
+            lock.lock();
+            if (done && written.sequence <= durable.sequence() && retired.empty()) break;
+            if (done && !synced) break; //do not spin on a failing disk while shutting down
+        }
+    }
+
+    /** msync records [from, to) of a segment, MS_SYNC on a shared file mapping writes back like fdatasync. */
+    bool syncRecords(char* base, size_t from, size_t to) noexcept {
+        if (to <= from) return true;
+        static const size_t page = sysconf(_SC_PAGESIZE);
+        size_t begin = (from == 0 ? 0 : sizeof(JournalSegmentHeader) + from * kRecordSize);
+        const size_t end = sizeof(JournalSegmentHeader) + to * kRecordSize;
+        begin -= begin % page;
+        return msync(base + begin, end - begin, MS_SYNC) == 0;
+    }
+
+    void release(Segment& segment) noexcept {
+        if (segment.base != nullptr) munmap(segment.base, segment.size);
+        if (segment.fd >= 0) close(segment.fd);
+        segment = Segment();
+    }
+
+    const std::string directory;
+    const std::string prefix;
+    const size_t records_per_segment;
+    const std::chrono::nanoseconds sync_interval;
+    size_t next_index;
+    int64_t last_sequence = disruptor::kInitialCursorValue;
+    Segment current; //only touched by the handler thread, but for its hand over to retired
+    disruptor::Sequence durable;
+    std::atomic<size_t> sync_errors{0};
+    std::atomic<bool> failed_{false};
+
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    bool stopping = false;
+    Mark written{nullptr, 0, disruptor::kInitialCursorValue}; //last batch end appended
+    std::vector<Segment> retired;
+    std::thread flusher;
+};
+
+template <class T> constexpr size_t JournalHandler<T>::kRecordSize;
+
+/** Publishes the records of a journal, in order, into a Sequencer or a ParallelDistributor.
+ *  Records are copied straight from the read-only mapped segments into ring ranges claimed in bulk, one publish per range.
+ *  A segment ends at its first incomplete record, the records of a later run being appended as the next segments, so
+ *  replay goes on with those and stops after the last segment or when stop() is called. */
+template <class T>
+class JournalReplayer {
+public:
+    using DATA_TYPE = T;
+    static_assert(std::is_trivially_copyable<T>::value, "journaled events must be trivially copyable");
+
+    /** Bytes asked to the kernel ahead of the replayed record. */
+    static constexpr size_t kReadAhead = 4ul << 20;
+
+    explicit JournalReplayer(const std::string& directory_, const std::string& prefix_ = "events")
+    : directory(directory_)
+    , prefix(prefix_)
+    {}
+
+    /** 0 replays as fast as the ring drains, otherwise the journal clock runs speed times faster than the wall clock. */
+    void set_speed(double speed_) noexcept { speed = speed_; }
+    double get_speed() const noexcept { return speed; }
+
+    /** Makes the running replay return after its current range, from any thread. */
+    void stop() noexcept { stopping.store(true, std::memory_order_release); }
+
+    /** Replay into a started distributor, returns the number of events published. Replay stops early if the distributor
+     *  is not started. Throws std::invalid_argument if its backpressure policy is not Block, the events would be dropped. */
+    template <size_t N, typename C, typename W>
+    size_t replay(ParallelDistributor<T, N, C, W>& target) {
+        if (target.backpressure() != ParallelDistributor<T, N, C, W>::Backpressure::Block)
+            throw std::invalid_argument("journals only replay into a distributor that blocks on a full ring");
+        return replayInto(target.size(),
+            [&target](size_t n) { return target.claimRange(n); },
+            [&target](const disruptor::SequenceRange<T>& range) { target.publishRange(range); });
+    }
+
+    /** Replay into a sequencer whose consumers are already gating it. */
+    template <size_t N, typename C, typename W>
+    size_t replay(disruptor::Sequencer<T, N, C, W>& target) {
+        return replayInto(target.size(),
+            [&target](size_t n) { return target.ClaimRange(n); },
+            [&target](const disruptor::SequenceRange<T>& range) { target.Publish(range); });
+    }
+
+protected:
+    template <class CLAIM, class PUBLISH>
+    size_t replayInto(size_t ring_size, const CLAIM& claim, const PUBLISH& publish) {
+        stopping.store(false, std::memory_order_release);
+        size_t replayed = 0;
+        bool paced = false;
+        int64_t journal_start = 0;
+        std::chrono::steady_clock::time_point wall_start;
+        struct stat status;
+        for(size_t index = 0; stat(journalSegmentPath(directory, prefix, index).c_str(), &status) == 0; ++index) {
+            const std::string path = journalSegmentPath(directory, prefix, index);
+            const int fd = open(path.c_str(), O_RDONLY);
+            if (fd < 0) throw std::system_error(errno, std::generic_category(), "open " + path);
+            void* mapped = mmap(nullptr, status.st_size, PROT_READ, MAP_SHARED, fd, 0);
+            close(fd);
+            if (mapped == MAP_FAILED) throw std::system_error(errno, std::generic_category(), "mmap " + path);
+            const char* base = static_cast<const char*>(mapped);
+            madvise(mapped, status.st_size, MADV_SEQUENTIAL);
+            const JournalSegmentHeader* header = reinterpret_cast<const JournalSegmentHeader*>(base);
+            if (static_cast<size_t>(status.st_size) < sizeof(JournalSegmentHeader) || header->magic != kJournalMagic
+                || header->version != kJournalVersion || header->event_size != sizeof(T)
+                || header->record_size != JournalHandler<T>::kRecordSize) {
+                munmap(mapped, status.st_size);
+                throw std::runtime_error("not a journal segment of this event type: " + path);
+            }
+            if (header->records > (static_cast<size_t>(status.st_size) - sizeof(JournalSegmentHeader)) / kRecordSize) {
+                munmap(mapped, status.st_size);
+                throw std::runtime_error("truncated journal segment: " + path);
+            }
+            const char* records = base + sizeof(JournalSegmentHeader);
+            size_t ahead = 0; //records already advised
+            bool complete = true;
+            for(size_t next = 0; next < header->records && complete;) {
+                if (stopping.load(std::memory_order_acquire)) {
+                    munmap(mapped, status.st_size);
+                    return replayed;
+                }
+                if (next >= ahead) {
+                    const size_t window = std::min<size_t>(kReadAhead / kRecordSize + 1, header->records - next);
+                    static const size_t page = sysconf(_SC_PAGESIZE);
+                    size_t offset = sizeof(JournalSegmentHeader) + next * kRecordSize;
+                    offset -= offset % page;
+                    madvise(const_cast<char*>(base) + offset,
+                            sizeof(JournalSegmentHeader) + (next + window) * kRecordSize - offset, MADV_WILLNEED);
+                    ahead = next + window;
+                }
+                //the longest run of complete records that fits the ring and is due
+                size_t n = 0;
+                const size_t limit = std::min(ring_size, header->records - next);
+                std::chrono::steady_clock::time_point now;
+                while (n < limit) {
+                    const JournalRecordHeader* record = recordAt(records, next + n);
+                    if (record->tag.load(std::memory_order_acquire) != kJournalRecordTag) {
+                        complete = false;
+                        break;
+                    }
+                    if (speed > 0) {
+                        if (!paced) {
+                            paced = true;
+                            journal_start = record->timestamp;
+                            wall_start = std::chrono::steady_clock::now();
+                        }
+                        const auto due = wall_start + std::chrono::nanoseconds(
+                            static_cast<int64_t>((record->timestamp - journal_start) / speed));
+                        if (n == 0) {
+                            std::this_thread::sleep_until(due);
+                            now = std::chrono::steady_clock::now();
+                        } else if (due > now) {
+                            break;
+                        }
+                    }
+                    ++n;
+                }
+                if (n == 0) break;
+                auto range = claim(n);
+                if (range.empty()) {
+                    //a distributor that is not started takes nothing
+                    munmap(mapped, status.st_size);
+                    return replayed;
+                }
+                for(size_t i = 0; i < n; ++i) {
+                    std::memcpy(&range[i], reinterpret_cast<const char*>(recordAt(records, next + i)) + sizeof(JournalRecordHeader), sizeof(T));
+                }
+                publish(range);
+                next += n;
+                replayed += n;
+            }
+            munmap(mapped, status.st_size);
+        }
+        return replayed;
+    }
+
+    static const JournalRecordHeader* recordAt(const char* records, size_t i) noexcept {
+        return reinterpret_cast<const JournalRecordHeader*>(records + i * kRecordSize);
+    }
+
+    static constexpr size_t kRecordSize = JournalHandler<T>::kRecordSize;
+    const std::string directory;
+    const std::string prefix;
+    double speed = 0;
+    std::atomic<bool> stopping{false};
+};
+
+template <class T> constexpr size_t JournalReplayer<T>::kReadAhead;
+template <class T> constexpr size_t JournalReplayer<T>::kRecordSize;
+}
+#endif
@@ -0,0 +1,197 @@
+// Copyright (c) 2011-2015, Francois Saint-Jacques
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the disruptor-- nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL FRANCOIS SAINT-JACQUES BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef DISRUPTOR_METRICS_H_  // NOLINT
+#define DISRUPTOR_METRICS_H_  // NOLINT
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "sequence.h"
+
+namespace disruptor {
+
+// Metrics are only collected when DISRUPTOR_METRICS is defined, otherwise
+// the metrics classes are empty and their calls compile out.
+// Default of the metrics parameter of the claim strategies, and through
+// them of the distributors: a translation unit built with another setting
+// uses other types, never another layout of the same ones.
+#ifdef DISRUPTOR_METRICS
+constexpr bool kMetricsEnabled = true;
+#else
+constexpr bool kMetricsEnabled = false;
+#endif
+
+// Batch sizes are counted in power of 2 buckets: bucket b counts batches of
+// [2^b, 2^(b+1)) events, the last bucket also counts every larger batch.
+constexpr size_t kBatchSizeBuckets = 16;
+
+inline size_t BatchSizeBucket(uint64_t size) {
+  const size_t bucket = 63 - __builtin_clzll(size | 1);
+  return bucket < kBatchSizeBuckets ? bucket : kBatchSizeBuckets - 1;
+}
+
+// Claims that waited on the consumers because the ring was full.
+struct ClaimMetricsSnapshot {
+  uint64_t stalls;
+  uint64_t stall_nanoseconds;
+};
+
+// Work of a consumer, see BasicConsumerMetrics.
+struct ConsumerMetricsSnapshot {
+  uint64_t batches;
+  uint64_t events;
+  uint64_t wait_nanoseconds;
+  std::array<uint64_t, kBatchSizeBuckets> batch_sizes;
+  // cursor - consumer sequence when the snapshot was taken, only filled in
+  // by the owners of the cursor such as ParallelDistributor::metrics().
+  int64_t lag;
+};
+
+// Counters of a claim strategy, written by its publishers on the slow path
+// only, when a claim has to wait for the consumers.
+template <bool E = kMetricsEnabled>
+class BasicClaimMetrics {
+ public:
+  typedef std::chrono::steady_clock::time_point Stall;
+
+  BasicClaimMetrics() : stalls_(0), stall_nanoseconds_(0) {}
+
+  Stall StallBegin() { return std::chrono::steady_clock::now(); }
+
+  void StallEnd(const Stall& begin) {
+    const auto stalled = std::chrono::steady_clock::now() - begin;
+    stalls_.fetch_add(1, std::memory_order_relaxed);
+    stall_nanoseconds_.fetch_add(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(stalled).count(),
+        std::memory_order_relaxed);
+  }
+
+  // Safe to call from any thread.
+  ClaimMetricsSnapshot Snapshot() const {
+    return ClaimMetricsSnapshot{stalls_.load(std::memory_order_relaxed),
+                                stall_nanoseconds_.load(
+                                    std::memory_order_relaxed)};
+  }
+
+ private:
+  // padding
+  int64_t padding0_[ATOMIC_SEQUENCE_PADDING_LENGTH];
+  // members
+  std::atomic<uint64_t> stalls_;
+  std::atomic<uint64_t> stall_nanoseconds_;
+  // padding
+  int64_t padding1_[ATOMIC_SEQUENCE_PADDING_LENGTH];
+
+  DISALLOW_COPY_MOVE_AND_ASSIGN(BasicClaimMetrics);
+};
+
+template <>
+class BasicClaimMetrics<false> {
+ public:
+  typedef int Stall;
+
+  Stall StallBegin() { return 0; }
+  void StallEnd(const Stall&) {}
+  ClaimMetricsSnapshot Snapshot() const { return ClaimMetricsSnapshot(); }
+};
+
+typedef BasicClaimMetrics<> ClaimMetrics;
+
+// Counters of a consumer thread. They have a single writer, so they are
+// updated without atomic read-modify-write, and can be read by any thread.
+template <bool E = kMetricsEnabled>
+class BasicConsumerMetrics {
+ public:
+  typedef std::chrono::steady_clock::time_point Wait;
+
+  BasicConsumerMetrics() : batches_(0), events_(0), wait_nanoseconds_(0) {
+    for (auto& bucket : batch_sizes_) bucket.store(0);
+  }
+
+  Wait WaitBegin() { return std::chrono::steady_clock::now(); }
+
+  void WaitEnd(const Wait& begin) {
+    const auto waited = std::chrono::steady_clock::now() - begin;
+    Add(wait_nanoseconds_,
+        std::chrono::duration_cast<std::chrono::nanoseconds>(waited).count());
+  }
+
+  // Count a batch of events handed to the handler.
+  void Batch(uint64_t size) {
+    Add(batches_, 1);
+    Add(events_, size);
+    Add(batch_sizes_[BatchSizeBucket(size)], 1);
+  }
+
+  // Safe to call from any thread, the lag is left to the caller.
+  ConsumerMetricsSnapshot Snapshot() const {
+    ConsumerMetricsSnapshot snapshot;
+    snapshot.batches = batches_.load(std::memory_order_relaxed);
+    snapshot.events = events_.load(std::memory_order_relaxed);
+    snapshot.wait_nanoseconds = wait_nanoseconds_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < kBatchSizeBuckets; ++i)
+      snapshot.batch_sizes[i] = batch_sizes_[i].load(std::memory_order_relaxed);
+    snapshot.lag = 0;
+    return snapshot;
+  }
+
+ private:
+  static void Add(std::atomic<uint64_t>& counter, uint64_t value) {
+    counter.store(counter.load(std::memory_order_relaxed) + value,
+                  std::memory_order_relaxed);
+  }
+
+  // padding
+  int64_t padding0_[ATOMIC_SEQUENCE_PADDING_LENGTH];
+  // members
+  std::atomic<uint64_t> batches_;
+  std::atomic<uint64_t> events_;
+  std::atomic<uint64_t> wait_nanoseconds_;
+  std::array<std::atomic<uint64_t>, kBatchSizeBuckets> batch_sizes_;
+  // padding
+  int64_t padding1_[ATOMIC_SEQUENCE_PADDING_LENGTH];
+
+  DISALLOW_COPY_MOVE_AND_ASSIGN(BasicConsumerMetrics);
+};
+
+template <>
+class BasicConsumerMetrics<false> {
+ public:
+  typedef int Wait;
+
+  Wait WaitBegin() { return 0; }
+  void WaitEnd(const Wait&) {}
+  void Batch(uint64_t) {}
+  ConsumerMetricsSnapshot Snapshot() const { return ConsumerMetricsSnapshot(); }
+};
+
+typedef BasicConsumerMetrics<> ConsumerMetrics;
+
+};  // namespace disruptor
+
+#endif  // DISRUPTOR_METRICS_H_ NOLINT
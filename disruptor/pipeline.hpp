@@ -0,0 +1,202 @@
+/** Statically composed pipelines: the compile time counterpart of the Handler/Distributor hierarchy in handler.hpp.
+ *  A stage is any type with a processEvent(const T*, int64_t sequence, bool end_of_batch) member, it does not derive
+ *  from Handler and its calls are resolved, and inlinable, at compile time instead of through virtual dispatch.
+ *  Sequential runs its stages one after the other on the calling thread, like SequentialDistributor.
+ *  Parallel runs each of its stages on its own thread behind a ring, like ParallelDistributor.
+ *  Stages are held by reference and may be Sequential or Parallel themselves, e.g.
+ *      Parallel<Quote, 1024, Risk, Audit> fanout(risk, audit);
+ *      auto pipeline = sequential(decode, fanout);
+ *      pipeline.start(); pipeline.process(&quote); pipeline.signal(); pipeline.join();
+ */
+#ifndef __DISRUPTOR__PIPELINE_HPP__
+#define __DISRUPTOR__PIPELINE_HPP__
+#include "sequencer.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace disruptor {
+
+namespace detail {
+/** Call f(stage, index) on each element of a tuple of stages, in order. */
+template <size_t I, size_t COUNT>
+struct ForEachStage {
+    template <class TUPLE, class F>
+    static void apply(TUPLE& stages, F& f) {
+        f(std::get<I>(stages), I);
+        ForEachStage<I + 1, COUNT>::apply(stages, f);
+    }
+};
+template <size_t COUNT>
+struct ForEachStage<COUNT, COUNT> {
+    template <class TUPLE, class F>
+    static void apply(TUPLE&, F&) {}
+};
+
+/** Life cycle calls, forwarded only to the stages that have them. */
+template <class S> auto startStage(S& stage, int) -> decltype(stage.start(), void()) { stage.start(); }
+template <class S> void startStage(S&, long) {}
+template <class S> auto joinStage(S& stage, int) -> decltype(stage.join(), void()) { stage.join(); }
+template <class S> void joinStage(S&, long) {}
+template <class S> auto signalStage(S& stage, int64_t stop_signal, int) -> decltype(stage.signal(stop_signal), void()) {
+    stage.signal(stop_signal);
+}
+template <class S> void signalStage(S&, int64_t, long) {}
+
+struct StartStage { template <class S> void operator()(S& stage, size_t) const { startStage(stage, 0); } };
+struct JoinStage { template <class S> void operator()(S& stage, size_t) const { joinStage(stage, 0); } };
+struct SignalStage {
+    int64_t stop_signal;
+    template <class S> void operator()(S& stage, size_t) const { signalStage(stage, stop_signal, 0); }
+};
+template <class T>
+struct ProcessStage {
+    const T* event;
+    int64_t sequence;
+    bool end_of_batch;
+    template <class S> void operator()(S& stage, size_t) const { stage.processEvent(event, sequence, end_of_batch); }
+};
+}
+
+/** Run every stage on each event, in order, on the calling thread. */
+template <class... STAGES>
+class Sequential {
+public:
+    explicit Sequential(STAGES&... stages_) : stages(stages_...) {}
+
+    template <class T>
+    void processEvent(const T* pMD, int64_t sequence, bool end_of_batch) noexcept {
+        detail::ProcessStage<T> process{pMD, sequence, end_of_batch};
+        detail::ForEachStage<0, sizeof...(STAGES)>::apply(stages, process);
+    }
+    template <class T>
+    void process(const T* pMD) noexcept { processEvent(pMD, 0, true); }
+
+    void start() {
+        detail::StartStage start_;
+        detail::ForEachStage<0, sizeof...(STAGES)>::apply(stages, start_);
+    }
+    /** The stages run their events to completion on the calling thread, only nested Parallel stages have to stop. */
+    void signal(int64_t stop_signal = kDefaultStopSignal) noexcept {
+        detail::SignalStage signal_{stop_signal};
+        detail::ForEachStage<0, sizeof...(STAGES)>::apply(stages, signal_);
+    }
+    void join() noexcept {
+        detail::JoinStage join_;
+        detail::ForEachStage<0, sizeof...(STAGES)>::apply(stages, join_);
+    }
+
+protected:
+    std::tuple<STAGES&...> stages;
+};
+
+/** Sequential composition of stages, deducing their types. */
+template <class... STAGES>
+Sequential<STAGES...> sequential(STAGES&... stages) { return Sequential<STAGES...>(stages...); }
+
+/** Publish each event once into a ring that every stage consumes on its own thread, the producer is gated on the
+ *  slowest stage. The consumer loops call their stage directly, with the batch boundaries of the ring. */
+template <class T, std::size_t N, typename C, typename W, class... STAGES>
+class BasicParallel {
+public:
+    using DATA_TYPE = T;
+    using SEQUENCER_TYPE = disruptor::Sequencer<T, N, C, W>;
+    static constexpr size_t kStages = sizeof...(STAGES);
+
+    explicit BasicParallel(STAGES&... stages_) : stages(stages_...) {
+        std::vector<disruptor::Sequence*> gating;
+        for(auto& sequence : sequences) gating.push_back(&sequence);
+        sequencer.set_gating_sequences(gating);
+    }
+    ~BasicParallel() {
+        signal(kStopImmediatelySignal);
+        join();
+    }
+
+    /** Publish an event, from one producer thread. */
+    void processEvent(const DATA_TYPE* pMD, int64_t, bool) noexcept {
+        if (!started_) return;
+        last_claimed_idx = sequencer.Claim();
+        sequencer[last_claimed_idx] = *pMD;
+        sequencer.Publish(last_claimed_idx);
+    }
+    void process(const DATA_TYPE* pMD) noexcept { processEvent(pMD, 0, true); }
+
+    /** Start the stages, then one consumer thread per stage. */
+    void start() {
+        if (started_) return;
+        detail::StartStage start_;
+        detail::ForEachStage<0, kStages>::apply(stages, start_);
+        stop_sequence.store(kDefaultStopSignal, std::memory_order_release);
+        Spawn spawn{this};
+        detail::ForEachStage<0, kStages>::apply(stages, spawn);
+        started_ = true;
+    }
+    /** The default stop signal stops each consumer after the last published event, then the stages are signaled. */
+    void signal(int64_t stop_signal = kDefaultStopSignal) noexcept {
+        if (!started_) return;
+        stop_sequence.store(stop_signal == kDefaultStopSignal ? last_claimed_idx : stop_signal,
+                            std::memory_order_release);
+        stop_signal_ = stop_signal;
+    }
+    void join() noexcept {
+        if (!started_) return;
+        for(auto& thread : threads) thread.join();
+        threads.clear();
+        //stages see their last event before they are stopped themselves
+        detail::SignalStage signal_{stop_signal_};
+        detail::ForEachStage<0, kStages>::apply(stages, signal_);
+        detail::JoinStage join_;
+        detail::ForEachStage<0, kStages>::apply(stages, join_);
+        started_ = false;
+    }
+
+protected:
+    struct Spawn {
+        BasicParallel* owner;
+        template <class S> void operator()(S& stage, size_t index) const {
+            BasicParallel* self = owner;
+            self->threads.emplace_back([self, &stage, index] { self->consume(stage, self->sequences[index]); });
+        }
+    };
+
+    template <class S>
+    void consume(S& stage, disruptor::Sequence& sequence) noexcept {
+        std::unique_ptr<disruptor::SequenceBarrier<W> > barrier(sequencer.NewBarrier({}));
+        int64_t idx = sequence.sequence();
+        while (true) {
+            const int64_t stop = stop_sequence.load(std::memory_order_acquire);
+            if (stop == kStopImmediatelySignal || (stop != kDefaultStopSignal && idx >= stop)) break;
+            const int64_t cursor = barrier->WaitFor(idx + 1, timeout_interval);
+            while (idx < cursor) {
+                ++idx;
+                stage.processEvent(&sequencer[idx], idx, idx == cursor);
+            }
+            sequence.set_sequence(idx);
+        }
+    }
+
+    std::tuple<STAGES&...> stages;
+    SEQUENCER_TYPE sequencer;
+    std::array<disruptor::Sequence, kStages> sequences;
+    std::vector<std::thread> threads;
+    std::atomic<int64_t> stop_sequence{kDefaultStopSignal};
+    int64_t stop_signal_ = kDefaultStopSignal;
+    int64_t last_claimed_idx = disruptor::kInitialCursorValue;
+    bool started_ = false;
+    std::chrono::nanoseconds timeout_interval{100000}; //check for a stop every 100us without publication
+};
+
+template <class T, std::size_t N, typename C, typename W, class... STAGES>
+constexpr size_t BasicParallel<T, N, C, W, STAGES...>::kStages;
+
+/** BasicParallel with the default claim and wait strategies. */
+template <class T, std::size_t N, class... STAGES>
+using Parallel = BasicParallel<T, N, disruptor::kDefaultClaimStrategyTemplate<N>, disruptor::kDefaultWaitStrategy, STAGES...>;
+}
+#endif
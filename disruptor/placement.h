@@ -0,0 +1,108 @@
+// Copyright (c) 2011-2015, Francois Saint-Jacques
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the disruptor-- nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL FRANCOIS SAINT-JACQUES BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef DISRUPTOR_PLACEMENT_H_  // NOLINT
+#define DISRUPTOR_PLACEMENT_H_  // NOLINT
+
+#include <pthread.h>
+#include <sched.h>
+
+#ifdef __linux__
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <string>
+#include <vector>
+
+namespace disruptor {
+
+// Where and how a consumer thread runs. Every setting is optional, the
+// default placement leaves the thread to the scheduler.
+struct ThreadPlacement {
+  // CPUs the thread may run on, empty for any.
+  std::vector<int> cpus;
+  // Run the thread SCHED_FIFO at this priority when positive.
+  int fifo_priority = 0;
+  // Name shown by ps and top, truncated to 15 characters.
+  std::string name;
+
+  bool empty() const {
+    return cpus.empty() && fifo_priority <= 0 && name.empty();
+  }
+
+  // Apply the placement to the calling thread. Settings are applied
+  // independently, a refused one (e.g. SCHED_FIFO without privileges) does
+  // not prevent the others.
+  //
+  // @return true if every setting was applied.
+  bool Apply() const {
+    bool applied = true;
+#ifdef __linux__
+    const pthread_t self = pthread_self();
+    if (!cpus.empty()) {
+      cpu_set_t set;
+      CPU_ZERO(&set);
+      for (const int cpu : cpus) CPU_SET(cpu, &set);
+      applied &= pthread_setaffinity_np(self, sizeof(set), &set) == 0;
+    }
+    if (fifo_priority > 0) {
+      sched_param param;
+      param.sched_priority = fifo_priority;
+      applied &= pthread_setschedparam(self, SCHED_FIFO, &param) == 0;
+    }
+    if (!name.empty())
+      applied &= pthread_setname_np(self, name.substr(0, 15).c_str()) == 0;
+#else
+    applied = empty();
+#endif
+    return applied;
+  }
+};
+
+// Prefer allocating the pages of a memory region on a NUMA node. It must
+// be called before the pages are first touched.
+//
+// @param region start of the region, page aligned.
+// @param bytes  length of the region.
+// @param node   NUMA node, negative to keep the default first-touch policy.
+// @return true if the policy was set.
+inline bool BindToNumaNode(void* region, size_t bytes, int node) {
+  if (node < 0) return true;
+#if defined(__linux__) && defined(SYS_mbind)
+  const size_t kBitsPerWord = 8 * sizeof(unsigned long);  // NOLINT
+  std::vector<unsigned long> mask(node / kBitsPerWord + 1, 0);  // NOLINT
+  mask[node / kBitsPerWord] = 1UL << (node % kBitsPerWord);
+  return syscall(SYS_mbind, region, bytes, MPOL_PREFERRED, mask.data(),
+                 mask.size() * kBitsPerWord + 1, 0) == 0;
+#else
+  return false;
+#endif
+}
+
+};  // namespace disruptor
+
+#endif  // DISRUPTOR_PLACEMENT_H_ NOLINT
@@ -26,13 +26,70 @@
 #ifndef DISRUPTOR_RING_BUFFER_H_  // NOLINT
 #define DISRUPTOR_RING_BUFFER_H_  // NOLINT
 
+#include <sys/mman.h>
+#include <unistd.h>
+
 #include <array>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include "placement.h"
 #include "utils.h"
 
 namespace disruptor {
 
 constexpr size_t kDefaultRingBufferSize = 1024;
 
+// Size of a ring that is only known at runtime, see RingBuffer<T, 0>.
+constexpr size_t kRuntimeRingBufferSize = 0;
+
+// Size of the huge pages requested with RingBufferOptions::huge_pages.
+constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+
+constexpr bool IsPowerOfTwo(size_t n) { return n > 0 && (n & (n - 1)) == 0; }
+
+// Size of a ring, a compile time constant unless N is kRuntimeRingBufferSize.
+// Claim strategies derive from it so that they work with both kinds of rings.
+template <size_t N>
+class RingSize {
+ public:
+  static_assert(IsPowerOfTwo(N),
+                "RingBuffer's size must be a positive power of 2");
+
+  explicit RingSize(size_t /*size*/ = N) {}
+
+  static constexpr size_t size() { return N; }
+};
+
+template <>
+class RingSize<kRuntimeRingBufferSize> {
+ public:
+  explicit RingSize(size_t size) : size_(size) {
+    if (!IsPowerOfTwo(size))
+      throw std::invalid_argument(
+          "RingBuffer's size must be a positive power of 2");
+  }
+
+  size_t size() const { return size_; }
+
+ private:
+  size_t size_;
+};
+
+// Memory options of a runtime sized RingBuffer.
+struct RingBufferOptions {
+  // Back the ring with MAP_HUGETLB pages, falls back to transparent huge
+  // pages when none are reserved.
+  bool huge_pages = false;
+  // Ask for transparent huge pages with madvise(MADV_HUGEPAGE).
+  bool transparent_huge_pages = false;
+  // Fault in every page at construction rather than on first publication.
+  bool prefault = false;
+  // Prefer the pages of this NUMA node, negative to allocate them on the
+  // node of the thread that first touches them.
+  int numa_node = -1;
+};
+
 // Ring buffer implemented with a fixed array.
 //
 // @param <T> event type
@@ -54,6 +111,12 @@ class RingBuffer {
   static_assert(((N > 0) && ((N & (~N + 1)) == N)),
                 "RingBuffer's size must be a positive power of 2");
 
+  static constexpr size_t size() { return N; }
+
+  // The events are stored inline and placed with their owner, see
+  // RingBuffer<T, kRuntimeRingBufferSize>::Prefault().
+  void Prefault() {}
+
   // Get the event for a given sequence in the RingBuffer.
   //
   // @param sequence for the event
@@ -64,12 +127,124 @@ class RingBuffer {
     return events_[sequence & (N - 1)];
   }
 
+  // Get how many slots are contiguous in memory starting at a sequence.
+  //
+  // @param sequence of the first slot.
+  // @param count of slots requested.
+  // @return count, or fewer if the ring wraps before.
+  size_t ContiguousSlots(const int64_t& sequence, const size_t& count) const {
+    const size_t until_wrap = N - (sequence & (N - 1));
+    return count < until_wrap ? count : until_wrap;
+  }
+
  private:
   std::array<T, N> events_;
 
   DISALLOW_COPY_MOVE_AND_ASSIGN(RingBuffer);
 };
 
+// Ring buffer with a size chosen at runtime, allocated in its own mapping
+// rather than inline so that large rings can use huge pages.
+//
+// @param <T> event type
+template <typename T>
+class RingBuffer<T, kRuntimeRingBufferSize> {
+ public:
+  // Construct a RingBuffer of default constructed events.
+  //
+  // @param size of the RingBuffer, must be a power of 2.
+  // @param options for the memory backing the RingBuffer.
+  explicit RingBuffer(size_t size,
+                      const RingBufferOptions& options = RingBufferOptions())
+      : mask_(RingSize<kRuntimeRingBufferSize>(size).size() - 1),
+        mapped_size_(0),
+        events_(nullptr) {
+    events_ = static_cast<T*>(Map(size * sizeof(T), options));
+    BindToNumaNode(events_, mapped_size_, options.numa_node);
+    if (options.prefault) Prefault();
+    // anonymous mappings are zero filled, which already is the value of a
+    // trivial event.
+    if (!std::is_trivially_default_constructible<T>::value) {
+      for (size_t i = 0; i < size; ++i) new (events_ + i) T();
+    }
+  }
+
+  ~RingBuffer() {
+    if (!std::is_trivially_destructible<T>::value) {
+      for (size_t i = 0; i <= mask_; ++i) events_[i].~T();
+    }
+    munmap(events_, mapped_size_);
+  }
+
+  size_t size() const { return mask_ + 1; }
+
+  // Fault in every page of the ring without altering its events, so that
+  // they are allocated on the NUMA node of the calling thread unless the
+  // ring is bound to a node. Pages touched earlier keep their placement.
+  void Prefault() {
+#ifdef MADV_POPULATE_WRITE
+    if (madvise(events_, mapped_size_, MADV_POPULATE_WRITE) == 0) return;
+#endif
+    const size_t page = sysconf(_SC_PAGESIZE);
+    char* region = reinterpret_cast<char*>(events_);
+    for (size_t offset = 0; offset < mapped_size_; offset += page)
+      __atomic_fetch_or(region + offset, 0, __ATOMIC_RELAXED);
+  }
+
+  // Get the event for a given sequence in the RingBuffer.
+  //
+  // @param sequence for the event
+  // @return event reference at the specified sequence position.
+  T& operator[](const int64_t& sequence) { return events_[sequence & mask_]; }
+
+  const T& operator[](const int64_t& sequence) const {
+    return events_[sequence & mask_];
+  }
+
+  // See RingBuffer<T, N>::ContiguousSlots().
+  size_t ContiguousSlots(const int64_t& sequence, const size_t& count) const {
+    const size_t until_wrap = size() - (sequence & mask_);
+    return count < until_wrap ? count : until_wrap;
+  }
+
+ private:
+  void* Map(size_t bytes, const RingBufferOptions& options) {
+    const int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+    void* region = MAP_FAILED;
+#ifdef MAP_HUGETLB
+    if (options.huge_pages) {
+      mapped_size_ = RoundUp(bytes, kHugePageSize);
+      region = mmap(nullptr, mapped_size_, PROT_READ | PROT_WRITE,
+                    flags | MAP_HUGETLB, -1, 0);
+    }
+#endif
+    const bool transparent =
+        options.transparent_huge_pages || options.huge_pages;
+    if (region == MAP_FAILED) {
+      // huge page alignment lets the kernel back the whole ring with them.
+      mapped_size_ = RoundUp(bytes, transparent ? kHugePageSize
+                                                : sysconf(_SC_PAGESIZE));
+      region =
+          mmap(nullptr, mapped_size_, PROT_READ | PROT_WRITE, flags, -1, 0);
+      if (region == MAP_FAILED) throw std::bad_alloc();
+#ifdef MADV_HUGEPAGE
+      if (transparent) madvise(region, mapped_size_, MADV_HUGEPAGE);
+#endif
+    }
+    return region;
+  }
+
+  static size_t RoundUp(size_t bytes, size_t alignment) {
+    return (bytes + alignment - 1) / alignment * alignment;
+  }
+
+  size_t mask_;
+  size_t mapped_size_;
+  T* events_;
+
+  DISALLOW_COPY_MOVE_AND_ASSIGN(RingBuffer);
+};
+
 };  // namespace disruptor
 
 #endif  // DISRUPTOR_RING_BUFFER_H_ NOLINT
@@ -34,6 +34,8 @@
 #define DISRUPTOR_SEQUENCE_H_  // NOLINT
 
 #include <atomic>
+#include <climits>
+#include <vector>
 
 #include "utils.h"
 
@@ -45,6 +47,7 @@ constexpr int64_t kAlertedSignal = -2L;
 constexpr int64_t kTimeoutSignal = -3L;
 constexpr int64_t kDefaultStopSignal = -4L;
 constexpr int64_t kStopImmediatelySignal = -5L; //signal immediate stop
+constexpr int64_t kInsufficientCapacitySignal = -6L; //ring is full, see TryClaim
 constexpr int64_t kFirstSequenceValue = kInitialCursorValue + 1L;
 bool isReservedSignal(int64_t signal) { return signal < kInitialCursorValue; }
 // Sequence counter.
@@ -60,14 +63,14 @@ class Sequence {
   //
   // @return the current value.
   int64_t sequence() const {
-    return sequence_.load(std::memory_order::memory_order_acquire);
+    return sequence_.load(std::memory_order_acquire);
   }
 
   // Set the current value of the {@link Sequence}.
   //
   // @param the value to which the {@link Sequence} will be set.
   void set_sequence(int64_t value) {
-    sequence_.store(value, std::memory_order::memory_order_release);
+    sequence_.store(value, std::memory_order_release);
   }
 
   // Increment and return the value of the {@link Sequence}.
@@ -76,10 +79,21 @@ class Sequence {
   // @return the new value incremented.
   int64_t IncrementAndGet(const int64_t& increment) {
     return sequence_.fetch_add(increment,
-                               std::memory_order::memory_order_release) +
+                               std::memory_order_release) +
            increment;
   }
 
+  // Atomically set the value of the {@link Sequence} if it currently holds
+  // the expected value.
+  //
+  // @param expected value the {@link Sequence} must hold.
+  // @param value to which the {@link Sequence} will be set.
+  // @return true if the value was set.
+  bool CompareAndSet(int64_t expected, int64_t value) {
+    return sequence_.compare_exchange_strong(
+        expected, value, std::memory_order_acq_rel);
+  }
+
  private:
   // padding
   int64_t padding0_[ATOMIC_SEQUENCE_PADDING_LENGTH];
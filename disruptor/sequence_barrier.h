@@ -37,36 +37,120 @@ namespace disruptor {
 template <typename W = kDefaultWaitStrategy>
 class SequenceBarrier {
  public:
+  // Construct a barrier with its own wait strategy instance, it can only be
+  // used with strategies that do not rely on SignalAllWhenBlocking().
   SequenceBarrier(const Sequence& cursor,
                   const std::vector<Sequence*>& dependents)
-      : cursor_(cursor), dependents_(dependents), alerted_(false) {}
+      : owned_wait_strategy_(new W()),
+        wait_strategy_(*owned_wait_strategy_),
+        cursor_(cursor),
+        dependents_(dependents),
+        alerted_(false),
+        cursor_view_(cursor, dependents),
+        single_view_(cursor, dependents),
+        multi_view_(cursor, dependents) {}
+
+  // Construct a barrier waiting through the sequencer's wait strategy, so
+  // that its signals reach the barrier.
+  SequenceBarrier(W& wait_strategy, const Sequence& cursor,
+                  const std::vector<Sequence*>& dependents)
+      : wait_strategy_(wait_strategy),
+        cursor_(cursor),
+        dependents_(dependents),
+        alerted_(false),
+        cursor_view_(cursor, dependents),
+        single_view_(cursor, dependents),
+        multi_view_(cursor, dependents) {}
 
   int64_t WaitFor(const int64_t& sequence) {
-    return wait_strategy_.WaitFor(sequence, cursor_, dependents_, alerted_);
+    switch (dependents_.size()) {
+      case 0:
+        return wait_strategy_.WaitFor(sequence, cursor_view_, alerted_);
+      case 1:
+        return wait_strategy_.WaitFor(sequence, single_view_, alerted_);
+      default:
+        return wait_strategy_.WaitFor(sequence, multi_view_, alerted_);
+    }
   }
 
   template <class R, class P>
   int64_t WaitFor(const int64_t& sequence,
                   const std::chrono::duration<R, P>& timeout) {
-    return wait_strategy_.WaitFor(sequence, cursor_, dependents_, alerted_,
-                                  timeout);
+    switch (dependents_.size()) {
+      case 0:
+        return wait_strategy_.WaitFor(sequence, cursor_view_, alerted_,
+                                      timeout);
+      case 1:
+        return wait_strategy_.WaitFor(sequence, single_view_, alerted_,
+                                      timeout);
+      default:
+        return wait_strategy_.WaitFor(sequence, multi_view_, alerted_,
+                                      timeout);
+    }
+  }
+
+  // Get the greatest available sequence without waiting.
+  //
+  // @param sequence to wait for.
+  // @return kAlertedSignal if the barrier signaled an alert, otherwise the
+  //         greatest available sequence which may be lower than requested.
+  int64_t TryWaitFor(const int64_t& sequence) {
+    if (alerted()) return kAlertedSignal;
+
+    switch (dependents_.size()) {
+      case 0:
+        return cursor_view_.Get(sequence);
+      case 1:
+        return single_view_.Get(sequence);
+      default:
+        return multi_view_.Get(sequence);
+    }
+  }
+
+  // Get a file descriptor to poll for new sequences, only available with
+  // wait strategies supporting it such as EventFdStrategy.
+  //
+  // @return the file descriptor, or -1 if it could not be created.
+  int wait_fd() {
+    if (wait_subscription_ < 0)
+      wait_subscription_ = wait_strategy_.Subscribe();
+    return wait_subscription_ < 0 ? -1
+                                  : wait_strategy_.wait_fd(wait_subscription_);
+  }
+
+  // Reset wait_fd() so that it becomes readable on the next publication.
+  //
+  // @param sequence to wait for.
+  // @return same as TryWaitFor(), the caller may only poll wait_fd() when
+  //         it is lower than requested.
+  int64_t ArmWaitFd(const int64_t& sequence) {
+    if (wait_fd() >= 0) wait_strategy_.Arm(wait_subscription_);
+    return TryWaitFor(sequence);
   }
 
   int64_t get_sequence() const { return cursor_.sequence(); }
 
   bool alerted() const {
-    return alerted_.load(std::memory_order::memory_order_acquire);
+    return alerted_.load(std::memory_order_acquire);
   }
 
   void set_alerted(bool alert) {
-    alerted_.store(alert, std::memory_order::memory_order_release);
+    alerted_.store(alert, std::memory_order_release);
   }
 
  private:
-  W wait_strategy_;
+  std::unique_ptr<W> owned_wait_strategy_;
+  W& wait_strategy_;
   const Sequence& cursor_;
   std::vector<Sequence*> dependents_;
   std::atomic<bool> alerted_;
+  int wait_subscription_ = -1;
+
+  // the dependency shape is fixed at construction, only the matching view
+  // is ever used.
+  CursorGatingView cursor_view_;
+  SingleGatingView single_view_;
+  MultiGatingView multi_view_;
 };
 
 };  // namespace disruptor
@@ -26,12 +26,62 @@
 #ifndef DISRUPTOR_SEQUENCER_H_  // NOLINT
 #define DISRUPTOR_SEQUENCER_H_  // NOLINT
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+
 #include "claim_strategy.h"
 #include "wait_strategy.h"
 #include "sequence_barrier.h"
 
 namespace disruptor {
 
+// Batch of sequences claimed at once, see Sequencer::ClaimRange(). Its slots
+// map to at most two contiguous spans of the ring: the head, and the tail
+// starting at the beginning of the ring when the batch wraps.
+template <typename T>
+class SequenceRange {
+ public:
+  // Empty range, returned when a claim fails.
+  SequenceRange()
+      : first_(kFirstSequenceValue),
+        last_(kInitialCursorValue),
+        head_(nullptr),
+        head_size_(0),
+        tail_(nullptr) {}
+
+  SequenceRange(int64_t first, int64_t last, T* head, size_t head_size,
+                T* tail)
+      : first_(first),
+        last_(last),
+        head_(head),
+        head_size_(head_size),
+        tail_(tail) {}
+
+  int64_t first() const { return first_; }
+  int64_t last() const { return last_; }
+  size_t size() const { return last_ - first_ + 1; }
+  bool empty() const { return last_ < first_; }
+
+  T* head() const { return head_; }
+  size_t head_size() const { return head_size_; }
+  T* tail() const { return tail_; }
+  size_t tail_size() const { return size() - head_size_; }
+
+  // Get the event at a position in the range.
+  T& operator[](const size_t& index) const {
+    return index < head_size_ ? head_[index] : tail_[index - head_size_];
+  }
+
+ private:
+  int64_t first_;
+  int64_t last_;
+  T* head_;
+  size_t head_size_;
+  T* tail_;
+};
+
 // Coordinator for claiming sequences for access to a data structures while
 // tracking dependent {@link Sequence}s
 template <typename T, size_t N = kDefaultRingBufferSize,
@@ -45,12 +95,60 @@ class Sequencer {
   // Construct a Sequencer with the selected strategies.
   Sequencer(std::array<T, N> events) : ring_buffer_(events) {}
 
+  // Construct a Sequencer whose ring is sized at runtime, N must be
+  // kRuntimeRingBufferSize.
+  //
+  // @param size of the ring, must be a power of 2.
+  // @param options for the memory backing the ring.
+  explicit Sequencer(size_t size,
+                     const RingBufferOptions& options = RingBufferOptions())
+      : ring_buffer_(size, options), claim_strategy_(size) {
+    static_assert(N == kRuntimeRingBufferSize,
+                  "only runtime sized Sequencers take a size");
+  }
+
+  // Get the number of slots of the ring.
+  size_t size() const { return ring_buffer_.size(); }
+
+  // Fault in the pages of the ring from the calling thread, see
+  // RingBuffer::Prefault().
+  void Prefault() { ring_buffer_.Prefault(); }
+
   // Set the sequences that will gate publishers to prevent the buffer
-  // wrapping.
+  // wrapping. Safe while publishers run: they switch to the new set on
+  // their next claim without taking a lock.
   //
   // @param sequences to be gated on.
   void set_gating_sequences(const std::vector<Sequence*>& sequences) {
-    gating_sequences_ = sequences;
+    std::lock_guard<std::mutex> lock(gating_mutex_);
+    SwapGatingSequences(sequences);
+  }
+
+  // Add a gating sequence while publishers run. Set the sequence to
+  // GetCursor() before the call, then to GetCursor() read again after it,
+  // and only consume past that second value: a publisher may claim against
+  // the previous set until the call returns, see Claim().
+  //
+  // @param sequence to be gated on.
+  void AddGatingSequence(Sequence* sequence) {
+    std::lock_guard<std::mutex> lock(gating_mutex_);
+    std::vector<Sequence*> sequences(*gating_sequences_.load());
+    sequences.push_back(sequence);
+    SwapGatingSequences(sequences);
+  }
+
+  // Stop gating on a sequence while publishers run.
+  //
+  // @param sequence not to be gated on anymore.
+  // @return false if the sequence was not gating.
+  bool RemoveGatingSequence(Sequence* sequence) {
+    std::lock_guard<std::mutex> lock(gating_mutex_);
+    std::vector<Sequence*> sequences(*gating_sequences_.load());
+    auto it = std::find(sequences.begin(), sequences.end(), sequence);
+    if (it == sequences.end()) return false;
+    sequences.erase(it);
+    SwapGatingSequences(sequences);
+    return true;
   }
 
   // Create a {@link SequenceBarrier} that gates on the cursor and a list of
@@ -59,13 +157,13 @@ class Sequencer {
   // @param sequences_to_track this barrier will track.
   // @return the barrier gated as required.
   SequenceBarrier<W>* NewBarrier(const std::vector<Sequence*>& dependents) {
-    return new SequenceBarrier<W>(cursor_, dependents);
+    return new SequenceBarrier<W>(wait_strategy_, cursor_, dependents);
   }
 
   // Get the value of the cursor indicating the published sequence.
   //
   // @return value of the cursor for events that have been published.
-  int64_t GetCursor() { return cursor_.sequence(); }
+  int64_t GetCursor() const { return cursor_.sequence(); }
 
   // Has the buffer capacity left to allocate another sequence. This is a
   // concurrent method so the response should only be taken as an indication
@@ -73,7 +171,8 @@ class Sequencer {
   //
   // @return true if the buffer has the capacity to allocated another event.
   bool HasAvailableCapacity() {
-    return claim_strategy_.HasAvailableCapacity(gating_sequences_);
+    PublisherScope scope(this);
+    return claim_strategy_.HasAvailableCapacity(GatingSequences());
   }
 
   // Claim the next batch of sequence numbers for publishing.
@@ -81,22 +180,162 @@ class Sequencer {
   // @param delta  the requested number of sequences.
   // @return the maximal claimed sequence
   int64_t Claim(size_t delta = 1) {
-    return claim_strategy_.IncrementAndGet(gating_sequences_, delta);
+    PublisherScope scope(this);
+    const std::vector<Sequence*>* gating =
+        gating_sequences_.load(std::memory_order_seq_cst);
+    return Regate(gating, claim_strategy_.IncrementAndGet(*gating, delta));
+  }
+
+  // Claim a batch of sequences and get the ring slots backing it.
+  //
+  // @param delta  the requested number of sequences, between 1 and the size
+  //               of the ring.
+  // @return the claimed range.
+  SequenceRange<T> ClaimRange(size_t delta) {
+    return RangeOf(Claim(delta), delta);
+  }
+
+  // Claim the next batch of sequence numbers only if the ring has room for
+  // it right now. The check and the claim are atomic, unlike a call to
+  // HasAvailableCapacity() followed by Claim().
+  //
+  // @param delta  the requested number of sequences.
+  // @return the maximal claimed sequence, or kInsufficientCapacitySignal if
+  //         nothing was claimed.
+  int64_t TryClaim(size_t delta = 1) {
+    PublisherScope scope(this);
+    const std::vector<Sequence*>* gating =
+        gating_sequences_.load(std::memory_order_seq_cst);
+    const int64_t sequence = claim_strategy_.TryIncrementAndGet(*gating, delta);
+    if (sequence == kInsufficientCapacitySignal) return sequence;
+    return Regate(gating, sequence);
+  }
+
+  // Claim a batch of sequences only if the ring has room for it right now.
+  //
+  // @param delta  the requested number of sequences, between 1 and the size
+  //               of the ring.
+  // @return the claimed range, empty if nothing was claimed.
+  SequenceRange<T> TryClaimRange(size_t delta) {
+    const int64_t last = TryClaim(delta);
+    if (last == kInsufficientCapacitySignal) return SequenceRange<T>();
+    return RangeOf(last, delta);
+  }
+
+  // Publish a claimed range with a single cursor update and signal.
+  //
+  // @param range to be published.
+  void Publish(const SequenceRange<T>& range) {
+    Publish(range.last(), range.size());
   }
 
   // Publish an event and make it visible to {@link EventProcessor}s.
   //
   // @param sequence to be published.
   void Publish(const int64_t& sequence, size_t delta = 1) {
-    claim_strategy_.SynchronizePublishing(sequence, cursor_, delta);
-    //const int64_t new_cursor = 
-    cursor_.IncrementAndGet(delta);
+    claim_strategy_.Publish(sequence, cursor_, delta);
     wait_strategy_.SignalAllWhenBlocking();
   }
 
   T& operator[](const int64_t& sequence) { return ring_buffer_[sequence]; }
 
+  // Whether a gating set replaced since is still to be freed, i.e. a
+  // publisher may still read a sequence no longer gating. A sequence removed
+  // by RemoveGatingSequence() can be freed once this is false.
+  bool HasRetiredGatingSequences() {
+    std::lock_guard<std::mutex> lock(gating_mutex_);
+    ReclaimGatingSequences();
+    return !retired_gating_sequences_.empty();
+  }
+
+  // Claims that stalled on a full ring, empty unless DISRUPTOR_METRICS is
+  // defined.
+  ClaimMetricsSnapshot claim_metrics() const {
+    return claim_strategy_.metrics().Snapshot();
+  }
+
  private:
+  // Counts a publisher reading the gating sets, from before it loads a set
+  // until it is done with it, see ReclaimGatingSequences(). Sets are loaded
+  // seq_cst after the count, a plain load on x86.
+  class PublisherScope {
+   public:
+    explicit PublisherScope(Sequencer* sequencer) : sequencer_(sequencer) {
+      sequencer_->publishers_.fetch_add(1, std::memory_order_seq_cst);
+    }
+    ~PublisherScope() {
+      if (sequencer_->publishers_.fetch_sub(1, std::memory_order_seq_cst) !=
+              1 ||
+          !sequencer_->has_retired_gating_sequences_.load(
+              std::memory_order_seq_cst))
+        return;
+      std::unique_lock<std::mutex> lock(sequencer_->gating_mutex_,
+                                        std::try_to_lock);
+      if (lock.owns_lock()) sequencer_->ReclaimGatingSequences();
+    }
+
+   private:
+    Sequencer* sequencer_;
+  };
+
+  const std::vector<Sequence*>& GatingSequences() const {
+    return *gating_sequences_.load(std::memory_order_seq_cst);
+  }
+
+  // A claim made against a gating set swapped since must not wrap over the
+  // sequences of the new set either, e.g. one added at a cursor the claim
+  // was already past. Sets rarely change, so this mostly costs a load.
+  //
+  // @param gating   set the claim was made against.
+  // @param sequence last claimed sequence.
+  // @return sequence, once no sequence of the current set is wrapped over.
+  int64_t Regate(const std::vector<Sequence*>* gating,
+                 const int64_t& sequence) {
+    const std::vector<Sequence*>* current;
+    while ((current = gating_sequences_.load(std::memory_order_seq_cst)) !=
+           gating) {
+      const int64_t wrap_point = sequence - static_cast<int64_t>(size());
+      while (GetMinimumSequence(*current) < wrap_point &&
+             gating_sequences_.load(std::memory_order_acquire) == current) {
+        std::this_thread::yield();
+      }
+      gating = current;
+    }
+    return sequence;
+  }
+
+  // Publish a new gating set, RCU style: a publisher may still be reading
+  // the previous sets, they are retired until no publisher is counted.
+  // Called with gating_mutex_ held.
+  void SwapGatingSequences(const std::vector<Sequence*>& sequences) {
+    std::unique_ptr<const std::vector<Sequence*> > next(
+        new std::vector<Sequence*>(sequences));
+    gating_sequences_.store(next.get(), std::memory_order_seq_cst);
+    if (current_gating_sequences_)
+      retired_gating_sequences_.push_back(
+          std::move(current_gating_sequences_));
+    current_gating_sequences_ = std::move(next);
+    has_retired_gating_sequences_.store(true, std::memory_order_seq_cst);
+    ReclaimGatingSequences();
+  }
+
+  // Free the retired gating sets when no publisher is counted: a publisher
+  // counted later loads the current set. Called with gating_mutex_ held.
+  void ReclaimGatingSequences() {
+    if (retired_gating_sequences_.empty() ||
+        publishers_.load(std::memory_order_seq_cst) != 0)
+      return;
+    retired_gating_sequences_.clear();
+    has_retired_gating_sequences_.store(false, std::memory_order_relaxed);
+  }
+
+  SequenceRange<T> RangeOf(const int64_t& last, const size_t& delta) {
+    const int64_t first = last - delta + 1;
+    const size_t head_size = ring_buffer_.ContiguousSlots(first, delta);
+    return SequenceRange<T>(first, last, &ring_buffer_[first], head_size,
+                            &ring_buffer_[first + head_size]);
+  }
+
   // Members
   RingBuffer<T, N> ring_buffer_;
 
@@ -106,7 +345,22 @@ class Sequencer {
 
   W wait_strategy_;
 
-  std::vector<Sequence*> gating_sequences_;
+  std::vector<Sequence*> no_gating_sequences_;
+
+  std::atomic<const std::vector<Sequence*>*> gating_sequences_{
+      &no_gating_sequences_};
+
+  std::unique_ptr<const std::vector<Sequence*> > current_gating_sequences_;
+
+  std::vector<std::unique_ptr<const std::vector<Sequence*> > >
+      retired_gating_sequences_;
+
+  std::atomic<bool> has_retired_gating_sequences_{false};
+
+  // publishers reading the gating sets, see PublisherScope.
+  std::atomic<uint32_t> publishers_{0};
+
+  std::mutex gating_mutex_;
 
   DISALLOW_COPY_MOVE_AND_ASSIGN(Sequencer);
 };
@@ -0,0 +1,453 @@
+// Copyright (c) 2011-2015, Francois Saint-Jacques
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the disruptor-- nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL FRANCOIS SAINT-JACQUES BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef DISRUPTOR_SHARED_SEQUENCER_H_  // NOLINT
+#define DISRUPTOR_SHARED_SEQUENCER_H_  // NOLINT
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "claim_strategy.h"
+#include "ring_buffer.h"
+#include "sequence.h"
+#include "sequence_barrier.h"
+#include "wait_strategy.h"
+
+namespace disruptor {
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2,
+              "shared rings need address free, lock free sequences");
+
+constexpr uint64_t kSharedRingMagic = 0x5254505552534944ULL;  // "DISRUPTR"
+constexpr uint32_t kSharedRingVersion = 2;
+constexpr size_t kMaxSharedConsumers = 16;
+
+// Layout at the start of a shared ring region, followed by the claim
+// strategy and then the slots, each at a cache line aligned offset. Processes
+// only attach to a region whose header matches their own layout.
+struct SharedRingHeader {
+  uint64_t magic;
+  uint32_t version;
+  uint32_t header_size;
+  uint64_t size;
+  uint64_t slot_size;
+  uint64_t claim_strategy_size;
+  uint64_t claim_strategy_offset;
+  uint64_t slots_offset;
+  // set once the creator is done initializing the region.
+  std::atomic<uint32_t> ready;
+  // bumped whenever a consumer is added or removed.
+  std::atomic<uint32_t> consumers_epoch;
+  Sequence cursor;
+  std::atomic<uint32_t> consumer_used[kMaxSharedConsumers];
+  // process that added each consumer, see ReclaimConsumers().
+  std::atomic<int32_t> consumer_pid[kMaxSharedConsumers];
+  Sequence consumers[kMaxSharedConsumers];
+};
+
+// Sequencer whose ring, cursor and gating sequences live in a shared memory
+// region, so that producers and consumers can run in different processes.
+//
+// One process creates the region, the others attach to it by name. The
+// claim strategy state is kept in the region too, C must therefore be a
+// strategy without pointers such as MultiThreadedStrategy (any number of
+// producers, in any number of threads of each process sharing an object or
+// not) or SingleThreadedStrategy (one producer at a time), and the
+// events must be trivially copyable. Wait strategies are local to each
+// process, only the ones that do not rely on SignalAllWhenBlocking() make
+// sense, e.g. BusySpinStrategy, YieldingStrategy or SleepingStrategy.
+//
+// @param <T> event type
+// @param <C> claim strategy, sized at runtime
+// @param <W> wait strategy of the consumers' barriers
+template <typename T,
+          typename C = MultiThreadedStrategy<kRuntimeRingBufferSize>,
+          typename W = kDefaultWaitStrategy>
+class SharedSequencer {
+ public:
+  static_assert(std::is_trivially_copyable<T>::value &&
+                    !std::is_pointer<T>::value,
+                "shared events must be trivially copyable, without pointers");
+
+  // Create a shared ring, replacing any ring of the same name: the name is
+  // unlinked first, processes still attached to the previous ring keep it
+  // until they detach.
+  //
+  // @param name    shm_open() name such as "/market-data", or the path of a
+  //                file, e.g. on a hugetlbfs mount.
+  // @param size    of the ring, must be a power of 2.
+  // @param options huge_pages rounds the region to kHugePageSize as
+  //                hugetlbfs requires, prefault and numa_node apply as for
+  //                a RingBuffer.
+  SharedSequencer(const std::string& name, size_t size,
+                  const RingBufferOptions& options = RingBufferOptions()) {
+    RingSize<kRuntimeRingBufferSize> checked_size(size);
+    const size_t claim_strategy_offset = Align(sizeof(SharedRingHeader));
+    const size_t slots_offset = Align(claim_strategy_offset + sizeof(C));
+    mapped_size_ = slots_offset + size * sizeof(T);
+    mapped_size_ = RoundUp(mapped_size_, options.huge_pages
+                                             ? kHugePageSize
+                                             : sysconf(_SC_PAGESIZE));
+
+    Unlink(name);
+    const int fd = Open(name, O_RDWR | O_CREAT | O_EXCL);
+    if (ftruncate(fd, mapped_size_) != 0) {
+      const int error = errno;
+      close(fd);
+      throw std::system_error(error, std::generic_category(), "ftruncate");
+    }
+    Map(fd, options.prefault);
+    BindToNumaNode(region_, mapped_size_, options.numa_node);
+    if (options.prefault) Prefault();
+
+    header_ = new (region_) SharedRingHeader();
+    header_->ready.store(0);
+    header_->magic = kSharedRingMagic;
+    header_->version = kSharedRingVersion;
+    header_->header_size = sizeof(SharedRingHeader);
+    header_->size = checked_size.size();
+    header_->slot_size = sizeof(T);
+    header_->claim_strategy_size = sizeof(C);
+    header_->claim_strategy_offset = claim_strategy_offset;
+    header_->slots_offset = slots_offset;
+    header_->consumers_epoch.store(0);
+    for (auto& used : header_->consumer_used) used.store(0);
+    claim_strategy_ = new (Offset(claim_strategy_offset)) C(size);
+    events_ = static_cast<T*>(Offset(slots_offset));
+    header_->ready.store(1, std::memory_order_release);
+  }
+
+  // Attach to a ring created by another process.
+  //
+  // @param name the ring was created with.
+  explicit SharedSequencer(const std::string& name) {
+    const int fd = Open(name, O_RDWR);
+    struct stat status;
+    if (fstat(fd, &status) != 0 ||
+        static_cast<size_t>(status.st_size) < sizeof(SharedRingHeader)) {
+      close(fd);
+      throw std::runtime_error("shared ring " + name + " is not initialized");
+    }
+    mapped_size_ = status.st_size;
+    Map(fd, false);
+
+    header_ = static_cast<SharedRingHeader*>(region_);
+    const char* mismatch = nullptr;
+    if (header_->magic != kSharedRingMagic)
+      mismatch = "is not a shared ring";
+    else if (header_->version != kSharedRingVersion ||
+             header_->header_size != sizeof(SharedRingHeader))
+      mismatch = "has an unsupported version";
+    else if (header_->ready.load(std::memory_order_acquire) == 0)
+      mismatch = "is not initialized";
+    else if (header_->slot_size != sizeof(T) ||
+             header_->claim_strategy_size != sizeof(C) ||
+             header_->slots_offset + header_->size * sizeof(T) > mapped_size_)
+      mismatch = "was created for other event or strategy types";
+    if (mismatch) {
+      munmap(region_, mapped_size_);
+      throw std::runtime_error("shared ring " + name + " " + mismatch);
+    }
+    claim_strategy_ = static_cast<C*>(Offset(header_->claim_strategy_offset));
+    events_ = static_cast<T*>(Offset(header_->slots_offset));
+  }
+
+  // Unmap the region, the ring lives on until Unlink() and every process
+  // has detached.
+  ~SharedSequencer() { munmap(region_, mapped_size_); }
+
+  // Remove the name of a shared ring.
+  //
+  // @param name the ring was created with.
+  // @return true if the name was removed.
+  static bool Unlink(const std::string& name) {
+    return (IsShmName(name) ? shm_unlink(name.c_str())
+                            : unlink(name.c_str())) == 0;
+  }
+
+  size_t size() const { return header_->size; }
+
+  // Get the value of the cursor indicating the published sequence.
+  int64_t GetCursor() const { return header_->cursor.sequence(); }
+
+  // Register a consumer gating the producers. It must start after the value
+  // of its sequence when returned: a cursor read once it gates, as claims
+  // made against the previous consumers may be past an earlier cursor.
+  //
+  // @return the consumer's sequence to advance, or nullptr if
+  //         kMaxSharedConsumers are already registered.
+  Sequence* AddConsumer() {
+    for (size_t i = 0; i < kMaxSharedConsumers; ++i) {
+      uint32_t unused = 0;
+      if (header_->consumer_used[i].compare_exchange_strong(unused, 1)) {
+        header_->consumer_pid[i].store(getpid());
+        header_->consumers[i].set_sequence(GetCursor());
+        header_->consumer_used[i].store(2);
+        header_->consumers_epoch.fetch_add(1);
+        header_->consumers[i].set_sequence(GetCursor());
+        return &header_->consumers[i];
+      }
+    }
+    return nullptr;
+  }
+
+  // Stop gating the producers on a consumer.
+  //
+  // @param consumer returned by AddConsumer().
+  void RemoveConsumer(Sequence* consumer) {
+    const size_t i = consumer - header_->consumers;
+    if (i >= kMaxSharedConsumers) return;
+    // a claim may still wait on the consumer through a previous gating set.
+    consumer->set_sequence(std::numeric_limits<int64_t>::max());
+    header_->consumer_used[i].store(0);
+    header_->consumers_epoch.fetch_add(1);
+  }
+
+  // Remove the consumers of processes that exited without calling
+  // RemoveConsumer(), e.g. that crashed: they would gate the producers
+  // forever. Call it from any attached process, e.g. when producers stall or
+  // before restarting a consumer. A consumer whose pid was reused by another
+  // process is not reclaimed until that process exits.
+  //
+  // @return the number of consumers removed.
+  size_t ReclaimConsumers() {
+    size_t reclaimed = 0;
+    for (size_t i = 0; i < kMaxSharedConsumers; ++i) {
+      if (header_->consumer_used[i].load() != 2) continue;
+      const pid_t pid = header_->consumer_pid[i].load();
+      if (kill(pid, 0) == 0 || errno != ESRCH) continue;
+      uint32_t used = 2;
+      if (!header_->consumer_used[i].compare_exchange_strong(used, 1))
+        continue;
+      // only this call may remove the consumer now, see RemoveConsumer().
+      RemoveConsumer(&header_->consumers[i]);
+      ++reclaimed;
+    }
+    return reclaimed;
+  }
+
+  // Create a barrier on the shared cursor for a consumer of this process.
+  //
+  // @param dependents sequences to wait on, e.g. other consumers.
+  // @return the barrier, owned by the caller.
+  SequenceBarrier<W>* NewBarrier(
+      const std::vector<Sequence*>& dependents = {}) {
+    return new SequenceBarrier<W>(header_->cursor, dependents);
+  }
+
+  bool HasAvailableCapacity() {
+    PublisherScope scope(this);
+    return claim_strategy_->HasAvailableCapacity(
+        Gating(header_->consumers_epoch.load())->sequences);
+  }
+
+  // See Sequencer::Claim().
+  int64_t Claim(size_t delta = 1) {
+    PublisherScope scope(this);
+    const GatingSet* gating = Gating(header_->consumers_epoch.load());
+    return Regate(gating,
+                  claim_strategy_->IncrementAndGet(gating->sequences, delta));
+  }
+
+  // See Sequencer::TryClaim().
+  int64_t TryClaim(size_t delta = 1) {
+    PublisherScope scope(this);
+    const GatingSet* gating = Gating(header_->consumers_epoch.load());
+    const int64_t sequence =
+        claim_strategy_->TryIncrementAndGet(gating->sequences, delta);
+    if (sequence == kInsufficientCapacitySignal) return sequence;
+    return Regate(gating, sequence);
+  }
+
+  // Publish claimed sequences to every attached process.
+  //
+  // @param sequence last claimed sequence to publish.
+  // @param delta number of sequences claimed.
+  void Publish(const int64_t& sequence, size_t delta = 1) {
+    claim_strategy_->Publish(sequence, header_->cursor, delta);
+  }
+
+  T& operator[](const int64_t& sequence) {
+    return events_[sequence & (header_->size - 1)];
+  }
+
+ private:
+  // Consumers registered as of an epoch of the consumers.
+  struct GatingSet {
+    uint32_t epoch;
+    std::vector<Sequence*> sequences;
+  };
+
+  // Counts a producer thread of this process reading the gating sets, see
+  // Sequencer::PublisherScope.
+  class PublisherScope {
+   public:
+    explicit PublisherScope(SharedSequencer* sequencer)
+        : sequencer_(sequencer) {
+      sequencer_->publishers_.fetch_add(1, std::memory_order_seq_cst);
+    }
+    ~PublisherScope() {
+      if (sequencer_->publishers_.fetch_sub(1, std::memory_order_seq_cst) !=
+              1 ||
+          !sequencer_->has_retired_gating_.load(std::memory_order_seq_cst))
+        return;
+      std::unique_lock<std::mutex> lock(sequencer_->gating_mutex_,
+                                        std::try_to_lock);
+      if (lock.owns_lock()) sequencer_->ReclaimGating();
+    }
+
+   private:
+    SharedSequencer* sequencer_;
+  };
+
+  // Consumers are registered by any process, a gating set is built whenever
+  // the epoch changes. Like Sequencer's gating sets, sets are swapped RCU
+  // style, the producer threads of this process may still be reading the
+  // previous ones, which are retired until no producer thread is counted.
+  //
+  // @param epoch of the consumers read before the claim.
+  const GatingSet* Gating(uint32_t epoch) {
+    const GatingSet* gating = gating_.load(std::memory_order_seq_cst);
+    if (gating != nullptr && gating->epoch == epoch) return gating;
+    std::lock_guard<std::mutex> lock(gating_mutex_);
+    gating = gating_.load(std::memory_order_relaxed);
+    if (gating != nullptr && gating->epoch == epoch) return gating;
+    std::unique_ptr<GatingSet> next(new GatingSet{epoch, {}});
+    for (size_t i = 0; i < kMaxSharedConsumers; ++i) {
+      if (header_->consumer_used[i].load() == 2)
+        next->sequences.push_back(&header_->consumers[i]);
+    }
+    gating = next.get();
+    gating_.store(gating, std::memory_order_seq_cst);
+    if (current_gating_) retired_gating_.push_back(std::move(current_gating_));
+    current_gating_ = std::move(next);
+    has_retired_gating_.store(true, std::memory_order_seq_cst);
+    return gating;
+  }
+
+  // See Sequencer::ReclaimGatingSequences(), called with gating_mutex_ held.
+  void ReclaimGating() {
+    if (retired_gating_.empty() ||
+        publishers_.load(std::memory_order_seq_cst) != 0)
+      return;
+    retired_gating_.clear();
+    has_retired_gating_.store(false, std::memory_order_relaxed);
+  }
+
+  // See Sequencer::Regate(), a consumer added during the claim bumped the
+  // epoch.
+  int64_t Regate(const GatingSet* gating, const int64_t& sequence) {
+    uint32_t epoch;
+    while ((epoch = header_->consumers_epoch.load()) != gating->epoch) {
+      gating = Gating(epoch);
+      const int64_t wrap_point = sequence - static_cast<int64_t>(size());
+      while (GetMinimumSequence(gating->sequences) < wrap_point &&
+             header_->consumers_epoch.load() == epoch) {
+        std::this_thread::yield();
+      }
+    }
+    return sequence;
+  }
+
+  static bool IsShmName(const std::string& name) {
+    return name.size() > 1 && name[0] == '/' &&
+           name.find('/', 1) == std::string::npos;
+  }
+
+  static int Open(const std::string& name, int flags) {
+    const int fd = IsShmName(name) ? shm_open(name.c_str(), flags, 0600)
+                                   : open(name.c_str(), flags, 0600);
+    if (fd < 0) throw std::system_error(errno, std::generic_category(), name);
+    return fd;
+  }
+
+  void Map(int fd, bool populate) {
+    int flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+    if (populate) flags |= MAP_POPULATE;
+#endif
+    region_ = mmap(nullptr, mapped_size_, PROT_READ | PROT_WRITE, flags, fd, 0);
+    const int error = errno;
+    close(fd);
+    if (region_ == MAP_FAILED)
+      throw std::system_error(error, std::generic_category(), "mmap");
+  }
+
+  void Prefault() {
+#ifdef MADV_POPULATE_WRITE
+    if (madvise(region_, mapped_size_, MADV_POPULATE_WRITE) == 0) return;
+#endif
+    const size_t page = sysconf(_SC_PAGESIZE);
+    char* region = static_cast<char*>(region_);
+    for (size_t offset = 0; offset < mapped_size_; offset += page)
+      __atomic_fetch_or(region + offset, 0, __ATOMIC_RELAXED);
+  }
+
+  void* Offset(size_t offset) const {
+    return static_cast<char*>(region_) + offset;
+  }
+
+  static size_t Align(size_t offset) {
+    return RoundUp(offset, CACHE_LINE_SIZE_IN_BYTES);
+  }
+
+  static size_t RoundUp(size_t bytes, size_t alignment) {
+    return (bytes + alignment - 1) / alignment * alignment;
+  }
+
+  void* region_ = nullptr;
+  size_t mapped_size_ = 0;
+  SharedRingHeader* header_ = nullptr;
+  C* claim_strategy_ = nullptr;
+  T* events_ = nullptr;
+
+  std::atomic<const GatingSet*> gating_{nullptr};
+  std::unique_ptr<const GatingSet> current_gating_;
+  std::vector<std::unique_ptr<const GatingSet> > retired_gating_;
+  std::atomic<bool> has_retired_gating_{false};
+  std::atomic<uint32_t> publishers_{0};
+  std::mutex gating_mutex_;
+
+  DISALLOW_COPY_MOVE_AND_ASSIGN(SharedSequencer);
+};
+
+};  // namespace disruptor
+
+#endif  // DISRUPTOR_SHARED_SEQUENCER_H_ NOLINT
@@ -0,0 +1,259 @@
+// Copyright (c) 2011-2015, Francois Saint-Jacques
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the disruptor-- nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL FRANCOIS SAINT-JACQUES BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef DISRUPTOR_TRACING_H_  // NOLINT
+#define DISRUPTOR_TRACING_H_  // NOLINT
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "utils.h"
+
+namespace disruptor {
+
+// Cheap timestamps for tracing: the time stamp counter on x86, the virtual
+// counter on ARMv8 and steady_clock elsewhere. Ticks are converted to
+// nanoseconds with a ratio calibrated once against steady_clock, see
+// Calibrate(), which assumes an invariant counter, as found on any recent CPU.
+class TscClock {
+ public:
+  static uint64_t Now() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#elif defined(__aarch64__)
+    uint64_t ticks;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+    return ticks;
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+#endif
+  }
+
+  static uint64_t ToNanoseconds(uint64_t ticks) {
+    return static_cast<uint64_t>(ticks * NanosecondsPerTick());
+  }
+
+  static double NanosecondsPerTick() {
+    static const double ratio = Measure();
+    return ratio;
+  }
+
+  // Measure the tick rate now, spinning ~2ms the first time only, rather
+  // than on the first ToNanoseconds() of a handler thread. Called by Tracer.
+  static void Calibrate() { NanosecondsPerTick(); }
+
+ private:
+  static double Measure() {
+    const auto calibration = std::chrono::milliseconds(2);
+    const auto begin = std::chrono::steady_clock::now();
+    const uint64_t first = Now();
+    auto end = begin;
+    while (end - begin < calibration) end = std::chrono::steady_clock::now();
+    const uint64_t ticks = Now() - first;
+    const double elapsed =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin)
+            .count();
+    return ticks == 0 ? 1.0 : elapsed / ticks;
+  }
+};
+
+// HDR style histogram of latencies in nanoseconds: values below 2^kSubBits
+// are counted exactly, larger ones in 2^kSubBits linear sub-buckets per power
+// of 2, so every bucket is within 1 / 2^kSubBits of the values it counts.
+// Recording is lock-free and can happen from any thread.
+class LatencyHistogram {
+ public:
+  static constexpr size_t kSubBits = 5;
+  static constexpr size_t kSubBuckets = 1 << kSubBits;
+  static constexpr size_t kBuckets = (64 - kSubBits + 1) * kSubBuckets;
+
+  LatencyHistogram() : buckets_(new std::atomic<uint64_t>[kBuckets]) {
+    Reset();
+  }
+
+  void Record(uint64_t nanoseconds) {
+    buckets_[BucketOf(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    uint64_t max = max_.load(std::memory_order_relaxed);
+    while (nanoseconds > max &&
+           !max_.compare_exchange_weak(max, nanoseconds,
+                                       std::memory_order_relaxed)) {
+    }
+  }
+
+  uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+  uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+
+  // Highest value equivalent to the recorded one at the given percentile.
+  //
+  // @param percentile in [0, 100], e.g. 99.9.
+  //
+  // @return latency in nanoseconds, 0 when nothing was recorded.
+  uint64_t ValueAtPercentile(double percentile) const {
+    const uint64_t total = count();
+    if (total == 0) return 0;
+    uint64_t rank = static_cast<uint64_t>(percentile / 100.0 * total + 0.5);
+    if (rank < 1) rank = 1;
+    if (rank > total) rank = total;
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < kBuckets; ++bucket) {
+      seen += buckets_[bucket].load(std::memory_order_relaxed);
+      if (seen >= rank) {
+        const uint64_t highest = HighestOf(bucket);
+        return highest < max() ? highest : max();
+      }
+    }
+    return max();
+  }
+
+  // Not safe while recording.
+  void Reset() {
+    for (size_t bucket = 0; bucket < kBuckets; ++bucket)
+      buckets_[bucket].store(0, std::memory_order_relaxed);
+    count_.store(0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+  }
+
+  static size_t BucketOf(uint64_t value) {
+    if (value < kSubBuckets) return value;
+    const size_t exponent = 63 - __builtin_clzll(value);
+    const size_t shift = exponent - kSubBits;
+    return (shift + 1) * kSubBuckets + (value >> shift) - kSubBuckets;
+  }
+
+  static uint64_t HighestOf(size_t bucket) {
+    if (bucket < kSubBuckets) return bucket;
+    const size_t shift = bucket / kSubBuckets - 1;
+    const uint64_t lowest = (kSubBuckets + bucket % kSubBuckets) << shift;
+    return lowest + ((uint64_t(1) << shift) - 1);
+  }
+
+ private:
+  std::unique_ptr<std::atomic<uint64_t>[]> buckets_;
+  std::atomic<uint64_t> count_;
+  std::atomic<uint64_t> max_;
+
+  DISALLOW_COPY_MOVE_AND_ASSIGN(LatencyHistogram);
+};
+
+// Publish to handle latency of each stage of a pipeline, stages being
+// numbered by the distributors that trace into it. A tracer can be shared by
+// distributors chained through connectors, their events then keep the
+// timestamp of their first publication, see TraceOrigin().
+class Tracer {
+ public:
+  // @param stages number of handlers traced.
+  explicit Tracer(size_t stages) : histograms_(stages) {
+    TscClock::Calibrate();
+  }
+
+  size_t stages() const { return histograms_.size(); }
+
+  LatencyHistogram& stage(size_t stage) { return histograms_[stage]; }
+  const LatencyHistogram& stage(size_t stage) const {
+    return histograms_[stage];
+  }
+
+ private:
+  std::vector<LatencyHistogram> histograms_;
+
+  DISALLOW_COPY_MOVE_AND_ASSIGN(Tracer);
+};
+
+// Origin of the event handled by the calling thread, kept while its handler
+// runs so that an event it publishes further down a chain keeps the origin's
+// timestamp. 0 outside of a traced handler.
+inline uint64_t& TraceOrigin() {
+  static thread_local uint64_t origin = 0;
+  return origin;
+}
+
+// Timestamps of the events of a ring, kept outside of the events in a side
+// array indexed like the RingBuffer: the publication of each slot, then the
+// time each stage finished handling it. A slot is written by its producer
+// before the event is published and by each stage while it gates the slot,
+// so the timestamps of an event are valid as long as the event is.
+class TraceRing {
+ public:
+  // @param size   of the traced ring, a power of 2.
+  // @param tracer collecting the latencies.
+  TraceRing(size_t size, Tracer* tracer)
+      : mask_(size - 1),
+        columns_(tracer->stages() + 1),
+        tracer_(tracer),
+        stamps_(new uint64_t[size * columns_]()) {}
+
+  // Stamp a claimed slot with its publication time, before publishing it.
+  void Stamp(int64_t sequence, uint64_t ticks) {
+    stamps_[Slot(sequence)] = ticks;
+  }
+
+  // Timestamp to publish with: the traced event being handled if any, now
+  // otherwise.
+  static uint64_t PublishTicks() {
+    const uint64_t origin = TraceOrigin();
+    return origin ? origin : TscClock::Now();
+  }
+
+  // Record that a stage finished handling an event.
+  void Handled(size_t stage, int64_t sequence) {
+    const uint64_t now = TscClock::Now();
+    const uint64_t origin = stamps_[Slot(sequence)];
+    stamps_[Slot(sequence) + 1 + stage] = now;
+    tracer_->stage(stage).Record(
+        now > origin ? TscClock::ToNanoseconds(now - origin) : 0);
+  }
+
+  // @return publication of an event, in TscClock ticks.
+  uint64_t origin(int64_t sequence) const { return stamps_[Slot(sequence)]; }
+
+  // @return end of the handling of an event by a stage, in TscClock ticks.
+  uint64_t handled(size_t stage, int64_t sequence) const {
+    return stamps_[Slot(sequence) + 1 + stage];
+  }
+
+  size_t stages() const { return columns_ - 1; }
+
+ private:
+  size_t Slot(int64_t sequence) const {
+    return (sequence & mask_) * columns_;
+  }
+
+  const size_t mask_;
+  const size_t columns_;
+  Tracer* tracer_;
+  std::unique_ptr<uint64_t[]> stamps_;
+
+  DISALLOW_COPY_MOVE_AND_ASSIGN(TraceRing);
+};
+
+};  // namespace disruptor
+
+#endif  // DISRUPTOR_TRACING_H_ NOLINT
@@ -26,6 +26,8 @@
 #ifndef DISRUPTOR_UTILS_H_  // NOLINT
 #define DISRUPTOR_UTILS_H_  // NOLINT
 
+#include <cstddef>
+
 // From Google C++ Standard, modified to use C++11 deleted functions.
 // A macro to disallow the copy constructor and operator= functions.
 #define DISALLOW_COPY_MOVE_AND_ASSIGN(TypeName) \
@@ -33,4 +35,29 @@
   TypeName(const TypeName&&) = delete;          \
   void operator=(const TypeName&) = delete
 
+namespace disruptor {
+
+// Hint the processor that the calling thread is busy spinning, this lowers
+// the power drawn by the loop and leaves execution resources to the
+// hyperthread sibling.
+inline void CpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+  asm volatile("yield" ::: "memory");
+#endif
+}
+
+// Hint the processor to bring every cache line of an object in for reading,
+// ahead of a consumer reaching it.
+template <typename T>
+inline void PrefetchForRead(const T* object) {
+  constexpr size_t kCacheLineSize = 64;
+  const char* bytes = reinterpret_cast<const char*>(object);
+  for (size_t offset = 0; offset < sizeof(T); offset += kCacheLineSize)
+    __builtin_prefetch(bytes + offset, 0, 3);
+}
+
+};  // namespace disruptor
+
 #endif  // DISRUPTOR_UTILS_H_ NOLINT
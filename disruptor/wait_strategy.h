@@ -27,12 +27,23 @@
 #define DISRUPTOR_WAITSTRATEGY_H_  // NOLINT
 
 #include <sys/time.h>
-
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <array>
 #include <chrono>
+#include <climits>
 #include <thread>
 #include <condition_variable>
+#include <functional>
+#include <mutex>
 #include <vector>
 
+#include "gating_view.h"
 #include "sequence.h"
 
 namespace disruptor {
@@ -78,6 +89,17 @@ class WaitStrategy {
                   const std::atomic<bool>& consumer_is_running,
                   const std::chrono::duration& timeout);
 
+  // Same as above, reading the gating sequences through a {@link
+  // GatingView} selected once for the consumer's dependency shape.
+  template <typename V>
+  int64_t WaitFor(const int64_t& sequence, V& view,
+                  const std::atomic<bool>& alerted);
+
+  template <typename V, class R, class P>
+  int64_t WaitFor(const int64_t& sequence, V& view,
+                  const std::atomic<bool>& alerted,
+                  const std::chrono::duration<R, P>& timeout);
+
   // Signal the strategy that the cursor as advanced. Some strategy depends
   // on this behaviour to unblock.
   void SignalAllWhenBlocking();
@@ -111,7 +133,8 @@ class SleepingStrategy;
 // `alerted` atomic.
 //
 // The user can optionnaly provide a maximum timeout to the blocking operation,
-// see std::condition_any::wait_for() documentation for limitations.
+// see std::condition_variable_any::wait_until() documentation for
+// limitations.
 //
 // This strategy uses a condition variable inside a lock to block the
 // event procesor which saves CPU resource at the expense of lock
@@ -120,15 +143,84 @@ class SleepingStrategy;
 // low-latency are not as important as CPU resource.
 class BlockingStrategy;
 
+// Phased blocking strategy that busy spins with a pause hint for S loops,
+// yields for Y loops and finally parks the consumer on a futex until the
+// sequencer's cursor advances.
+//
+// Like BlockingStrategy, the sequencer MUST call SignalAllWhenBlocking() to
+// unpark consumers. Publishers only pay for a syscall when a consumer is
+// actually parked, the fast path stays close to BusySpinStrategy while idle
+// consumers do not burn a core.
+template <int64_t S, int64_t Y>
+class FutexBlockingStrategy;
+
+#ifdef __linux__
+// Event loop friendly strategy, it blocks like FutexBlockingStrategy and
+// additionally lets consumers multiplex the ring with other file
+// descriptors.
+//
+// A consumer subscribes to get its own eventfd, see SequenceBarrier's
+// wait_fd(). Once armed, SignalAllWhenBlocking() makes it readable on the
+// next publication so the consumer can sit in poll()/epoll_wait() next to
+// its sockets. Publishers only write to eventfds that are armed.
+template <int64_t S, int64_t Y>
+class EventFdStrategy;
+#endif
+
 // defaults
 using kDefaultWaitStrategy = BusySpinStrategy;
 constexpr int64_t kDefaultRetryLoops = 200L;
 using kDefaultDuration = std::chrono::milliseconds;
 constexpr int kDefaultDurationValue = 1;
+// Spinning loops only read the clock once every kDeadlineCheckLoops loops.
+constexpr int64_t kDeadlineCheckLoops = 64L;
+
+// Deadline of a timed wait on the monotonic clock, immune to wall clock
+// adjustments. A spinning loop calls Expired() which only reads the clock
+// every kDeadlineCheckLoops calls, loops that yield, sleep or park already pay
+// for a syscall and call ExpiredNow().
+class Deadline {
+ public:
+  template <class R, class P>
+  explicit Deadline(const std::chrono::duration<R, P>& timeout)
+      : stop_(std::chrono::steady_clock::now() +
+              std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                  timeout)),
+        countdown_(kDeadlineCheckLoops) {}
+
+  bool Expired() {
+    if (--countdown_ > 0) return false;
+    countdown_ = kDeadlineCheckLoops;
+    return ExpiredNow();
+  }
 
-// used internally
-static inline std::function<int64_t()> buildMinSequenceFunction(
-    const Sequence& cursor, const std::vector<Sequence*>& dependents);
+  bool ExpiredNow() const { return stop_ <= std::chrono::steady_clock::now(); }
+
+  // @return time left before the deadline, negative once expired.
+  std::chrono::nanoseconds Remaining() const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        stop_ - std::chrono::steady_clock::now());
+  }
+
+  const std::chrono::steady_clock::time_point& stop() const { return stop_; }
+
+ private:
+  std::chrono::steady_clock::time_point stop_;
+  int64_t countdown_;
+};
+
+// used internally, dispatch on the gating view matching the dependents.
+template <typename W>
+static inline int64_t WaitForDependents(
+    W& strategy, const int64_t& sequence, const Sequence& cursor,
+    const std::vector<Sequence*>& dependents,
+    const std::atomic<bool>& alerted);
+
+template <typename W, class R, class P>
+static inline int64_t WaitForDependents(
+    W& strategy, const int64_t& sequence, const Sequence& cursor,
+    const std::vector<Sequence*>& dependents, const std::atomic<bool>& alerted,
+    const std::chrono::duration<R, P>& timeout);
 
 class BusySpinStrategy {
  public:
@@ -137,31 +229,45 @@ class BusySpinStrategy {
   int64_t WaitFor(const int64_t& sequence, const Sequence& cursor,
                   const std::vector<Sequence*>& dependents,
                   const std::atomic<bool>& alerted) {
+    return WaitForDependents(*this, sequence, cursor, dependents, alerted);
+  }
+
+  template <class R, class P>
+  int64_t WaitFor(const int64_t& sequence, const Sequence& cursor,
+                  const std::vector<Sequence*>& dependents,
+                  const std::atomic<bool>& alerted,
+                  const std::chrono::duration<R, P>& timeout) {
+    return WaitForDependents(*this, sequence, cursor, dependents, alerted,
+                             timeout);
+  }
+
+  template <typename V>
+  int64_t WaitFor(const int64_t& sequence, V& view,
+                  const std::atomic<bool>& alerted) {
     int64_t available_sequence = kInitialCursorValue;
-    const auto min_sequence = buildMinSequenceFunction(cursor, dependents);
 
-    while ((available_sequence = min_sequence()) < sequence) {
+    while ((available_sequence = view.Get(sequence)) < sequence) {
       if (alerted.load()) return kAlertedSignal;
+
+      CpuRelax();
     }
 
     return available_sequence;
   }
 
-  template <class R, class P>
-  int64_t WaitFor(const int64_t& sequence, const Sequence& cursor,
-                  const std::vector<Sequence*>& dependents,
+  template <typename V, class R, class P>
+  int64_t WaitFor(const int64_t& sequence, V& view,
                   const std::atomic<bool>& alerted,
                   const std::chrono::duration<R, P>& timeout) {
     int64_t available_sequence = kInitialCursorValue;
+    Deadline deadline(timeout);
 
-    const auto start = std::chrono::system_clock::now();
-    const auto stop = start + timeout;
-    const auto min_sequence = buildMinSequenceFunction(cursor, dependents);
-
-    while ((available_sequence = min_sequence()) < sequence) {
+    while ((available_sequence = view.Get(sequence)) < sequence) {
       if (alerted.load()) return kAlertedSignal;
 
-      if (stop <= std::chrono::system_clock::now()) return kTimeoutSignal;
+      if (deadline.Expired()) return kTimeoutSignal;
+
+      CpuRelax();
     }
 
     return available_sequence;
@@ -180,12 +286,25 @@ class YieldingStrategy {
   int64_t WaitFor(const int64_t& sequence, const Sequence& cursor,
                   const std::vector<Sequence*>& dependents,
                   const std::atomic<bool>& alerted) {
+    return WaitForDependents(*this, sequence, cursor, dependents, alerted);
+  }
+
+  template <class R, class P>
+  int64_t WaitFor(const int64_t& sequence, const Sequence& cursor,
+                  const std::vector<Sequence*>& dependents,
+                  const std::atomic<bool>& alerted,
+                  const std::chrono::duration<R, P>& timeout) {
+    return WaitForDependents(*this, sequence, cursor, dependents, alerted,
+                             timeout);
+  }
+
+  template <typename V>
+  int64_t WaitFor(const int64_t& sequence, V& view,
+                  const std::atomic<bool>& alerted) {
     int64_t available_sequence = kInitialCursorValue;
     int counter = S;
 
-    const auto min_sequence = buildMinSequenceFunction(cursor, dependents);
-
-    while ((available_sequence = min_sequence()) < sequence) {
+    while ((available_sequence = view.Get(sequence)) < sequence) {
       if (alerted.load()) return kAlertedSignal;
 
       counter = ApplyWaitMethod(counter);
@@ -194,24 +313,22 @@ class YieldingStrategy {
     return available_sequence;
   }
 
-  template <class R, class P>
-  int64_t WaitFor(const int64_t& sequence, const Sequence& cursor,
-                  const std::vector<Sequence*>& dependents,
+  template <typename V, class R, class P>
+  int64_t WaitFor(const int64_t& sequence, V& view,
                   const std::atomic<bool>& alerted,
                   const std::chrono::duration<R, P>& timeout) {
     int64_t available_sequence = kInitialCursorValue;
     int64_t counter = S;
+    Deadline deadline(timeout);
 
-    const auto start = std::chrono::system_clock::now();
-    const auto stop = start + timeout;
-    const auto min_sequence = buildMinSequenceFunction(cursor, dependents);
-
-    while ((available_sequence = min_sequence()) < sequence) {
+    while ((available_sequence = view.Get(sequence)) < sequence) {
       if (alerted.load()) return kAlertedSignal;
 
-      counter = ApplyWaitMethod(counter);
+      // yields are syscalls anyway, only spins are worth skipping the clock.
+      if (counter ? deadline.Expired() : deadline.ExpiredNow())
+        return kTimeoutSignal;
 
-      if (stop <= std::chrono::system_clock::now()) return kTimeoutSignal;
+      counter = ApplyWaitMethod(counter);
     }
 
     return available_sequence;
@@ -222,6 +339,7 @@ class YieldingStrategy {
  private:
   inline int64_t ApplyWaitMethod(int64_t counter) {
     if (counter) {
+      CpuRelax();
       return --counter;
     }
 
@@ -241,12 +359,25 @@ class SleepingStrategy {
   int64_t WaitFor(const int64_t& sequence, const Sequence& cursor,
                   const std::vector<Sequence*>& dependents,
                   const std::atomic<bool>& alerted) {
+    return WaitForDependents(*this, sequence, cursor, dependents, alerted);
+  }
+
+  template <class R, class P>
+  int64_t WaitFor(const int64_t& sequence, const Sequence& cursor,
+                  const std::vector<Sequence*>& dependents,
+                  const std::atomic<bool>& alerted,
+                  const std::chrono::duration<R, P>& timeout) {
+    return WaitForDependents(*this, sequence, cursor, dependents, alerted,
+                             timeout);
+  }
+
+  template <typename V>
+  int64_t WaitFor(const int64_t& sequence, V& view,
+                  const std::atomic<bool>& alerted) {
     int64_t available_sequence = kInitialCursorValue;
     int counter = S;
 
-    const auto min_sequence = buildMinSequenceFunction(cursor, dependents);
-
-    while ((available_sequence = min_sequence()) < sequence) {
+    while ((available_sequence = view.Get(sequence)) < sequence) {
       if (alerted.load()) return kAlertedSignal;
 
       counter = ApplyWaitMethod(counter);
@@ -255,24 +386,22 @@ class SleepingStrategy {
     return available_sequence;
   }
 
-  template <class R, class P>
-  int64_t WaitFor(const int64_t& sequence, const Sequence& cursor,
-                  const std::vector<Sequence*>& dependents,
+  template <typename V, class R, class P>
+  int64_t WaitFor(const int64_t& sequence, V& view,
                   const std::atomic<bool>& alerted,
                   const std::chrono::duration<R, P>& timeout) {
     int64_t available_sequence = kInitialCursorValue;
     int64_t counter = S;
+    Deadline deadline(timeout);
 
-    const auto start = std::chrono::system_clock::now();
-    const auto stop = start + timeout;
-    const auto min_sequence = buildMinSequenceFunction(cursor, dependents);
-
-    while ((available_sequence = min_sequence()) < sequence) {
+    while ((available_sequence = view.Get(sequence)) < sequence) {
       if (alerted.load()) return kAlertedSignal;
 
-      counter = ApplyWaitMethod(counter);
+      // only the spinning phase is worth skipping the clock.
+      if (counter > (S / 2) ? deadline.Expired() : deadline.ExpiredNow())
+        return kTimeoutSignal;
 
-      if (stop <= std::chrono::system_clock::now()) return kTimeoutSignal;
+      counter = ApplyWaitMethod(counter);
     }
 
     return available_sequence;
@@ -284,6 +413,7 @@ class SleepingStrategy {
   inline int64_t ApplyWaitMethod(int64_t counter) {
     if (counter > (S / 2)) {
       --counter;
+      CpuRelax();
     } else if (counter > 0) {
       --counter;
       std::this_thread::yield();
@@ -304,10 +434,7 @@ class BlockingStrategy {
   int64_t WaitFor(const int64_t& sequence, const Sequence& cursor,
                   const std::vector<Sequence*>& dependents,
                   const std::atomic<bool>& alerted) {
-    return WaitFor(sequence, cursor, dependents, alerted, [this](Lock& lock) {
-      consumer_notify_condition_.wait(lock);
-      return false;
-    });
+    return WaitForDependents(*this, sequence, cursor, dependents, alerted);
   }
 
   template <class Rep, class Period>
@@ -315,12 +442,31 @@ class BlockingStrategy {
                   const std::vector<Sequence*>& dependents,
                   const std::atomic<bool>& alerted,
                   const std::chrono::duration<Rep, Period>& timeout) {
-    return WaitFor(sequence, cursor, dependents, alerted,
-                   [this, timeout](Lock& lock) {
-                     return std::cv_status::timeout ==
-                            consumer_notify_condition_.wait_for(
-                                lock, std::chrono::microseconds(timeout));
-                   });
+    return WaitForDependents(*this, sequence, cursor, dependents, alerted,
+                             timeout);
+  }
+
+  template <typename V>
+  int64_t WaitFor(const int64_t& sequence, V& view,
+                  const std::atomic<bool>& alerted) {
+    return WaitForCursor(sequence, view, alerted, [this](Lock& lock) {
+      consumer_notify_condition_.wait(lock);
+      return false;
+    });
+  }
+
+  template <typename V, class Rep, class Period>
+  int64_t WaitFor(const int64_t& sequence, V& view,
+                  const std::atomic<bool>& alerted,
+                  const std::chrono::duration<Rep, Period>& timeout) {
+    // a deadline, so that every signal does not restart the whole timeout.
+    const Deadline deadline(timeout);
+    return WaitForCursor(sequence, view, alerted,
+                         [this, &deadline](Lock& lock) {
+                           return std::cv_status::timeout ==
+                                  consumer_notify_condition_.wait_until(
+                                      lock, deadline.stop());
+                         });
   }
 
   void SignalAllWhenBlocking() {
@@ -332,14 +478,15 @@ class BlockingStrategy {
   using Lock = std::unique_lock<std::recursive_mutex>;
   using Waiter = std::function<bool(Lock&)>;
 
-  inline int64_t WaitFor(const int64_t& sequence, const Sequence& cursor,
-                         const std::vector<Sequence*>& dependents,
-                         const std::atomic<bool>& alerted,
-                         const Waiter& locker) {
+  template <typename V>
+  inline int64_t WaitForCursor(const int64_t& sequence, V& view,
+                               const std::atomic<bool>& alerted,
+                               const Waiter& locker) {
     int64_t available_sequence = kInitialCursorValue;
     // BlockingStrategy is a special case where the unblock signal comes from
     // the sequencer. This is why we need to wait on the cursor first, and
     // then on the dependents.
+    const Sequence& cursor = view.cursor();
     if ((available_sequence = cursor.sequence()) < sequence) {
       std::unique_lock<std::recursive_mutex> ulock(mutex_);
       while ((available_sequence = cursor.sequence()) < sequence) {
@@ -351,10 +498,10 @@ class BlockingStrategy {
     }
 
     // Now we wait on dependents.
-    if (dependents.size()) {
-      while ((available_sequence = GetMinimumSequence(dependents)) < sequence) {
-        if (alerted) return kAlertedSignal;
-      }
+    while ((available_sequence = view.Get(sequence)) < sequence) {
+      if (alerted) return kAlertedSignal;
+
+      CpuRelax();
     }
 
     return available_sequence;
@@ -367,12 +514,260 @@ class BlockingStrategy {
   DISALLOW_COPY_MOVE_AND_ASSIGN(BlockingStrategy);
 };
 
-static inline std::function<int64_t()> buildMinSequenceFunction(
-    const Sequence& cursor, const std::vector<Sequence*>& dependents) {
-  if (!dependents.size())
-    return [&cursor]() { return cursor.sequence(); };
-  else
-    return [&dependents]() { return GetMinimumSequence(dependents); };
+template <int64_t S = kDefaultRetryLoops, int64_t Y = kDefaultRetryLoops>
+class FutexBlockingStrategy {
+ public:
+  FutexBlockingStrategy() : waiters_(0), epoch_(0) {}
+
+  int64_t WaitFor(const int64_t& sequence, const Sequence& cursor,
+                  const std::vector<Sequence*>& dependents,
+                  const std::atomic<bool>& alerted) {
+    return WaitForDependents(*this, sequence, cursor, dependents, alerted);
+  }
+
+  template <class R, class P>
+  int64_t WaitFor(const int64_t& sequence, const Sequence& cursor,
+                  const std::vector<Sequence*>& dependents,
+                  const std::atomic<bool>& alerted,
+                  const std::chrono::duration<R, P>& timeout) {
+    return WaitForDependents(*this, sequence, cursor, dependents, alerted,
+                             timeout);
+  }
+
+  template <typename V>
+  int64_t WaitFor(const int64_t& sequence, V& view,
+                  const std::atomic<bool>& alerted) {
+    int64_t available_sequence = kInitialCursorValue;
+    int64_t counter = S + Y;
+
+    while ((available_sequence = view.Get(sequence)) < sequence) {
+      if (alerted.load()) return kAlertedSignal;
+
+      counter = ApplyWaitMethod(counter, sequence, view.cursor(), alerted,
+                                nullptr);
+    }
+
+    return available_sequence;
+  }
+
+  template <typename V, class R, class P>
+  int64_t WaitFor(const int64_t& sequence, V& view,
+                  const std::atomic<bool>& alerted,
+                  const std::chrono::duration<R, P>& timeout) {
+    int64_t available_sequence = kInitialCursorValue;
+    int64_t counter = S + Y;
+    Deadline deadline(timeout);
+
+    while ((available_sequence = view.Get(sequence)) < sequence) {
+      if (alerted.load()) return kAlertedSignal;
+
+      if (counter > Y) {
+        if (deadline.Expired()) return kTimeoutSignal;
+        counter = ApplyWaitMethod(counter, sequence, view.cursor(), alerted,
+                                  nullptr);
+        continue;
+      }
+
+      // the park timeout needs the clock anyway.
+      const auto remaining = deadline.Remaining();
+      if (remaining.count() <= 0) return kTimeoutSignal;
+
+      struct timespec park_timeout;
+      park_timeout.tv_sec = remaining.count() / 1000000000L;
+      park_timeout.tv_nsec = remaining.count() % 1000000000L;
+
+      counter = ApplyWaitMethod(counter, sequence, view.cursor(), alerted,
+                                &park_timeout);
+    }
+
+    return available_sequence;
+  }
+
+  void SignalAllWhenBlocking() {
+    // Orders the cursor update before reading the waiters count, a consumer
+    // registering concurrently either is seen here or sees the new cursor.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiters_.load(std::memory_order_relaxed) > 0) {
+      epoch_.fetch_add(1, std::memory_order_release);
+      Wake();
+    }
+  }
+
+ private:
+  inline int64_t ApplyWaitMethod(int64_t counter, const int64_t& sequence,
+                                 const Sequence& cursor,
+                                 const std::atomic<bool>& alerted,
+                                 const struct timespec* timeout) {
+    if (counter > Y) {
+      CpuRelax();
+      return --counter;
+    }
+
+    if (counter > 0) {
+      std::this_thread::yield();
+      return --counter;
+    }
+
+    // Only the cursor is signaled, lagging dependents are waited on by
+    // yielding.
+    if (cursor.sequence() < sequence)
+      Park(sequence, cursor, alerted, timeout);
+    else
+      std::this_thread::yield();
+
+    return counter;
+  }
+
+  void Park(const int64_t& sequence, const Sequence& cursor,
+            const std::atomic<bool>& alerted, const struct timespec* timeout) {
+    const int32_t epoch = epoch_.load(std::memory_order_acquire);
+    waiters_.fetch_add(1, std::memory_order_seq_cst);
+    // Check again once registered, see SignalAllWhenBlocking().
+    if (cursor.sequence() < sequence && !alerted.load()) Wait(epoch, timeout);
+    waiters_.fetch_sub(1, std::memory_order_release);
+  }
+
+  void Wait(int32_t epoch, const struct timespec* timeout) {
+#ifdef __linux__
+    syscall(SYS_futex, reinterpret_cast<int32_t*>(&epoch_), FUTEX_WAIT_PRIVATE,
+            epoch, timeout, nullptr, 0);
+#else
+    std::this_thread::yield();
+#endif
+  }
+
+  void Wake() {
+#ifdef __linux__
+    syscall(SYS_futex, reinterpret_cast<int32_t*>(&epoch_), FUTEX_WAKE_PRIVATE,
+            INT_MAX, nullptr, nullptr, 0);
+#endif
+  }
+
+  // members
+  std::atomic<int32_t> waiters_;
+  std::atomic<int32_t> epoch_;
+
+  DISALLOW_COPY_MOVE_AND_ASSIGN(FutexBlockingStrategy);
+};
+
+#ifdef __linux__
+constexpr size_t kMaxEventFdSubscribers = 64;
+
+template <int64_t S = kDefaultRetryLoops, int64_t Y = kDefaultRetryLoops>
+class EventFdStrategy : public FutexBlockingStrategy<S, Y> {
+ public:
+  EventFdStrategy() : subscribers_(0) {}
+
+  ~EventFdStrategy() {
+    const size_t size = subscribers_.load();
+    for (size_t i = 0; i < size; ++i) close(slots_[i].fd);
+  }
+
+  // Register a consumer with its own eventfd.
+  //
+  // @return the subscription index, or -1 if no more can be created.
+  int Subscribe() {
+    std::lock_guard<std::mutex> lock(subscribe_mutex_);
+    const size_t index = subscribers_.load();
+    if (index == kMaxEventFdSubscribers) return -1;
+
+    const int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (fd < 0) return -1;
+
+    slots_[index].fd = fd;
+    slots_[index].armed.store(false);
+    subscribers_.store(index + 1, std::memory_order_release);
+    return static_cast<int>(index);
+  }
+
+  // Get the eventfd of a subscription.
+  int wait_fd(int subscription) const { return slots_[subscription].fd; }
+
+  // Reset the eventfd of a subscription and make SignalAllWhenBlocking()
+  // write to it on the next publication.
+  void Arm(int subscription) {
+    Slot& slot = slots_[subscription];
+    uint64_t value;
+    while (read(slot.fd, &value, sizeof(value)) > 0) {
+    }
+    slot.armed.store(true, std::memory_order_relaxed);
+    // The caller reads the sequences again after arming, see
+    // SignalAllWhenBlocking().
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+  }
+
+  void SignalAllWhenBlocking() {
+    // also orders the cursor update before reading the armed flags.
+    FutexBlockingStrategy<S, Y>::SignalAllWhenBlocking();
+
+    const size_t size =
+        subscribers_.load(std::memory_order_acquire);
+    for (size_t i = 0; i < size; ++i) {
+      Slot& slot = slots_[i];
+      if (slot.armed.load(std::memory_order_relaxed) &&
+          slot.armed.exchange(false)) {
+        const uint64_t value = 1;
+        ssize_t written = write(slot.fd, &value, sizeof(value));
+        (void)written;
+      }
+    }
+  }
+
+ private:
+  struct Slot {
+    int fd;
+    std::atomic<bool> armed;
+  };
+
+  // members
+  std::array<Slot, kMaxEventFdSubscribers> slots_;
+  std::atomic<size_t> subscribers_;
+  std::mutex subscribe_mutex_;
+
+  DISALLOW_COPY_MOVE_AND_ASSIGN(EventFdStrategy);
+};
+#endif
+
+template <typename W>
+static inline int64_t WaitForDependents(
+    W& strategy, const int64_t& sequence, const Sequence& cursor,
+    const std::vector<Sequence*>& dependents,
+    const std::atomic<bool>& alerted) {
+  switch (dependents.size()) {
+    case 0: {
+      CursorGatingView view(cursor, dependents);
+      return strategy.WaitFor(sequence, view, alerted);
+    }
+    case 1: {
+      SingleGatingView view(cursor, dependents);
+      return strategy.WaitFor(sequence, view, alerted);
+    }
+    default: {
+      MultiGatingView view(cursor, dependents);
+      return strategy.WaitFor(sequence, view, alerted);
+    }
+  }
+}
+
+template <typename W, class R, class P>
+static inline int64_t WaitForDependents(
+    W& strategy, const int64_t& sequence, const Sequence& cursor,
+    const std::vector<Sequence*>& dependents, const std::atomic<bool>& alerted,
+    const std::chrono::duration<R, P>& timeout) {
+  switch (dependents.size()) {
+    case 0: {
+      CursorGatingView view(cursor, dependents);
+      return strategy.WaitFor(sequence, view, alerted, timeout);
+    }
+    case 1: {
+      SingleGatingView view(cursor, dependents);
+      return strategy.WaitFor(sequence, view, alerted, timeout);
+    }
+    default: {
+      MultiGatingView view(cursor, dependents);
+      return strategy.WaitFor(sequence, view, alerted, timeout);
+    }
+  }
 }
 
 };  // namespace disruptor
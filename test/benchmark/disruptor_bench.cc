@@ -0,0 +1,392 @@
+// Copyright (c) 2011-2015, Francois Saint-Jacques
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the disruptor-- nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL FRANCOIS SAINT-JACQUES BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Throughput and round trip latency of every topology, for each claim and
+// wait strategy combination.
+//
+// Each run first publishes warmup events, then measures the throughput of
+// events published as fast as possible, then the round trip latency of one
+// event at a time: from its publication until the producer sees the last
+// stage acknowledge it. Threads are pinned round robin on --cpus, the
+// producer on the first one.
+//
+// usage: disruptor_bench [--events N] [--warmup N] [--latency-events N]
+//                        [--cpus 0,1,2,3] [--filter text] [--json]
+//
+// --filter only runs the combinations whose name, e.g.
+// "pipeline/SingleThreaded/BusySpin", contains the text. --json prints one
+// JSON object per run for regression tracking.
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <disruptor/handler.hpp>
+#include <disruptor/tracing.h>
+
+using namespace disruptor;
+
+constexpr size_t kRingSize = 1 << 14;
+constexpr size_t kProducers = 3;
+
+struct Options {
+  int64_t events = 10000000L;
+  int64_t warmup = 1000000L;
+  int64_t latency_events = 100000L;
+  std::vector<int> cpus;
+  std::string filter;
+  bool json = false;
+
+  ThreadPlacement Placement(size_t thread) const {
+    ThreadPlacement placement;
+    if (!cpus.empty()) placement.cpus = {cpus[thread % cpus.size()]};
+    return placement;
+  }
+};
+
+struct Event {
+  int64_t value;
+  int64_t producer;
+};
+
+// Stage of a topology, the last stages acknowledge what they processed to
+// the producers.
+class StageHandler : public Handler<Event> {
+ public:
+  explicit StageHandler(std::atomic<int64_t>* acks = nullptr) : acks(acks) {}
+
+  virtual void process(const Event* pMD) noexcept override {
+    sum += pMD->value;
+    count.store(count.load(std::memory_order_relaxed) + 1,
+                std::memory_order_relaxed);
+    if (acks) acks[pMD->producer].store(pMD->value, std::memory_order_release);
+  }
+
+  std::atomic<int64_t>* acks;
+  std::atomic<int64_t> count{0};
+  int64_t sum = 0;
+};
+
+struct Result {
+  double ops_per_second = 0;
+  LatencyHistogram latency;
+};
+
+// Events processed by the last stages.
+inline int64_t Processed(const std::vector<StageHandler*>& terminals) {
+  int64_t processed = 0;
+  for (auto terminal : terminals) processed += terminal->count.load();
+  return processed;
+}
+
+inline void WaitUntil(const std::atomic<int64_t>& value, int64_t target) {
+  while (value.load(std::memory_order_acquire) < target) CpuRelax();
+}
+
+// Run the three phases of a single producer topology, publish(value) sends
+// an event.
+template <typename P>
+void MeasureSingleProducer(const Options& options, P publish,
+                           const std::vector<StageHandler*>& terminals,
+                           std::atomic<int64_t>* acks, Result& result) {
+  int64_t value = 0;
+  for (int64_t i = 0; i < options.warmup; i++) publish(value++);
+  while (Processed(terminals) < value) CpuRelax();
+
+  const int64_t first = value;
+  const auto start = std::chrono::steady_clock::now();
+  for (int64_t i = 0; i < options.events; i++) publish(value++);
+  while (Processed(terminals) < value) CpuRelax();
+  const auto stop = std::chrono::steady_clock::now();
+  result.ops_per_second =
+      (value - first) / std::chrono::duration<double>(stop - start).count();
+
+  for (int64_t i = 0; i < options.latency_events; i++) {
+    const uint64_t begin = TscClock::Now();
+    publish(value);
+    WaitUntil(acks[0], value++);
+    result.latency.Record(TscClock::ToNanoseconds(TscClock::Now() - begin));
+  }
+}
+
+enum class Topology { kUnicast, kPipeline, kDiamond };
+
+// 1P-1C, 1P-3C pipeline and 1P-3C diamond on a ParallelDistributor.
+template <typename C, typename W>
+void RunDistributor(const Options& options, Topology topology,
+                    Result& result) {
+  std::atomic<int64_t> acks[1];
+  acks[0].store(-1);
+  StageHandler first, second, last(acks);
+  std::unique_ptr<ParallelDistributor<Event, kRingSize, C, W>> distributor(
+      new ParallelDistributor<Event, kRingSize, C, W>());
+  switch (topology) {
+    case Topology::kUnicast:
+      distributor->addHandler(&last, options.Placement(1));
+      break;
+    case Topology::kPipeline:
+      distributor->addHandler(&first, options.Placement(1));
+      distributor->addHandlerAfter(&second, {&first}, options.Placement(2));
+      distributor->addHandlerAfter(&last, {&second}, options.Placement(3));
+      break;
+    case Topology::kDiamond:
+      distributor->addHandler(&first, options.Placement(1));
+      distributor->addHandler(&second, options.Placement(2));
+      distributor->addHandlerAfter(&last, {&first, &second},
+                                   options.Placement(3));
+      break;
+  }
+  distributor->start();
+
+  MeasureSingleProducer(options,
+                        [&distributor](int64_t value) {
+                          Event event{value, 0};
+                          distributor->distribute(&event);
+                        },
+                        {&last}, acks, result);
+  distributor->signal();
+  distributor->join();
+}
+
+// 1P-3C work pool, each event processed by one of the workers.
+template <typename C, typename W>
+void RunWorkPool(const Options& options, Result& result) {
+  std::atomic<int64_t> acks[1];
+  acks[0].store(-1);
+  StageHandler worker_1(acks), worker_2(acks), worker_3(acks);
+  StageHandler* workers[3] = {&worker_1, &worker_2, &worker_3};
+  std::unique_ptr<WorkerPoolDistributor<Event, kRingSize, C, W>> pool(
+      new WorkerPoolDistributor<Event, kRingSize, C, W>());
+  for (size_t i = 0; i < 3; i++)
+    pool->addHandler(workers[i], options.Placement(i + 1));
+  pool->start();
+
+  MeasureSingleProducer(options,
+                        [&pool](int64_t value) {
+                          Event event{value, 0};
+                          pool->distribute(&event);
+                        },
+                        {workers[0], workers[1], workers[2]}, acks, result);
+  pool->signal();
+  pool->join();
+}
+
+// 3P-1C, the producers share one ring through the claim strategy.
+template <typename C, typename W>
+void RunThreeToOne(const Options& options, Result& result) {
+  std::atomic<int64_t> acks[kProducers];
+  for (auto& ack : acks) ack.store(-1);
+  StageHandler consumer(acks);
+  std::unique_ptr<Sequencer<Event, kRingSize, C, W>> sequencer(
+      new Sequencer<Event, kRingSize, C, W>());
+  Sequence consumed;
+  sequencer->set_gating_sequences({&consumed});
+
+  std::atomic<bool> running(true);
+  std::thread consumer_thread([&]() {
+    options.Placement(kProducers).Apply();
+    std::unique_ptr<SequenceBarrier<W>> barrier(sequencer->NewBarrier({}));
+    int64_t next = kFirstSequenceValue;
+    while (running.load(std::memory_order_acquire)) {
+      const int64_t available =
+          barrier->WaitFor(next, std::chrono::microseconds(100));
+      if (available < next) continue;
+      for (; next <= available; next++) consumer.process(&(*sequencer)[next]);
+      consumed.set_sequence(available);
+    }
+  });
+
+  // every producer runs each phase, the others run theirs concurrently.
+  std::atomic<size_t> ready(0);
+  std::atomic<int64_t> start_ticks(0), stop_ticks(0);
+  std::vector<std::thread> producers;
+  const int64_t share = options.events / kProducers;
+  for (size_t p = 0; p < kProducers; p++) {
+    producers.emplace_back([&, p]() {
+      if (p > 0) options.Placement(p).Apply();
+      auto publish = [&](int64_t value) {
+        const int64_t sequence = sequencer->Claim();
+        (*sequencer)[sequence] = Event{value, static_cast<int64_t>(p)};
+        sequencer->Publish(sequence);
+      };
+      int64_t value = 0;
+      for (int64_t i = 0; i < options.warmup / int64_t(kProducers); i++)
+        publish(value++);
+      WaitUntil(acks[p], value - 1);
+
+      // the throughput phase starts once every producer is warm.
+      ready.fetch_add(1);
+      while (ready.load() < kProducers) CpuRelax();
+      if (p == 0) start_ticks.store(TscClock::Now());
+      for (int64_t i = 0; i < share; i++) publish(value++);
+      WaitUntil(acks[p], value - 1);
+      ready.fetch_add(1);
+      while (ready.load() < 2 * kProducers) CpuRelax();
+      if (p == 0) stop_ticks.store(TscClock::Now());
+
+      for (int64_t i = 0; i < options.latency_events / int64_t(kProducers);
+           i++) {
+        const uint64_t begin = TscClock::Now();
+        publish(value);
+        WaitUntil(acks[p], value++);
+        result.latency.Record(TscClock::ToNanoseconds(TscClock::Now() - begin));
+      }
+    });
+  }
+  for (auto& producer : producers) producer.join();
+  running.store(false, std::memory_order_release);
+  consumer_thread.join();
+
+  const double seconds =
+      TscClock::ToNanoseconds(stop_ticks.load() - start_ticks.load()) / 1e9;
+  result.ops_per_second = share * kProducers / seconds;
+}
+
+void Report(const Options& options, const std::string& name,
+            const Result& result) {
+  const LatencyHistogram& latency = result.latency;
+  char line[512];
+  if (options.json) {
+    std::snprintf(line, sizeof(line),
+                  "{\"name\": \"%s\", \"events\": %lld, \"ops_per_second\": "
+                  "%.0f, \"latency_events\": %llu, \"p50_ns\": %llu, "
+                  "\"p99_ns\": %llu, \"p99_9_ns\": %llu, \"max_ns\": %llu}",
+                  name.c_str(), static_cast<long long>(options.events),
+                  result.ops_per_second,
+                  static_cast<unsigned long long>(latency.count()),
+                  static_cast<unsigned long long>(latency.ValueAtPercentile(50)),
+                  static_cast<unsigned long long>(latency.ValueAtPercentile(99)),
+                  static_cast<unsigned long long>(
+                      latency.ValueAtPercentile(99.9)),
+                  static_cast<unsigned long long>(latency.max()));
+  } else {
+    std::snprintf(line, sizeof(line),
+                  "%-44s %10.2f M ops/s  p50 %8llu ns  p99 %8llu ns  "
+                  "p99.9 %8llu ns",
+                  name.c_str(), result.ops_per_second / 1e6,
+                  static_cast<unsigned long long>(latency.ValueAtPercentile(50)),
+                  static_cast<unsigned long long>(latency.ValueAtPercentile(99)),
+                  static_cast<unsigned long long>(
+                      latency.ValueAtPercentile(99.9)));
+  }
+  std::cout << line << std::endl;
+}
+
+template <typename F>
+void Run(const Options& options, const std::string& name, F f) {
+  if (name.find(options.filter) == std::string::npos) return;
+  Result result;
+  f(result);
+  Report(options, name, result);
+}
+
+template <typename C, typename W>
+void RunTopologies(const Options& options, const std::string& claim,
+                   const std::string& wait, bool multi_producer) {
+  const std::string suffix = "/" + claim + "/" + wait;
+  Run(options, "1p1c_unicast" + suffix, [&options](Result& result) {
+    RunDistributor<C, W>(options, Topology::kUnicast, result);
+  });
+  Run(options, "1p3c_pipeline" + suffix, [&options](Result& result) {
+    RunDistributor<C, W>(options, Topology::kPipeline, result);
+  });
+  Run(options, "1p3c_diamond" + suffix, [&options](Result& result) {
+    RunDistributor<C, W>(options, Topology::kDiamond, result);
+  });
+  Run(options, "1p3c_work_pool" + suffix, [&options](Result& result) {
+    RunWorkPool<C, W>(options, result);
+  });
+  // a single threaded claim strategy cannot be shared by producers.
+  if (multi_producer) {
+    Run(options, "3p1c_sequencer" + suffix, [&options](Result& result) {
+      RunThreeToOne<C, W>(options, result);
+    });
+  }
+}
+
+template <typename W>
+void RunClaimStrategies(const Options& options, const std::string& wait) {
+  RunTopologies<SingleThreadedStrategy<kRingSize>, W>(options, "SingleThreaded",
+                                                      wait, false);
+  RunTopologies<MultiThreadedStrategy<kRingSize>, W>(options, "MultiThreaded",
+                                                     wait, true);
+  RunTopologies<MultiProducerStrategy<kRingSize>, W>(options, "MultiProducer",
+                                                     wait, true);
+}
+
+std::vector<int> ParseCpus(const std::string& list) {
+  std::vector<int> cpus;
+  std::stringstream stream(list);
+  std::string cpu;
+  while (std::getline(stream, cpu, ',')) cpus.push_back(std::stoi(cpu));
+  return cpus;
+}
+
+int main(int argc, char** argv) {
+  Options options;
+  for (unsigned cpu = 0; cpu < std::thread::hardware_concurrency(); cpu++)
+    options.cpus.push_back(cpu);
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    const bool has_value = i + 1 < argc;
+    if (arg == "--events" && has_value) {
+      options.events = std::stoll(argv[++i]);
+    } else if (arg == "--warmup" && has_value) {
+      options.warmup = std::stoll(argv[++i]);
+    } else if (arg == "--latency-events" && has_value) {
+      options.latency_events = std::stoll(argv[++i]);
+    } else if (arg == "--cpus" && has_value) {
+      options.cpus = ParseCpus(argv[++i]);
+    } else if (arg == "--filter" && has_value) {
+      options.filter = argv[++i];
+    } else if (arg == "--json") {
+      options.json = true;
+    } else {
+      std::cerr << "usage: " << argv[0]
+                << " [--events N] [--warmup N] [--latency-events N]"
+                   " [--cpus 0,1,2,3] [--filter text] [--json]"
+                << std::endl;
+      return 1;
+    }
+  }
+  options.Placement(0).Apply();
+
+  RunClaimStrategies<BusySpinStrategy>(options, "BusySpin");
+  RunClaimStrategies<YieldingStrategy<>>(options, "Yielding");
+  RunClaimStrategies<SleepingStrategy<>>(options, "Sleeping");
+  RunClaimStrategies<BlockingStrategy>(options, "Blocking");
+  RunClaimStrategies<FutexBlockingStrategy<>>(options, "FutexBlocking");
+#ifdef __linux__
+  RunClaimStrategies<EventFdStrategy<>>(options, "EventFd");
+#endif
+  return 0;
+}
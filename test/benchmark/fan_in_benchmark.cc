@@ -0,0 +1,129 @@
+// Copyright (c) 2011-2015, Francois Saint-Jacques
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the disruptor-- nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL FRANCOIS SAINT-JACQUES BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Many producers to one consumer: a shared MultiThreadedStrategy ring,
+// where every claim contends on the same sequence, against a fan-in of one
+// single producer ring per producer.
+//
+// usage: fan_in_benchmark [events per producer]
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <disruptor/handler.hpp>
+
+using namespace disruptor;
+
+constexpr size_t kRingSize = 1 << 14;
+
+// Handler counting events, stands in for the consumer's work.
+class CountingHandler : public Handler<int64_t> {
+ public:
+  virtual void process(const int64_t* pMD) noexcept override {
+    sum += *pMD;
+    ++count;
+  }
+
+  int64_t sum = 0;
+  int64_t count = 0;
+};
+
+template <typename F>
+void MillionEventsPerSecond(const std::string& name, int64_t events, F f) {
+  const auto start = std::chrono::steady_clock::now();
+  f();
+  const auto stop = std::chrono::steady_clock::now();
+  const double seconds = std::chrono::duration<double>(stop - start).count();
+  std::cout << name << ": " << events / seconds / 1e6 << " M events/s"
+            << std::endl;
+}
+
+void SharedRing(size_t producers, int64_t iterations) {
+  Sequencer<int64_t, kRingSize, MultiThreadedStrategy<kRingSize>> sequencer;
+  Sequence consumer;
+  std::vector<Sequence*> gating = {&consumer};
+  sequencer.set_gating_sequences(gating);
+  std::unique_ptr<SequenceBarrier<kDefaultWaitStrategy>> barrier(
+      sequencer.NewBarrier({}));
+
+  std::vector<std::thread> threads;
+  for (size_t p = 0; p < producers; p++) {
+    threads.emplace_back([&sequencer, iterations]() {
+      for (int64_t i = 0; i < iterations; i++) {
+        const int64_t sequence = sequencer.Claim();
+        sequencer[sequence] = i;
+        sequencer.Publish(sequence);
+      }
+    });
+  }
+
+  CountingHandler handler;
+  const int64_t last = producers * iterations - 1;
+  int64_t next = kFirstSequenceValue;
+  while (next <= last) {
+    const int64_t available = barrier->WaitFor(next);
+    for (; next <= available; next++) handler.process(&sequencer[next]);
+    consumer.set_sequence(available);
+  }
+  for (auto& thread : threads) thread.join();
+}
+
+void FanIn(size_t producers, int64_t iterations) {
+  CountingHandler handler;
+  FanInDistributor<int64_t, kRingSize> distributor(producers);
+  distributor.addHandler(&handler);
+  distributor.start();
+
+  std::vector<std::thread> threads;
+  for (size_t p = 0; p < producers; p++) {
+    threads.emplace_back([&distributor, p, iterations]() {
+      auto& producer = distributor.producer(p);
+      for (int64_t i = 0; i < iterations; i++) producer.distribute(&i);
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  distributor.signal();
+  distributor.join();
+  if (handler.count != int64_t(producers) * iterations)
+    std::cerr << "FanInDistributor lost events" << std::endl;
+}
+
+int main(int argc, char** argv) {
+  const int64_t iterations = argc > 1 ? std::stoll(argv[1]) : 1000000L;
+
+  for (size_t producers : {2, 4, 8}) {
+    const int64_t events = producers * iterations;
+    const std::string suffix = " " + std::to_string(producers) + " producers";
+    MillionEventsPerSecond("MultiThreadedStrategy" + suffix, events,
+                           [=]() { SharedRing(producers, iterations); });
+    MillionEventsPerSecond("FanInDistributor" + suffix, events,
+                           [=]() { FanIn(producers, iterations); });
+  }
+  return 0;
+}
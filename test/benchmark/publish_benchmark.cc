@@ -0,0 +1,100 @@
+// Copyright (c) 2011-2015, Francois Saint-Jacques
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the disruptor-- nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL FRANCOIS SAINT-JACQUES BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Single publisher cost of Claim() + Publish(), comparing the release store
+// used by SingleThreadedStrategy with the fetch_add cursor update.
+//
+// usage: publish_benchmark [iterations]
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include <disruptor/sequencer.h>
+
+using namespace disruptor;
+
+constexpr size_t kRingSize = 1 << 16;
+
+// Publish path of the previous SingleThreadedStrategy, kept for reference.
+template <size_t N>
+class FetchAddStrategy : public SingleThreadedStrategy<N> {
+ public:
+  void Publish(const int64_t& sequence, Sequence& cursor, const size_t& delta) {
+    cursor.IncrementAndGet(delta);
+  }
+};
+
+template <typename F>
+double NanosecondsPerOp(const char* name, int64_t iterations, F f) {
+  const auto start = std::chrono::steady_clock::now();
+  f(iterations);
+  const auto stop = std::chrono::steady_clock::now();
+  const double ns_per_op =
+      std::chrono::duration<double, std::nano>(stop - start).count() /
+      iterations;
+  std::cout << name << ": " << ns_per_op << " ns/op" << std::endl;
+  return ns_per_op;
+}
+
+template <typename C>
+void ClaimAndPublish(int64_t iterations) {
+  Sequencer<int64_t, kRingSize, C> sequencer;
+  Sequence consumer;
+  std::vector<Sequence*> gating = {&consumer};
+  sequencer.set_gating_sequences(gating);
+
+  for (int64_t i = 0; i < iterations; i++) {
+    const int64_t sequence = sequencer.Claim();
+    sequencer[sequence] = i;
+    sequencer.Publish(sequence);
+    // stand-in for a consumer keeping up so the publisher never wraps.
+    consumer.set_sequence(sequence);
+  }
+}
+
+int main(int argc, char** argv) {
+  const int64_t iterations = argc > 1 ? std::stoll(argv[1]) : 100000000L;
+
+  Sequence sequence;
+  NanosecondsPerOp("Sequence::IncrementAndGet", iterations,
+                   [&sequence](int64_t n) {
+                     for (int64_t i = 0; i < n; i++) sequence.IncrementAndGet(1);
+                   });
+  NanosecondsPerOp("Sequence::set_sequence", iterations,
+                   [&sequence](int64_t n) {
+                     for (int64_t i = 0; i < n; i++) sequence.set_sequence(i);
+                   });
+
+  const double fetch_add = NanosecondsPerOp(
+      "Claim+Publish fetch_add", iterations,
+      ClaimAndPublish<FetchAddStrategy<kRingSize>>);
+  const double store = NanosecondsPerOp(
+      "Claim+Publish SingleThreadedStrategy", iterations,
+      ClaimAndPublish<SingleThreadedStrategy<kRingSize>>);
+
+  std::cout << "difference: " << fetch_add - store << " ns/op" << std::endl;
+  return 0;
+}
@@ -0,0 +1,309 @@
+// Copyright (c) 2011-2015, Francois Saint-Jacques
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the disruptor-- nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL FRANCOIS SAINT-JACQUES BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE BridgeTest
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <disruptor/bridge.hpp>
+
+#define RING_BUFFER_SIZE 64
+
+namespace disruptor {
+namespace test {
+
+typedef Sequencer<int64_t, RING_BUFFER_SIZE> RemoteSequencer;
+
+class CollectingHandler : public Handler<int64_t> {
+ public:
+  void process(const int64_t* event) noexcept override {
+    values.push_back(*event);
+  }
+  std::vector<int64_t> values;
+};
+
+// Drops the datagram starting at a bridge sequence, once.
+class DroppingUdpBridge : public UdpBridgeDistributor<int64_t> {
+ public:
+  DroppingUdpBridge(uint16_t port, const UdpBridgeOptions& options,
+                    int64_t drop)
+      : UdpBridgeDistributor<int64_t>("127.0.0.1", port, options),
+        drop_(drop) {}
+
+ protected:
+  void sendPackets(mmsghdr* batch, size_t packets) noexcept override {
+    for (size_t i = 0; i < packets; i++) {
+      const BridgePacketHeader* header = static_cast<const BridgePacketHeader*>(
+          batch[i].msg_hdr.msg_iov[0].iov_base);
+      if (header->first_sequence == drop_) {
+        drop_ = kInitialCursorValue;
+        continue;
+      }
+      UdpBridgeDistributor<int64_t>::sendPackets(batch + i, 1);
+    }
+  }
+
+ private:
+  int64_t drop_;
+};
+
+// Runs both ends of a bridge until done() or a few seconds passed.
+template <typename Done>
+bool Exchange(UdpBridgeReceiver<int64_t, RING_BUFFER_SIZE>* receiver,
+              UdpBridgeDistributor<int64_t>* sender, Done done) {
+  const auto stop = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (!done() && std::chrono::steady_clock::now() < stop) {
+    receiver->receive(std::chrono::milliseconds(5));
+    sender->serviceReplays();
+  }
+  return done();
+}
+
+UdpBridgeOptions SmallPackets(size_t history) {
+  UdpBridgeOptions options;
+  options.history = history;
+  options.events_per_packet = 4;
+  options.packets_per_call = 4;
+  options.replay_interval = std::chrono::microseconds(0);
+  return options;
+}
+
+BOOST_AUTO_TEST_SUITE(Bridge)
+
+BOOST_AUTO_TEST_CASE(ShouldBridgeDistributorsOverUdp) {
+  const int64_t events = 1000;
+  CollectingHandler collector;
+  ParallelDistributor<int64_t, 1024> remote;
+  remote.addHandler(&collector);
+  remote.start();
+  UdpBridgeReceiver<int64_t, 1024> receiver(remote.sequencer(), 0);
+  receiver.start();
+  {
+    std::unique_ptr<Connector<int64_t>> bridge(make_connector<int64_t>(
+        new UdpBridgeDistributor<int64_t>("127.0.0.1", receiver.port())));
+    ParallelDistributor<int64_t, RING_BUFFER_SIZE> local;
+    local.addHandler(bridge.get());
+    local.start();
+    for (int64_t i = 0; i < events; i++) local.distribute(&i);
+    local.signal();
+    local.join();
+  }
+  const auto stop = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (receiver.received() < events &&
+         std::chrono::steady_clock::now() < stop) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  receiver.stop();
+  // the receiver published past the distributor, which did not claim them.
+  remote.signal(remote.sequencer().GetCursor());
+  remote.join();
+
+  BOOST_CHECK_EQUAL(receiver.expected(), events);
+  BOOST_CHECK_EQUAL(receiver.lost(), 0);
+  BOOST_REQUIRE_EQUAL(collector.values.size(), events);
+  for (int64_t i = 0; i < events; i++) {
+    BOOST_CHECK_EQUAL(collector.values[i], i);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(ShouldReplayDroppedDatagrams) {
+  Sequence consumer;
+  RemoteSequencer sequencer;
+  sequencer.set_gating_sequences({&consumer});
+  UdpBridgeReceiver<int64_t, RING_BUFFER_SIZE> receiver(sequencer, 0);
+  DroppingUdpBridge sender(receiver.port(), SmallPackets(64), 4);
+  std::vector<int64_t> events(16);
+  for (int64_t i = 0; i < 16; i++) events[i] = 100 + i;
+  sender.distributeBatch(events.data(), events.size());
+
+  BOOST_REQUIRE(Exchange(&receiver, &sender,
+                         [&] { return receiver.received() == 16; }));
+  BOOST_CHECK_EQUAL(sequencer.GetCursor(), 15);
+  for (int64_t i = 0; i < 16; i++) BOOST_CHECK_EQUAL(sequencer[i], 100 + i);
+  BOOST_CHECK_GE(receiver.replayRequests(), 1);
+  BOOST_CHECK_GE(sender.replayed(), 12);
+  BOOST_CHECK_EQUAL(receiver.lost(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(ShouldSkipEventsOutOfTheHistory) {
+  Sequence consumer;
+  RemoteSequencer sequencer;
+  sequencer.set_gating_sequences({&consumer});
+  UdpBridgeReceiver<int64_t, RING_BUFFER_SIZE> receiver(sequencer, 0);
+  DroppingUdpBridge sender(receiver.port(), SmallPackets(16), 4);
+  std::vector<int64_t> events(32);
+  for (int64_t i = 0; i < 32; i++) events[i] = i;
+  sender.distributeBatch(events.data(), 16);
+  // the dropped datagram is overwritten before the receiver asks for it
+  sender.distributeBatch(events.data() + 16, 16);
+
+  BOOST_REQUIRE(Exchange(&receiver, &sender,
+                         [&] { return receiver.expected() == 32; }));
+  BOOST_CHECK_EQUAL(receiver.lost(), 12);
+  BOOST_CHECK_EQUAL(receiver.received(), 20);
+  for (int64_t i = 0; i < 4; i++) BOOST_CHECK_EQUAL(sequencer[i], i);
+  for (int64_t i = 4; i < 20; i++) BOOST_CHECK_EQUAL(sequencer[i], i + 12);
+}
+
+BOOST_AUTO_TEST_CASE(ShouldIgnoreDuplicateDatagrams) {
+  Sequence consumer;
+  RemoteSequencer sequencer;
+  sequencer.set_gating_sequences({&consumer});
+  UdpBridgeReceiver<int64_t, RING_BUFFER_SIZE> receiver(sequencer, 0);
+  UdpBridgeDistributor<int64_t> sender("127.0.0.1", receiver.port(),
+                                       SmallPackets(64));
+  std::vector<int64_t> events(8, 7);
+  sender.distributeBatch(events.data(), events.size());
+  BOOST_REQUIRE(Exchange(&receiver, &sender,
+                         [&] { return receiver.received() == 8; }));
+
+  // the same datagram again, as a replay asked by another receiver
+  struct {
+    BridgePacketHeader header;
+    int64_t events[8];
+  } packet;
+  packet.header =
+      bridgeHeader(BridgePacketKind::Data, sizeof(int64_t), 0, 8);
+  for (int64_t i = 0; i < 8; i++) packet.events[i] = -1;
+  const sockaddr_in to = bridgeAddress("127.0.0.1", receiver.port());
+  const int fd = socket(AF_INET, SOCK_DGRAM, 0);
+  sendto(fd, &packet, sizeof(packet), 0,
+         reinterpret_cast<const sockaddr*>(&to), sizeof(to));
+  close(fd);
+  BOOST_REQUIRE(Exchange(&receiver, &sender,
+                         [&] { return receiver.discarded() == 1; }));
+  BOOST_CHECK_EQUAL(receiver.received(), 8);
+  BOOST_CHECK_EQUAL(sequencer.GetCursor(), 7);
+  for (int64_t i = 0; i < 8; i++) BOOST_CHECK_EQUAL(sequencer[i], 7);
+}
+
+BOOST_AUTO_TEST_CASE(ShouldRejectBadOptions) {
+  BOOST_CHECK_THROW(UdpBridgeDistributor<int64_t>("localhost", 1),
+                    std::invalid_argument);
+  BOOST_CHECK_THROW(UdpBridgeDistributor<int64_t>("127.0.0.1", 1,
+                                                  SmallPackets(24)),
+                    std::invalid_argument);
+  BOOST_CHECK_THROW(UdpBridgeDistributor<int64_t>("127.0.0.1", 1,
+                                                  SmallPackets(8)),
+                    std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(ShouldBridgeBatchesOverTcp) {
+  Sequence consumer;
+  RemoteSequencer sequencer;
+  sequencer.set_gating_sequences({&consumer});
+  TcpBridgeReceiver<int64_t, RING_BUFFER_SIZE> receiver(sequencer, 0);
+  receiver.start();
+  {
+    TcpBridgeDistributor<int64_t> sender("127.0.0.1", receiver.port(), 8);
+    std::vector<int64_t> events(20);
+    for (int64_t i = 0; i < 20; i++) events[i] = i;
+    sender.distributeBatch(events.data(), events.size());
+    for (int64_t i = 20; i < 30; i++) sender.distributeEvent(&i, i, i == 29);
+    BOOST_CHECK_EQUAL(sender.sent(), 30);
+    BOOST_CHECK_EQUAL(sender.sendErrors(), 0);
+  }
+  const auto stop = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (receiver.received() < 30 && std::chrono::steady_clock::now() < stop) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  receiver.stop();
+
+  BOOST_CHECK_EQUAL(receiver.expected(), 30);
+  BOOST_CHECK_EQUAL(receiver.lost(), 0);
+  BOOST_REQUIRE_EQUAL(sequencer.GetCursor(), 29);
+  for (int64_t i = 0; i < 30; i++) BOOST_CHECK_EQUAL(sequencer[i], i);
+}
+
+BOOST_AUTO_TEST_CASE(ShouldNotPublishTcpBatchesCutShort) {
+  Sequence consumer;
+  RemoteSequencer sequencer;
+  sequencer.set_gating_sequences({&consumer});
+  TcpBridgeReceiver<int64_t, RING_BUFFER_SIZE> receiver(sequencer, 0);
+  receiver.start();
+
+  // a batch announcing 3 rings of events, the connection closing after 1.5.
+  struct {
+    BridgePacketHeader header;
+    int64_t events[RING_BUFFER_SIZE + RING_BUFFER_SIZE / 2];
+  } packet;
+  packet.header = bridgeHeader(BridgePacketKind::Data, sizeof(int64_t), 0,
+                               3 * RING_BUFFER_SIZE);
+  for (int64_t i = 0; i < RING_BUFFER_SIZE + RING_BUFFER_SIZE / 2; i++)
+    packet.events[i] = i;
+  const sockaddr_in to = bridgeAddress("127.0.0.1", receiver.port());
+  const int fd = socket(AF_INET, SOCK_STREAM, 0);
+  BOOST_REQUIRE_EQUAL(
+      connect(fd, reinterpret_cast<const sockaddr*>(&to), sizeof(to)), 0);
+  BOOST_REQUIRE_EQUAL(send(fd, &packet, sizeof(packet), 0), sizeof(packet));
+  close(fd);
+
+  // the next connection's batch is published from the first slot.
+  {
+    TcpBridgeDistributor<int64_t> sender("127.0.0.1", receiver.port());
+    const int64_t event = 42;
+    sender.distribute(&event);
+  }
+  const auto stop = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (receiver.received() < 1 && std::chrono::steady_clock::now() < stop) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  receiver.stop();
+
+  BOOST_CHECK_EQUAL(receiver.received(), 1);
+  BOOST_REQUIRE_EQUAL(sequencer.GetCursor(), 0);
+  BOOST_CHECK_EQUAL(sequencer[0], 42);
+}
+
+BOOST_AUTO_TEST_CASE(ShouldCountTcpSendsToAClosedReceiver) {
+  const int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in local = bridgeAddress("127.0.0.1", 0);
+  BOOST_REQUIRE_EQUAL(
+      bind(listen_fd, reinterpret_cast<sockaddr*>(&local), sizeof(local)), 0);
+  BOOST_REQUIRE_EQUAL(listen(listen_fd, 1), 0);
+  TcpBridgeDistributor<int64_t> sender("127.0.0.1", bridgePort(listen_fd));
+  close(accept(listen_fd, nullptr, nullptr));
+  close(listen_fd);
+
+  // the first send is reset by the receiver, the later ones must not raise
+  // SIGPIPE.
+  for (int64_t i = 0; i < 10 && sender.sendErrors() == 0; i++) {
+    sender.distribute(&i);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  BOOST_CHECK_GT(sender.sendErrors(), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+};  // namespace test
+};  // namespace disruptor
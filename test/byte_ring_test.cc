@@ -0,0 +1,173 @@
+// Copyright (c) 2011-2015, Francois Saint-Jacques
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the disruptor-- nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL FRANCOIS SAINT-JACQUES BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE ByteRingTest
+
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <disruptor/byte_ring.h>
+
+#define BYTE_RING_SIZE 64
+
+namespace disruptor {
+namespace test {
+
+typedef ByteSequencer<BYTE_RING_SIZE, SingleThreadedStrategy<BYTE_RING_SIZE>,
+                      kDefaultWaitStrategy>
+    SmallByteSequencer;
+
+struct ByteSequencerFixture {
+  ByteSequencerFixture() { sequencer.set_gating_sequences({&consumer}); }
+
+  void Publish(const std::string& message) {
+    ByteClaim claim = sequencer.Claim(message.size());
+    std::memcpy(claim.data, message.data(), message.size());
+    sequencer.Publish(claim);
+  }
+
+  std::vector<std::string> Consume() {
+    std::vector<std::string> messages;
+    consumer.set_sequence(sequencer.ForEach(
+        consumer.sequence() + 1, sequencer.GetCursor(),
+        [&messages](const ByteRecord& record, bool) {
+          messages.emplace_back(reinterpret_cast<const char*>(record.data),
+                                record.size);
+        }));
+    return messages;
+  }
+
+  SmallByteSequencer sequencer;
+  Sequence consumer;
+};
+
+BOOST_FIXTURE_TEST_SUITE(ByteSequencerBasic, ByteSequencerFixture)
+
+BOOST_AUTO_TEST_CASE(ShouldClaimAlignedRecords) {
+  BOOST_CHECK_EQUAL(SmallByteSequencer::RecordSize(1), 16);
+  BOOST_CHECK_EQUAL(SmallByteSequencer::RecordSize(8), 16);
+  BOOST_CHECK_EQUAL(SmallByteSequencer::RecordSize(9), 24);
+
+  Publish("abc");
+  BOOST_CHECK_EQUAL(sequencer.GetCursor(), 15L);
+  Publish("defghijkl");
+  BOOST_CHECK_EQUAL(sequencer.GetCursor(), 39L);
+}
+
+BOOST_AUTO_TEST_CASE(ShouldVisitRecordsInBatches) {
+  Publish("abc");
+  Publish("defghijkl");
+  std::vector<bool> ends;
+  const int64_t last = sequencer.ForEach(
+      0, sequencer.GetCursor(),
+      [&ends](const ByteRecord&, bool end_of_batch) {
+        ends.push_back(end_of_batch);
+      });
+  BOOST_CHECK_EQUAL(last, sequencer.GetCursor());
+  BOOST_CHECK(ends == std::vector<bool>({false, true}));
+}
+
+BOOST_AUTO_TEST_CASE(ShouldPadRecordsAtWrap) {
+  Publish("0123456789abcdef");  // 24 bytes
+  Publish("0123456789abcdef");  // 48 bytes
+  BOOST_CHECK_EQUAL(Consume().size(), 2);
+
+  // 16 bytes left before the end of the ring: the 24 bytes first claimed
+  // are published as padding and the record is claimed after them.
+  ByteClaim claim = sequencer.Claim(16);
+  BOOST_CHECK_EQUAL(claim.first, 72L);
+  BOOST_CHECK_EQUAL(claim.last, 95L);
+  BOOST_CHECK_EQUAL(sequencer.GetCursor(), 71L);
+}
+
+BOOST_AUTO_TEST_CASE(ShouldSkipPaddingWhenConsuming) {
+  Publish("0123456789abcdef");
+  Publish("0123456789abcdef");
+  Consume();
+  Publish("wrapped record!!");
+  Publish("x");
+  std::vector<std::string> messages = Consume();
+  BOOST_REQUIRE_EQUAL(messages.size(), 2);
+  BOOST_CHECK_EQUAL(messages[0], "wrapped record!!");
+  BOOST_CHECK_EQUAL(messages[1], "x");
+  BOOST_CHECK_EQUAL(consumer.sequence(), sequencer.GetCursor());
+}
+
+BOOST_AUTO_TEST_CASE(TryClaimShouldFailWhenFull) {
+  Publish("0123456789abcdef");
+  Publish("0123456789abcdef");
+  BOOST_CHECK(sequencer.TryClaim(16).empty());
+  Consume();
+  BOOST_CHECK(!sequencer.TryClaim(16).empty());
+}
+
+BOOST_AUTO_TEST_CASE(ShouldRejectRecordsOutOfBounds) {
+  BOOST_CHECK_EQUAL(SmallByteSequencer::max_length(), 24);
+  BOOST_CHECK_THROW(sequencer.Claim(0), std::invalid_argument);
+  BOOST_CHECK_THROW(sequencer.Claim(25), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_CASE(ShouldStreamVariableLengthRecords) {
+  const size_t records = 2000;
+  ByteSequencer<256, MultiThreadedStrategy<256>, kDefaultWaitStrategy>
+      sequencer;
+  Sequence consumer;
+  sequencer.set_gating_sequences({&consumer});
+  std::unique_ptr<SequenceBarrier<>> barrier(sequencer.NewBarrier({}));
+
+  std::vector<size_t> lengths;
+  std::thread reader([&]() {
+    while (lengths.size() < records) {
+      const int64_t available = barrier->WaitFor(consumer.sequence() + 1);
+      consumer.set_sequence(sequencer.ForEach(
+          consumer.sequence() + 1, available,
+          [&lengths](const ByteRecord& record, bool) {
+            for (size_t i = 0; i < record.size; i++)
+              BOOST_CHECK_EQUAL(record.data[i], record.size);
+            lengths.push_back(record.size);
+          }));
+    }
+  });
+  for (size_t i = 0; i < records; i++) {
+    const size_t length = 1 + i % 100;
+    ByteClaim claim = sequencer.Claim(length);
+    std::memset(claim.data, static_cast<int>(length), length);
+    sequencer.Publish(claim);
+  }
+  reader.join();
+
+  BOOST_REQUIRE_EQUAL(lengths.size(), records);
+  for (size_t i = 0; i < records; i++) BOOST_CHECK_EQUAL(lengths[i], 1 + i % 100);
+}
+
+};  // namespace test
+};  // namespace disruptor
@@ -93,6 +93,40 @@ BOOST_AUTO_TEST_CASE(HasAvailableCapacity) {
                     sequence_1.IncrementAndGet(RING_BUFFER_SIZE));
 }
 
+BOOST_AUTO_TEST_CASE(TryIncrementAndGet) {
+  auto one_dependents = oneDependents();
+
+  BOOST_CHECK_EQUAL(strategy.TryIncrementAndGet(one_dependents,
+                                                RING_BUFFER_SIZE - 1),
+                    kInitialCursorValue + RING_BUFFER_SIZE - 1);
+  // not enough room for two, nothing gets claimed
+  BOOST_CHECK_EQUAL(strategy.TryIncrementAndGet(one_dependents, 2),
+                    kInsufficientCapacitySignal);
+  BOOST_CHECK_EQUAL(strategy.TryIncrementAndGet(one_dependents),
+                    kInitialCursorValue + RING_BUFFER_SIZE);
+  BOOST_CHECK_EQUAL(strategy.TryIncrementAndGet(one_dependents),
+                    kInsufficientCapacitySignal);
+
+  // advance late consumers
+  sequence_1.IncrementAndGet(1L);
+  BOOST_CHECK_EQUAL(strategy.TryIncrementAndGet(one_dependents),
+                    kInitialCursorValue + RING_BUFFER_SIZE + 1L);
+}
+
+BOOST_AUTO_TEST_CASE(RuntimeSize) {
+  auto one_dependents = oneDependents();
+  disruptor::SingleThreadedStrategy<kRuntimeRingBufferSize> runtime_strategy(
+      RING_BUFFER_SIZE);
+  BOOST_CHECK_EQUAL(runtime_strategy.size(), RING_BUFFER_SIZE);
+
+  runtime_strategy.IncrementAndGet(one_dependents, RING_BUFFER_SIZE);
+  BOOST_CHECK_EQUAL(runtime_strategy.HasAvailableCapacity(one_dependents),
+                    false);
+  sequence_1.IncrementAndGet(1L);
+  BOOST_CHECK_EQUAL(runtime_strategy.HasAvailableCapacity(one_dependents),
+                    true);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 using MultiThreadedFixture =
@@ -157,6 +191,26 @@ BOOST_AUTO_TEST_CASE(HasAvailableCapacity) {
                     sequence_1.IncrementAndGet(RING_BUFFER_SIZE));
 }
 
+BOOST_AUTO_TEST_CASE(TryIncrementAndGet) {
+  auto one_dependents = oneDependents();
+
+  BOOST_CHECK_EQUAL(strategy.TryIncrementAndGet(one_dependents,
+                                                RING_BUFFER_SIZE - 1),
+                    kInitialCursorValue + RING_BUFFER_SIZE - 1);
+  // not enough room for two, nothing gets claimed
+  BOOST_CHECK_EQUAL(strategy.TryIncrementAndGet(one_dependents, 2),
+                    kInsufficientCapacitySignal);
+  BOOST_CHECK_EQUAL(strategy.TryIncrementAndGet(one_dependents),
+                    kInitialCursorValue + RING_BUFFER_SIZE);
+  BOOST_CHECK_EQUAL(strategy.TryIncrementAndGet(one_dependents),
+                    kInsufficientCapacitySignal);
+
+  // advance late consumers
+  sequence_1.IncrementAndGet(1L);
+  BOOST_CHECK_EQUAL(strategy.TryIncrementAndGet(one_dependents),
+                    kInitialCursorValue + RING_BUFFER_SIZE + 1L);
+}
+
 BOOST_AUTO_TEST_CASE(SynchronizePublishingShouldBlockEagerThreads) {
   std::atomic<bool> running_1(true), running_2(true), running_3(true);
   std::atomic<bool> wait_1(true), wait_2(true), wait_3(true);
@@ -248,5 +302,111 @@ BOOST_AUTO_TEST_CASE(SynchronizePublishingShouldBlockEagerThreads) {
 
 BOOST_AUTO_TEST_SUITE_END()
 
+using MultiProducerFixture =
+    ClaimStrategyFixture<MultiProducerStrategy<RING_BUFFER_SIZE>>;
+BOOST_FIXTURE_TEST_SUITE(MultiProducerStrategy, MultiProducerFixture)
+
+BOOST_AUTO_TEST_CASE(DualIncrementAndGet) {
+  std::atomic<int64_t> return_1(kInitialCursorValue);
+  std::atomic<int64_t> return_2(kInitialCursorValue);
+
+  std::thread([this, &return_1]() {
+    return_1 = strategy.IncrementAndGet(empty_dependents);
+  }).join();
+  std::thread([this, &return_2]() {
+    return_2 = strategy.IncrementAndGet(empty_dependents, 2);
+  }).join();
+
+  BOOST_CHECK_EQUAL(return_1, kFirstSequenceValue);
+  BOOST_CHECK_EQUAL(return_2, kFirstSequenceValue + 2L);
+}
+
+BOOST_AUTO_TEST_CASE(HasAvailableCapacity) {
+  auto one_dependents = oneDependents();
+
+  int64_t return_value =
+      strategy.IncrementAndGet(one_dependents, RING_BUFFER_SIZE);
+  BOOST_CHECK_EQUAL(return_value, kInitialCursorValue + RING_BUFFER_SIZE);
+  BOOST_CHECK_EQUAL(strategy.HasAvailableCapacity(one_dependents), false);
+
+  // advance late consumers
+  sequence_1.IncrementAndGet(1L);
+  BOOST_CHECK_EQUAL(strategy.HasAvailableCapacity(one_dependents), true);
+
+  // only one slot free
+  BOOST_CHECK_EQUAL(strategy.IncrementAndGet(one_dependents),
+                    return_value + 1L);
+}
+
+BOOST_AUTO_TEST_CASE(TryIncrementAndGet) {
+  auto one_dependents = oneDependents();
+
+  BOOST_CHECK_EQUAL(strategy.TryIncrementAndGet(one_dependents,
+                                                RING_BUFFER_SIZE - 1),
+                    kInitialCursorValue + RING_BUFFER_SIZE - 1);
+  // not enough room for two, nothing gets claimed
+  BOOST_CHECK_EQUAL(strategy.TryIncrementAndGet(one_dependents, 2),
+                    kInsufficientCapacitySignal);
+  BOOST_CHECK_EQUAL(strategy.TryIncrementAndGet(one_dependents),
+                    kInitialCursorValue + RING_BUFFER_SIZE);
+  BOOST_CHECK_EQUAL(strategy.TryIncrementAndGet(one_dependents),
+                    kInsufficientCapacitySignal);
+
+  // advance late consumers
+  sequence_1.IncrementAndGet(1L);
+  BOOST_CHECK_EQUAL(strategy.TryIncrementAndGet(one_dependents),
+                    kInitialCursorValue + RING_BUFFER_SIZE + 1L);
+}
+
+BOOST_AUTO_TEST_CASE(PublishShouldOnlyAdvanceContiguousSequences) {
+  strategy.IncrementAndGet(empty_dependents, 3);
+
+  // publishing out of order does not expose the unpublished gap
+  strategy.Publish(kFirstSequenceValue + 2, cursor, 1);
+  BOOST_CHECK(strategy.IsAvailable(kFirstSequenceValue + 2));
+  BOOST_CHECK_EQUAL(cursor.sequence(), kInitialCursorValue);
+
+  strategy.Publish(kFirstSequenceValue + 1, cursor, 1);
+  BOOST_CHECK_EQUAL(cursor.sequence(), kInitialCursorValue);
+
+  // filling the gap moves the cursor over every published sequence
+  strategy.Publish(kFirstSequenceValue, cursor, 1);
+  BOOST_CHECK_EQUAL(cursor.sequence(), kFirstSequenceValue + 2);
+}
+
+BOOST_AUTO_TEST_CASE(PublishShouldNotBlockEagerThreads) {
+  strategy.IncrementAndGet(empty_dependents);
+  const int64_t claimed = strategy.IncrementAndGet(empty_dependents, 2);
+
+  // the first claimed sequence is never published, yet the batch publisher
+  // must not wait on it.
+  std::thread([this, claimed]() {
+    strategy.Publish(claimed, cursor, 2);
+  }).join();
+  BOOST_CHECK_EQUAL(cursor.sequence(), kInitialCursorValue);
+  BOOST_CHECK(!strategy.IsAvailable(kFirstSequenceValue));
+  BOOST_CHECK(strategy.IsAvailable(claimed - 1));
+  BOOST_CHECK(strategy.IsAvailable(claimed));
+
+  strategy.Publish(kFirstSequenceValue, cursor, 1);
+  BOOST_CHECK_EQUAL(cursor.sequence(), claimed);
+}
+
+BOOST_AUTO_TEST_CASE(IsAvailableShouldNotMatchPreviousLap) {
+  auto one_dependents = oneDependents();
+
+  const int64_t claimed =
+      strategy.IncrementAndGet(one_dependents, RING_BUFFER_SIZE);
+  strategy.Publish(claimed, cursor, RING_BUFFER_SIZE);
+  BOOST_CHECK_EQUAL(cursor.sequence(), claimed);
+
+  sequence_1.set_sequence(claimed);
+  const int64_t next = strategy.IncrementAndGet(one_dependents);
+  BOOST_CHECK(!strategy.IsAvailable(next));
+  BOOST_CHECK(strategy.IsAvailable(next - RING_BUFFER_SIZE));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
 };  // namespace test
 };  // namespace disruptor
@@ -0,0 +1,125 @@
+// Copyright (c) 2011-2015, Francois Saint-Jacques
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the disruptor-- nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL FRANCOIS SAINT-JACQUES BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE CoroutineTest
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <disruptor/coroutine.h>
+#include <disruptor/sequencer.h>
+
+#define RING_BUFFER_SIZE 64
+
+namespace disruptor {
+namespace test {
+
+template <typename W>
+using TestSequencer =
+    Sequencer<int64_t, RING_BUFFER_SIZE, SingleThreadedStrategy<RING_BUFFER_SIZE>,
+              W>;
+
+// Sums the events up to last, one batch per resumption.
+template <typename W>
+ConsumerTask Consume(TestSequencer<W>& sequencer, SequenceBarrier<W>& barrier,
+                     Sequence& sequence, int64_t last, int64_t& sum,
+                     int64_t& batches) {
+  int64_t next = sequence.sequence() + 1;
+  while (next <= last) {
+    const int64_t available = co_await NextBatch(barrier, next);
+    if (available == kAlertedSignal) co_return;
+    for (; next <= available; ++next) sum += sequencer[next];
+    sequence.set_sequence(available);
+    batches++;
+  }
+}
+
+template <typename W>
+void ShouldMultiplexConsumers() {
+  const size_t consumers = 100;
+  const int64_t events = 10 * RING_BUFFER_SIZE;
+  TestSequencer<W> sequencer;
+  std::vector<Sequence> sequences(consumers);
+  std::vector<Sequence*> gating;
+  for (auto& sequence : sequences) gating.push_back(&sequence);
+  sequencer.set_gating_sequences(gating);
+  // the consumers share a barrier, the scheduler parks on it once.
+  std::unique_ptr<SequenceBarrier<W> > barrier(sequencer.NewBarrier({}));
+
+  std::vector<int64_t> sums(consumers, 0), batches(consumers, 0);
+  CoroutineScheduler<W> scheduler;
+  for (size_t i = 0; i < consumers; i++)
+    scheduler.Spawn(Consume<W>(sequencer, *barrier, sequences[i], events - 1,
+                               sums[i], batches[i]));
+
+  std::thread producer([&sequencer, events]() {
+    for (int64_t i = 0; i < events; i++) {
+      const int64_t sequence = sequencer.Claim();
+      sequencer[sequence] = i;
+      sequencer.Publish(sequence);
+      if (i % 100 == 0) std::this_thread::yield();
+    }
+  });
+  scheduler.Run();
+  producer.join();
+
+  for (size_t i = 0; i < consumers; i++) {
+    BOOST_CHECK_EQUAL(sums[i], events * (events - 1) / 2);
+    BOOST_CHECK_LE(batches[i], events);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE(Coroutine)
+
+BOOST_AUTO_TEST_CASE(ShouldMultiplexConsumersWithBlockingStrategy) {
+  ShouldMultiplexConsumers<BlockingStrategy>();
+}
+
+BOOST_AUTO_TEST_CASE(ShouldMultiplexConsumersWithEventFdStrategy) {
+  ShouldMultiplexConsumers<EventFdStrategy<> >();
+}
+
+BOOST_AUTO_TEST_CASE(ShouldResumeOnAlert) {
+  TestSequencer<BlockingStrategy> sequencer;
+  Sequence sequence;
+  std::unique_ptr<SequenceBarrier<BlockingStrategy> > barrier(
+      sequencer.NewBarrier({}));
+  int64_t sum = 0, batches = 0;
+  CoroutineScheduler<BlockingStrategy> scheduler;
+  scheduler.Spawn(Consume<BlockingStrategy>(sequencer, *barrier, sequence, 10,
+                                            sum, batches));
+  barrier->set_alerted(true);
+  scheduler.Run();
+  BOOST_CHECK_EQUAL(batches, 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+};  // namespace test
+};  // namespace disruptor
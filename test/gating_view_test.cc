@@ -0,0 +1,106 @@
+// Copyright (c) 2011-2015, Francois Saint-Jacques
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the disruptor-- nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL FRANCOIS SAINT-JACQUES BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE GatingViewTest
+
+#include <boost/test/unit_test.hpp>
+
+#include <disruptor/gating_view.h>
+
+namespace disruptor {
+namespace test {
+
+struct GatingViewFixture {
+  Sequence cursor;
+  Sequence sequence_1;
+  Sequence sequence_2;
+  Sequence sequence_3;
+
+  std::vector<Sequence*> allDependents() {
+    std::vector<Sequence*> d = {&sequence_1, &sequence_2, &sequence_3};
+    return d;
+  }
+};
+
+BOOST_FIXTURE_TEST_SUITE(GatingView, GatingViewFixture)
+
+BOOST_AUTO_TEST_CASE(CursorViewShouldFollowCursor) {
+  CursorGatingView view(cursor);
+  BOOST_CHECK_EQUAL(view.Get(kFirstSequenceValue), kInitialCursorValue);
+
+  cursor.IncrementAndGet(2L);
+  BOOST_CHECK_EQUAL(view.Get(kFirstSequenceValue), kFirstSequenceValue + 1L);
+}
+
+BOOST_AUTO_TEST_CASE(SingleViewShouldCacheDependent) {
+  SingleGatingView view(cursor, {&sequence_1});
+  BOOST_CHECK_EQUAL(view.Get(kFirstSequenceValue), kInitialCursorValue);
+
+  sequence_1.set_sequence(4L);
+  BOOST_CHECK_EQUAL(view.Get(kFirstSequenceValue), 4L);
+
+  // the cached value covers the request, the dependent is not read again.
+  sequence_1.set_sequence(5L);
+  BOOST_CHECK_EQUAL(view.Get(2L), 4L);
+  BOOST_CHECK_EQUAL(view.Get(5L), 5L);
+}
+
+BOOST_AUTO_TEST_CASE(MultiViewShouldReturnMinimum) {
+  MultiGatingView view(cursor, allDependents());
+  BOOST_CHECK_EQUAL(view.Get(kFirstSequenceValue), kInitialCursorValue);
+
+  sequence_1.set_sequence(3L);
+  sequence_2.set_sequence(1L);
+  sequence_3.set_sequence(2L);
+  BOOST_CHECK_EQUAL(view.Get(kFirstSequenceValue), 1L);
+
+  // served from the cache
+  sequence_2.set_sequence(6L);
+  BOOST_CHECK_EQUAL(view.Get(1L), 1L);
+  BOOST_CHECK_EQUAL(view.Get(2L), 2L);
+}
+
+BOOST_AUTO_TEST_CASE(MultiViewShouldNotOverstateMinimum) {
+  MultiGatingView view(cursor, allDependents());
+  sequence_1.set_sequence(1L);
+  sequence_2.set_sequence(1L);
+  sequence_3.set_sequence(1L);
+  BOOST_CHECK_EQUAL(view.Get(1L), 1L);
+
+  // a partial scan stops on the laggard and keeps the previous minimum.
+  sequence_1.set_sequence(8L);
+  sequence_2.set_sequence(2L);
+  BOOST_CHECK_EQUAL(view.Get(3L), 1L);
+
+  sequence_2.set_sequence(9L);
+  sequence_3.set_sequence(7L);
+  BOOST_CHECK_EQUAL(view.Get(3L), 7L);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+};  // namespace test
+};  // namespace disruptor
@@ -0,0 +1,763 @@
+// Copyright (c) 2011-2015, Francois Saint-Jacques
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the disruptor-- nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL FRANCOIS SAINT-JACQUES BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE HandlerTest
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <disruptor/handler.hpp>
+
+#define RING_BUFFER_SIZE 8
+
+namespace disruptor {
+namespace test {
+
+// Records every event it receives along with the batch boundaries.
+class RecordingHandler : public Handler<int64_t> {
+ public:
+  virtual void process(const int64_t* pMD) noexcept override {
+    values.push_back(*pMD);
+  }
+  virtual void processEvent(const int64_t* pMD, int64_t sequence,
+                            bool end_of_batch) noexcept override {
+    process(pMD);
+    sequences.push_back(sequence);
+    if (end_of_batch) batch_ends.push_back(sequence);
+  }
+
+  std::vector<int64_t> values;
+  std::vector<int64_t> sequences;
+  std::vector<int64_t> batch_ends;
+};
+
+// Holds on to the first event until released, so the ring fills up.
+class StallingHandler : public RecordingHandler {
+ public:
+  virtual void process(const int64_t* pMD) noexcept override {
+    entered = true;
+    while (stalled.load()) std::this_thread::yield();
+    RecordingHandler::process(pMD);
+  }
+
+  std::atomic<bool> stalled{true};
+  std::atomic<bool> entered{false};
+};
+
+// Publishes how far it got and checks its upstream stages got further.
+class StageHandler : public Handler<int64_t> {
+ public:
+  explicit StageHandler(std::vector<StageHandler*> upstreams = {})
+      : upstreams(upstreams) {}
+
+  virtual void process(const int64_t* pMD) noexcept override {
+    for (auto upstream : upstreams)
+      if (upstream->processed.load() < *pMD) out_of_order++;
+    processed.store(*pMD);
+  }
+
+  std::vector<StageHandler*> upstreams;
+  std::atomic<int64_t> processed{-1};
+  int64_t out_of_order = 0;
+};
+
+BOOST_AUTO_TEST_SUITE(HandlerBasic)
+
+BOOST_AUTO_TEST_CASE(SequentialDistributorShouldCallEveryHandler) {
+  RecordingHandler handler_1, handler_2;
+  SequentialDistributor<int64_t> distributor;
+  distributor.addHandler(&handler_1);
+  distributor.addHandler(&handler_2);
+
+  const int64_t value = 42;
+  distributor.distribute(&value);
+  distributor.distributeEvent(&value, 3L, true);
+
+  BOOST_CHECK_EQUAL(handler_1.values.size(), 2);
+  BOOST_CHECK_EQUAL(handler_2.values.size(), 2);
+  BOOST_CHECK_EQUAL(handler_2.batch_ends.size(), 1);
+  BOOST_CHECK_EQUAL(handler_2.batch_ends[0], 3L);
+}
+
+BOOST_AUTO_TEST_CASE(SequentialDistributorShouldTranslateOnce) {
+  RecordingHandler handler_1, handler_2;
+  SequentialDistributor<int64_t> distributor;
+  distributor.addHandler(&handler_1);
+  distributor.addHandler(&handler_2);
+
+  int64_t calls = 0;
+  distributor.distributeWith([&calls](int64_t& event) { event = ++calls; });
+
+  BOOST_CHECK_EQUAL(calls, 1);
+  BOOST_CHECK(handler_1.values == std::vector<int64_t>({1}));
+  BOOST_CHECK(handler_2.values == std::vector<int64_t>({1}));
+}
+
+BOOST_AUTO_TEST_CASE(ParallelDistributorShouldFlagEndOfBatch) {
+  RecordingHandler handler;
+  ParallelDistributor<int64_t, RING_BUFFER_SIZE> distributor;
+  distributor.addHandler(&handler);
+  distributor.start();
+
+  const int64_t events = 100;
+  for (int64_t i = 0; i < events; i++) distributor.distribute(&i);
+  distributor.signal();
+  distributor.join();
+
+  BOOST_REQUIRE_EQUAL(handler.values.size(), events);
+  for (int64_t i = 0; i < events; i++) {
+    BOOST_CHECK_EQUAL(handler.values[i], i);
+    BOOST_CHECK_EQUAL(handler.sequences[i], i);
+  }
+  // every batch ends once and the last event always closes a batch.
+  BOOST_REQUIRE(!handler.batch_ends.empty());
+  BOOST_CHECK_EQUAL(handler.batch_ends.back(), events - 1);
+  for (size_t i = 1; i < handler.batch_ends.size(); i++)
+    BOOST_CHECK(handler.batch_ends[i - 1] < handler.batch_ends[i]);
+}
+
+BOOST_AUTO_TEST_CASE(ParallelDistributorShouldPublishClaimedSlot) {
+  RecordingHandler handler;
+  ParallelDistributor<int64_t, RING_BUFFER_SIZE> distributor;
+  distributor.addHandler(&handler);
+
+  // not started, nothing can be claimed
+  BOOST_CHECK(!distributor.claim());
+
+  distributor.start();
+  for (int64_t i = 0; i < 20; i++) {
+    auto slot = distributor.claim();
+    BOOST_REQUIRE(slot);
+    BOOST_CHECK_EQUAL(slot.sequence(), i);
+    *slot = i * 2;
+  }
+  distributor.distributeWith([](int64_t& event) { event = -1; });
+  distributor.signal();
+  distributor.join();
+
+  BOOST_REQUIRE_EQUAL(handler.values.size(), 21);
+  for (int64_t i = 0; i < 20; i++) BOOST_CHECK_EQUAL(handler.values[i], i * 2);
+  BOOST_CHECK_EQUAL(handler.values.back(), -1);
+}
+
+BOOST_AUTO_TEST_CASE(ParallelDistributorShouldHandOneSlotPerThread) {
+  RecordingHandler handler;
+  ParallelDistributor<int64_t, RING_BUFFER_SIZE> distributor;
+  distributor.addHandler(&handler);
+  distributor.start();
+  {
+    auto slot = distributor.claim();
+    BOOST_REQUIRE(slot);
+    *slot = 1;
+    // a second handle would be destroyed, thus published, first.
+    BOOST_CHECK(!distributor.claim());
+  }
+  {
+    auto slot = distributor.claim();
+    BOOST_REQUIRE(slot);
+    *slot = 3;
+  }
+  distributor.signal();
+  distributor.join();
+
+  BOOST_CHECK(handler.values == std::vector<int64_t>({1, 3}));
+}
+
+BOOST_AUTO_TEST_CASE(ParallelDistributorShouldPublishSlotsMovedToAnotherThread) {
+  RecordingHandler handler;
+  ParallelDistributor<int64_t, RING_BUFFER_SIZE> distributor;
+  distributor.addHandler(&handler);
+  distributor.start();
+  {
+    auto slot = distributor.claim();
+    BOOST_REQUIRE(slot);
+    *slot = 1;
+    std::thread publisher([](decltype(slot)) {}, std::move(slot));
+    publisher.join();
+  }
+  {
+    // the claiming thread gets handles again once the moved one is published.
+    auto slot = distributor.claim();
+    BOOST_REQUIRE(slot);
+    *slot = 2;
+  }
+  distributor.signal();
+  distributor.join();
+
+  BOOST_CHECK(handler.values == std::vector<int64_t>({1, 2}));
+}
+
+BOOST_AUTO_TEST_CASE(ParallelDistributorShouldFillTheSlotEachProducerClaimed) {
+  RecordingHandler handler;
+  ParallelDistributor<int64_t, 8, MultiProducerStrategy<8>> distributor;
+  distributor.addHandler(&handler);
+  distributor.start();
+
+  const int64_t kEvents = 10000;
+  auto produce = [&distributor, kEvents]() {
+    for (int64_t i = 0; i < kEvents; ++i) {
+      auto slot = distributor.claim();
+      *slot = slot.sequence();
+      std::this_thread::yield();
+    }
+  };
+  std::thread first(produce), second(produce);
+  first.join();
+  second.join();
+  distributor.signal();
+  distributor.join();
+
+  BOOST_REQUIRE_EQUAL(handler.values.size(), 2 * kEvents);
+  BOOST_CHECK(handler.values == handler.sequences);
+}
+
+BOOST_AUTO_TEST_CASE(CompositeDistributorShouldFillEveryRing) {
+  RecordingHandler async_handler, sync_handler;
+  CompositeDistributor<int64_t> distributor;
+  distributor.addHandler(&sync_handler);
+  distributor.addAsyncHandlerParellel<RING_BUFFER_SIZE>({&async_handler});
+  distributor.start();
+
+  int64_t calls = 0;
+  distributor.distributeWith([&calls](int64_t& event) { event = ++calls; });
+  distributor.signal();
+  distributor.join();
+
+  // built once, in the sync handler's temporary, and copied into the ring.
+  BOOST_CHECK_EQUAL(calls, 1);
+  BOOST_REQUIRE_EQUAL(sync_handler.values.size(), 1);
+  BOOST_REQUIRE_EQUAL(async_handler.values.size(), 1);
+  BOOST_CHECK_EQUAL(sync_handler.values[0], 1);
+  BOOST_CHECK_EQUAL(async_handler.values[0], 1);
+}
+
+BOOST_AUTO_TEST_CASE(ParallelDistributorShouldPublishBursts) {
+  RecordingHandler handler;
+  ParallelDistributor<int64_t, RING_BUFFER_SIZE> distributor;
+  distributor.addHandler(&handler);
+  distributor.start();
+
+  // bursts wrap the ring and exceed its size.
+  std::vector<int64_t> events(3 * RING_BUFFER_SIZE + 3);
+  for (size_t i = 0; i < events.size(); i++) events[i] = i;
+  distributor.distributeBatch(events.data(), 5);
+  distributor.distributeBatch(events.data() + 5, events.size() - 5);
+  distributor.signal();
+  distributor.join();
+
+  BOOST_CHECK(handler.values == events);
+}
+
+BOOST_AUTO_TEST_CASE(ParallelDistributorShouldUseRuntimeSize) {
+  RecordingHandler handler;
+  ParallelDistributor<int64_t, kRuntimeRingBufferSize> distributor(
+      RING_BUFFER_SIZE);
+  distributor.addHandler(&handler);
+  distributor.start();
+
+  std::vector<int64_t> events(2 * RING_BUFFER_SIZE + 1);
+  for (size_t i = 0; i < events.size(); i++) events[i] = i;
+  distributor.distributeBatch(events.data(), events.size());
+  const int64_t value = 42;
+  distributor.distribute(&value);
+  distributor.signal();
+  distributor.join();
+
+  events.push_back(value);
+  BOOST_CHECK(handler.values == events);
+}
+
+BOOST_AUTO_TEST_CASE(ParallelDistributorShouldPlaceWorkThreads) {
+  // Records the name of the thread it runs on.
+  struct NamingHandler : public Handler<int64_t> {
+    virtual void process(const int64_t* pMD) noexcept override {
+      char buffer[16] = {0};
+      pthread_getname_np(pthread_self(), buffer, sizeof(buffer));
+      name = buffer;
+    }
+    std::string name;
+  };
+
+  NamingHandler handler;
+  ThreadPlacement placement;
+  placement.cpus = {sched_getcpu()};
+  placement.name = "md-consumer";
+  ParallelDistributor<int64_t, kRuntimeRingBufferSize> distributor(
+      RING_BUFFER_SIZE);
+  distributor.set_first_touch(true);
+  distributor.addHandler(&handler, placement);
+  distributor.start();
+
+  const int64_t value = 42;
+  distributor.distribute(&value);
+  distributor.signal();
+  distributor.join();
+
+  BOOST_CHECK_EQUAL(handler.name, "md-consumer");
+}
+
+BOOST_AUTO_TEST_CASE(ParallelDistributorShouldRunDiamondInOneRing) {
+  StageHandler decode;
+  StageHandler risk({&decode}), audit({&decode});
+  StageHandler journal({&risk, &audit});
+  ParallelDistributor<int64_t, RING_BUFFER_SIZE> distributor;
+  distributor.addHandler(&decode);
+  BOOST_CHECK(distributor.addHandlerAfter(&risk, {&decode}));
+  BOOST_CHECK(distributor.addHandlerAfter(&audit, {&decode}));
+  // upstream stages must be added first.
+  StageHandler orphan;
+  BOOST_CHECK(!distributor.addHandlerAfter(&journal, {&risk, &orphan}));
+  BOOST_CHECK(distributor.addHandlerAfter(&journal, {&risk, &audit}));
+  // a stage something runs after stays wired.
+  BOOST_CHECK(!distributor.removeHandler(&risk));
+  distributor.start();
+
+  const int64_t events = 10 * RING_BUFFER_SIZE;
+  for (int64_t i = 0; i < events; i++) distributor.distribute(&i);
+  distributor.signal();
+  distributor.join();
+
+  for (auto stage : {&decode, &risk, &audit, &journal}) {
+    BOOST_CHECK_EQUAL(stage->processed.load(), events - 1);
+    BOOST_CHECK_EQUAL(stage->out_of_order, 0);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(WorkerPoolShouldProcessEachEventOnce) {
+  for (size_t claim_batch : {1, 3}) {
+    RecordingHandler workers[3];
+    WorkerPoolDistributor<int64_t, RING_BUFFER_SIZE> distributor;
+    distributor.set_claim_batch(claim_batch);
+    for (auto& worker : workers) distributor.addHandler(&worker);
+    BOOST_CHECK(!distributor.addHandler(&workers[0]));
+    distributor.start();
+
+    const int64_t events = 20 * RING_BUFFER_SIZE;
+    for (int64_t i = 0; i < events; i++) distributor.distribute(&i);
+    distributor.signal();
+    distributor.join();
+
+    std::vector<int64_t> values;
+    for (auto& worker : workers) {
+      // a worker sees its events in ring order.
+      BOOST_CHECK(std::is_sorted(worker.values.begin(), worker.values.end()));
+      BOOST_CHECK(worker.sequences == worker.values);
+      values.insert(values.end(), worker.values.begin(), worker.values.end());
+    }
+    std::sort(values.begin(), values.end());
+    BOOST_REQUIRE_EQUAL(values.size(), events);
+    for (int64_t i = 0; i < events; i++) BOOST_CHECK_EQUAL(values[i], i);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(CompositeDistributorShouldFeedWorkerPool) {
+  RecordingHandler worker_1, worker_2;
+  CompositeDistributor<int64_t> distributor;
+  distributor.addAsyncWorkerPool<RING_BUFFER_SIZE>({&worker_1, &worker_2});
+  distributor.start();
+
+  const int64_t events = 3 * RING_BUFFER_SIZE;
+  for (int64_t i = 0; i < events; i++) distributor.distribute(&i);
+  distributor.signal();
+  distributor.join();
+
+  BOOST_CHECK_EQUAL(worker_1.values.size() + worker_2.values.size(), events);
+}
+
+BOOST_AUTO_TEST_CASE(ShardedDistributorShouldKeepPerKeyOrder) {
+  // events are key * 1000 + per key counter
+  const int64_t keys = 5, per_key = 6 * RING_BUFFER_SIZE;
+  std::vector<int64_t> events;
+  for (int64_t i = 0; i < keys * per_key; i++)
+    events.push_back((i % keys) * 1000 + i / keys);
+
+  RecordingHandler shards[3];
+  ShardedDistributor<int64_t, RING_BUFFER_SIZE> distributor(
+      [](const int64_t& event) { return size_t(event / 1000); });
+  for (auto& shard : shards) distributor.addHandler(&shard);
+  distributor.start();
+
+  distributor.distribute(&events[0]);
+  distributor.distributeBatch(events.data() + 1, events.size() - 1);
+  distributor.signal();
+  distributor.join();
+
+  size_t total = 0;
+  for (size_t shard = 0; shard < 3; shard++) {
+    std::vector<int64_t> last(keys, -1);
+    for (auto value : shards[shard].values) {
+      const int64_t key = value / 1000;
+      BOOST_CHECK_EQUAL(key % 3, shard);
+      BOOST_CHECK_EQUAL(value % 1000, last[key] + 1);
+      last[key] = value % 1000;
+    }
+    total += shards[shard].values.size();
+  }
+  BOOST_CHECK_EQUAL(total, events.size());
+}
+
+BOOST_AUTO_TEST_CASE(FanInShouldMergeEveryProducer) {
+  const int64_t producers = 3, events = 10 * RING_BUFFER_SIZE;
+  RecordingHandler handler;
+  FanInDistributor<int64_t, RING_BUFFER_SIZE> distributor(producers);
+  distributor.addHandler(&handler);
+  BOOST_CHECK(!distributor.addHandler(&handler));
+  distributor.start();
+
+  std::vector<std::thread> threads;
+  for (int64_t p = 0; p < producers; p++) {
+    threads.emplace_back([&distributor, p, events]() {
+      for (int64_t i = 0; i < events; i++) {
+        const int64_t value = p * 1000 + i;
+        distributor.producer(p).distribute(&value);
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  distributor.signal();
+  distributor.join();
+
+  BOOST_REQUIRE_EQUAL(handler.values.size(), producers * events);
+  std::vector<int64_t> next(producers, 0);
+  for (auto value : handler.values) {
+    BOOST_CHECK_EQUAL(value % 1000, next[value / 1000]);
+    next[value / 1000]++;
+  }
+  BOOST_CHECK_EQUAL(handler.batch_ends.empty(), false);
+}
+
+BOOST_AUTO_TEST_CASE(FanInShouldMergeByTimestamp) {
+  StallingHandler handler;
+  FanInDistributor<int64_t, RING_BUFFER_SIZE> distributor(
+      3, [](const int64_t& event) { return event; });
+  distributor.addHandler(&handler);
+  distributor.start();
+
+  // the consumer stalls on the first event while every ring fills up.
+  const int64_t first = 0;
+  distributor.producer(0).distribute(&first);
+  while (!handler.entered) std::this_thread::yield();
+  for (int64_t j = 0; j < RING_BUFFER_SIZE - 1; j++) {
+    for (int64_t p = 2; p >= 0; p--) {
+      const int64_t value = 3 * j + p + 1;
+      distributor.producer(p).distribute(&value);
+    }
+  }
+  handler.stalled = false;
+  distributor.signal();
+  distributor.join();
+
+  BOOST_CHECK_EQUAL(handler.values.size(), 3 * (RING_BUFFER_SIZE - 1) + 1);
+  BOOST_CHECK(std::is_sorted(handler.values.begin(), handler.values.end()));
+}
+
+BOOST_AUTO_TEST_CASE(ParallelDistributorShouldCountDroppedEvents) {
+  using DISTRIBUTOR_TYPE = ParallelDistributor<int64_t, RING_BUFFER_SIZE>;
+  StallingHandler handler;
+  DISTRIBUTOR_TYPE distributor;
+  distributor.set_backpressure(DISTRIBUTOR_TYPE::Backpressure::CountAndDrop);
+  distributor.addHandler(&handler);
+  distributor.start();
+
+  // the stalled handler never frees a slot, only a ring worth gets through.
+  const int64_t events = 2 * RING_BUFFER_SIZE + 4;
+  for (int64_t i = 0; i < events; i++) distributor.distribute(&i);
+  std::vector<int64_t> burst(RING_BUFFER_SIZE, -1);
+  distributor.distributeBatch(burst.data(), burst.size());
+  BOOST_CHECK_EQUAL(distributor.dropped(), events);
+
+  handler.stalled = false;
+  distributor.signal();
+  distributor.join();
+
+  BOOST_REQUIRE_EQUAL(handler.values.size(), RING_BUFFER_SIZE);
+  for (int64_t i = 0; i < RING_BUFFER_SIZE; i++)
+    BOOST_CHECK_EQUAL(handler.values[i], i);
+}
+
+BOOST_AUTO_TEST_CASE(ParallelDistributorShouldDropWithoutCounting) {
+  using DISTRIBUTOR_TYPE = ParallelDistributor<int64_t, RING_BUFFER_SIZE>;
+  StallingHandler handler;
+  DISTRIBUTOR_TYPE distributor;
+  distributor.set_backpressure(DISTRIBUTOR_TYPE::Backpressure::DropNewest);
+  distributor.addHandler(&handler);
+  distributor.start();
+
+  for (int64_t i = 0; i < RING_BUFFER_SIZE; i++)
+    BOOST_CHECK(distributor.tryDistribute(&i));
+  const int64_t value = 42;
+  BOOST_CHECK(!distributor.tryDistribute(&value));
+  BOOST_CHECK(!distributor.claim());
+  BOOST_CHECK_EQUAL(distributor.dropped(), 0);
+
+  handler.stalled = false;
+  distributor.signal();
+  distributor.join();
+  BOOST_CHECK_EQUAL(handler.values.size(), RING_BUFFER_SIZE);
+}
+
+BOOST_AUTO_TEST_CASE(ObserverShouldNotGateProducer) {
+  StallingHandler observer;
+  RecordingHandler handler;
+  ParallelDistributor<int64_t, RING_BUFFER_SIZE> distributor;
+  distributor.addHandler(&handler);
+  BOOST_CHECK(distributor.addObserver(&observer));
+  BOOST_CHECK(!distributor.addObserver(&handler));
+  StageHandler after;
+  BOOST_CHECK(!distributor.addHandlerAfter(&after, {&observer}));
+  distributor.start();
+
+  const int64_t first = 0;
+  distributor.distribute(&first);
+  while (!observer.entered.load()) std::this_thread::yield();
+  const int64_t events = 10 * RING_BUFFER_SIZE;
+  for (int64_t i = 1; i < events; i++) distributor.distribute(&i);
+  observer.stalled = false;
+  distributor.signal();
+  distributor.join();
+
+  BOOST_CHECK_EQUAL(handler.values.size(), events);
+  // every event is either seen intact or counted as lost.
+  BOOST_CHECK_GT(distributor.lost(&observer), 0);
+  BOOST_CHECK_EQUAL(observer.values.size() + distributor.lost(&observer),
+                    events);
+  BOOST_CHECK(observer.values == observer.sequences);
+  BOOST_CHECK(std::is_sorted(observer.values.begin(), observer.values.end()));
+}
+
+// Waits in the middle of a batch until the producer got past the ring.
+class CappedBatchHandler : public RecordingHandler {
+ public:
+  explicit CappedBatchHandler(const std::atomic<int64_t>& published)
+      : published(published) {}
+
+  virtual void process(const int64_t* pMD) noexcept override {
+    if (*pMD == 0) WaitForPublished(RING_BUFFER_SIZE - 1);
+    if (*pMD == RING_BUFFER_SIZE / 2)
+      released = WaitForPublished(RING_BUFFER_SIZE + 1);
+    RecordingHandler::process(pMD);
+  }
+
+  bool WaitForPublished(int64_t sequence) {
+    const auto stop = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    while (published.load() < sequence) {
+      if (std::chrono::steady_clock::now() > stop) return false;
+      std::this_thread::yield();
+    }
+    return true;
+  }
+
+  const std::atomic<int64_t>& published;
+  bool released = false;
+};
+
+BOOST_AUTO_TEST_CASE(ParallelDistributorShouldPublishCappedBatches) {
+  std::atomic<int64_t> published(-1);
+  CappedBatchHandler handler(published);
+  ParallelDistributor<int64_t, RING_BUFFER_SIZE> distributor;
+  distributor.set_max_batch(2);
+  distributor.set_prefetch_distance(3);
+  distributor.addHandler(&handler);
+  distributor.start();
+
+  // the batch after the first event spans the whole ring, the producer can
+  // only get past it because the handler published part of it already.
+  const int64_t events = 4 * RING_BUFFER_SIZE;
+  for (int64_t i = 0; i < events; i++) {
+    distributor.distribute(&i);
+    published.store(i);
+  }
+  distributor.signal();
+  distributor.join();
+
+  BOOST_CHECK(handler.released);
+  BOOST_REQUIRE_EQUAL(handler.values.size(), events);
+  for (int64_t i = 0; i < events; i++) BOOST_CHECK_EQUAL(handler.values[i], i);
+  BOOST_CHECK_EQUAL(handler.batch_ends.back(), events - 1);
+}
+
+BOOST_AUTO_TEST_CASE(ParallelDistributorShouldSwapHandlersWhileRunning) {
+  RecordingHandler first, second;
+  ParallelDistributor<int64_t, RING_BUFFER_SIZE> distributor;
+  distributor.addHandler(&first);
+  distributor.start();
+
+  const int64_t events = 10 * RING_BUFFER_SIZE;
+  int64_t i = 0;
+  for (; i < events; i++) distributor.distribute(&i);
+  BOOST_CHECK(distributor.addHandler(&second));
+  BOOST_CHECK(!distributor.addHandler(&second));
+  for (; i < 2 * events; i++) distributor.distribute(&i);
+  // the producer must not wait on a detached handler.
+  BOOST_CHECK(distributor.removeHandler(&first));
+  BOOST_CHECK(!distributor.removeHandler(&first));
+  for (; i < 3 * events; i++) distributor.distribute(&i);
+  distributor.signal();
+  distributor.join();
+
+  // each handler saw a contiguous run, the attached one from past the
+  // cursor it was attached at to the last event.
+  BOOST_REQUIRE(!first.values.empty());
+  BOOST_REQUIRE(!second.values.empty());
+  for (size_t j = 0; j < first.values.size(); j++)
+    BOOST_CHECK_EQUAL(first.values[j], j);
+  // it gated the producer until detached, which stops it after its batch.
+  BOOST_CHECK_GE(first.values.back(), 2 * events - 1 - RING_BUFFER_SIZE);
+  BOOST_CHECK_LE(second.values.front(), events);
+  for (size_t j = 1; j < second.values.size(); j++)
+    BOOST_CHECK_EQUAL(second.values[j], second.values[j - 1] + 1);
+  BOOST_CHECK_EQUAL(second.values.back(), 3 * events - 1);
+}
+
+// Counts the events that were overwritten before it handled them, event i
+// being distributed at sequence i.
+class OverwriteCheckingHandler : public Handler<int64_t> {
+ public:
+  virtual void processEvent(const int64_t* pMD, int64_t sequence,
+                            bool) noexcept override {
+    if (*pMD != sequence) overwritten++;
+    handled++;
+  }
+
+  int64_t overwritten = 0;
+  std::atomic<int64_t> handled{0};
+};
+
+BOOST_AUTO_TEST_CASE(ParallelDistributorShouldAttachWhileProducerWraps) {
+  RecordingHandler first;
+  ParallelDistributor<int64_t, RING_BUFFER_SIZE> distributor;
+  distributor.addHandler(&first);
+  distributor.start();
+
+  std::atomic<bool> running(true);
+  std::atomic<int64_t> published(-1);
+  std::thread producer([&] {
+    for (int64_t i = 0; running.load(); i++) {
+      distributor.distribute(&i);
+      published.store(i);
+    }
+  });
+  std::vector<OverwriteCheckingHandler> handlers(50);
+  for (auto& handler : handlers) {
+    BOOST_REQUIRE(distributor.addHandler(&handler));
+    // let the producer lap the ring a few times with the handler gating it.
+    const int64_t until = published.load() + 4 * RING_BUFFER_SIZE;
+    while (published.load() < until) std::this_thread::yield();
+    BOOST_REQUIRE(distributor.removeHandler(&handler));
+  }
+  running = false;
+  producer.join();
+  distributor.signal(published.load());
+  distributor.join();
+
+  int64_t handled = 0;
+  for (auto& handler : handlers) {
+    BOOST_CHECK_EQUAL(handler.overwritten, 0);
+    handled += handler.handled.load();
+  }
+  BOOST_CHECK_GT(handled, 0);
+  for (size_t j = 0; j < first.values.size(); j++)
+    BOOST_CHECK_EQUAL(first.values[j], j);
+}
+
+BOOST_AUTO_TEST_CASE(ParallelDistributorShouldRegateUpstreamOnDetach) {
+  StageHandler decode;
+  StageHandler risk({&decode});
+  ParallelDistributor<int64_t, RING_BUFFER_SIZE> distributor;
+  distributor.addHandler(&decode);
+  distributor.addHandlerAfter(&risk, {&decode});
+  distributor.start();
+  BOOST_CHECK(!distributor.removeHandler(&decode));
+
+  const int64_t events = 10 * RING_BUFFER_SIZE;
+  int64_t i = 0;
+  for (; i < events; i++) distributor.distribute(&i);
+  BOOST_CHECK(distributor.removeHandler(&risk));
+  for (; i < 2 * events; i++) distributor.distribute(&i);
+  distributor.signal();
+  distributor.join();
+
+  BOOST_CHECK_EQUAL(decode.processed.load(), 2 * events - 1);
+  BOOST_CHECK_EQUAL(risk.out_of_order, 0);
+}
+
+BOOST_AUTO_TEST_CASE(ConflatingDistributorShouldKeepLatestPerKey) {
+  const size_t keys = RING_BUFFER_SIZE / 2;
+  StallingHandler slow;
+  RecordingHandler fast;
+  ConflatingDistributor<int64_t, RING_BUFFER_SIZE> distributor(
+      keys, [](const int64_t& event) { return static_cast<size_t>(event) % keys; });
+  distributor.addHandler(&slow);
+  distributor.addHandler(&fast);
+  BOOST_CHECK(!distributor.addHandler(&fast));
+  distributor.start();
+
+  // a stalled handler never blocks the producer.
+  const int64_t events = 100 * RING_BUFFER_SIZE;
+  for (int64_t i = 0; i < events; i++) distributor.distribute(&i);
+  int64_t latest = -1;
+  BOOST_CHECK(distributor.latest(1, latest));
+  BOOST_CHECK_EQUAL(latest, events - keys + 1);
+
+  slow.stalled = false;
+  distributor.signal();
+  distributor.join();
+
+  for (RecordingHandler* handler : std::vector<RecordingHandler*>{&slow, &fast}) {
+    std::vector<int64_t> last(keys, -1);
+    for (auto value : handler->values) {
+      BOOST_CHECK_GE(value, last[value % keys]);
+      last[value % keys] = value;
+    }
+    for (size_t key = 0; key < keys; key++)
+      BOOST_CHECK_EQUAL(last[key], events - keys + key);
+  }
+  BOOST_CHECK_LE(slow.values.size(), 3 * keys);
+}
+
+BOOST_AUTO_TEST_CASE(ConflatingDistributorShouldCountUnknownKeys) {
+  ConflatingDistributor<int64_t, RING_BUFFER_SIZE> distributor(
+      2, [](const int64_t& event) { return static_cast<size_t>(event); });
+  const int64_t unknown = 7;
+  distributor.distribute(&unknown);
+  BOOST_CHECK_EQUAL(distributor.dropped(), 1);
+  int64_t value;
+  BOOST_CHECK(!distributor.latest(1, value));
+  BOOST_CHECK_THROW((ConflatingDistributor<int64_t, RING_BUFFER_SIZE>(
+                        RING_BUFFER_SIZE, [](const int64_t&) { return 0; })),
+                    std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+};  // namespace test
+};  // namespace disruptor
@@ -0,0 +1,308 @@
+// Copyright (c) 2011-2015, Francois Saint-Jacques
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the disruptor-- nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL FRANCOIS SAINT-JACQUES BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE JournalTest
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <disruptor/journal.hpp>
+
+#define RING_BUFFER_SIZE 8
+
+namespace disruptor {
+namespace test {
+
+struct JournalDirectory {
+  JournalDirectory() {
+    char name[] = "/tmp/disruptor-journal-XXXXXX";
+    path = mkdtemp(name);
+  }
+  ~JournalDirectory() {
+    for (size_t i = 0; unlink(journalSegmentPath(path, "events", i).c_str()) == 0; i++) {
+    }
+    rmdir(path.c_str());
+  }
+  size_t segments() const {
+    struct stat status;
+    size_t i = 0;
+    while (stat(journalSegmentPath(path, "events", i).c_str(), &status) == 0) i++;
+    return i;
+  }
+  std::string path;
+};
+
+// Checks every journaled event is durable before this stage sees it.
+class AfterJournalHandler : public Handler<int64_t> {
+ public:
+  explicit AfterJournalHandler(JournalHandler<int64_t>* journal) : journal_(journal) {}
+  void process(const int64_t*) noexcept override {}
+  void processEvent(const int64_t* event, int64_t sequence, bool) noexcept override {
+    if (journal_->durableSequence()->sequence() < sequence) not_durable++;
+    processed.store(*event);
+  }
+  std::atomic<int64_t> processed{kInitialCursorValue};
+  int64_t not_durable = 0;
+
+ private:
+  JournalHandler<int64_t>* journal_;
+};
+
+// Reads back the records of a segment, in order.
+std::vector<int64_t> ReadSegment(const std::string& path) {
+  std::vector<int64_t> events;
+  int fd = open(path.c_str(), O_RDONLY);
+  struct stat status;
+  fstat(fd, &status);
+  char* base = static_cast<char*>(
+      mmap(nullptr, status.st_size, PROT_READ, MAP_SHARED, fd, 0));
+  const JournalSegmentHeader* header =
+      reinterpret_cast<const JournalSegmentHeader*>(base);
+  BOOST_CHECK_EQUAL(header->magic, kJournalMagic);
+  BOOST_CHECK_EQUAL(header->event_size, sizeof(int64_t));
+  for (size_t i = 0; i < header->records; i++) {
+    const char* record =
+        base + sizeof(JournalSegmentHeader) + i * header->record_size;
+    const JournalRecordHeader* entry =
+        reinterpret_cast<const JournalRecordHeader*>(record);
+    if (entry->tag.load() != kJournalRecordTag) break;
+    BOOST_CHECK_EQUAL(entry->sequence, header->first_sequence + i);
+    events.push_back(
+        *reinterpret_cast<const int64_t*>(record + sizeof(JournalRecordHeader)));
+  }
+  munmap(base, status.st_size);
+  close(fd);
+  return events;
+}
+
+BOOST_AUTO_TEST_SUITE(Journal)
+
+BOOST_AUTO_TEST_CASE(ShouldJournalAcrossSegments) {
+  JournalDirectory directory;
+  const size_t records = 16;
+  const size_t segment_size = sizeof(JournalSegmentHeader) +
+                              records * JournalHandler<int64_t>::kRecordSize;
+  const int64_t events = 5 * records + 3;
+  {
+    JournalHandler<int64_t> journal(directory.path, segment_size);
+    AfterJournalHandler after(&journal);
+    ParallelDistributor<int64_t, RING_BUFFER_SIZE> distributor;
+    distributor.addHandler(&journal);
+    BOOST_CHECK(distributor.addHandlerAfter(&after, {&journal}));
+    distributor.start();
+    for (int64_t i = 0; i < events; i++) distributor.distribute(&i);
+    distributor.signal();
+    distributor.join();
+
+    BOOST_CHECK_EQUAL(after.processed.load(), events - 1);
+    BOOST_CHECK_EQUAL(after.not_durable, 0);
+    BOOST_CHECK_EQUAL(journal.durableSequence()->sequence(), events - 1);
+    BOOST_CHECK_EQUAL(journal.syncErrors(), 0);
+  }
+  BOOST_REQUIRE_EQUAL(directory.segments(), 6);
+  std::vector<int64_t> journaled;
+  for (size_t i = 0; i < directory.segments(); i++) {
+    auto segment = ReadSegment(journalSegmentPath(directory.path, "events", i));
+    journaled.insert(journaled.end(), segment.begin(), segment.end());
+  }
+  BOOST_REQUIRE_EQUAL(journaled.size(), events);
+  for (int64_t i = 0; i < events; i++) BOOST_CHECK_EQUAL(journaled[i], i);
+}
+
+BOOST_AUTO_TEST_CASE(ShouldNotBeDurablePastALostEvent) {
+  JournalDirectory directory;
+  const size_t segment_size =
+      sizeof(JournalSegmentHeader) + 2 * JournalHandler<int64_t>::kRecordSize;
+  JournalHandler<int64_t> journal(directory.path, segment_size);
+  // the second segment cannot be created, events 2 and 3 are lost.
+  close(open(journalSegmentPath(directory.path, "events", 1).c_str(),
+             O_RDWR | O_CREAT, 0644));
+  for (int64_t i = 0; i < 4; i++) journal.processEvent(&i, i, true);
+
+  BOOST_CHECK(journal.failed());
+  BOOST_CHECK_EQUAL(journal.syncErrors(), 1);
+  for (int i = 0; i < 1000 && journal.durableSequence()->sequence() < 1; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  BOOST_CHECK_EQUAL(journal.durableSequence()->sequence(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(ShouldAppendAfterExistingSegments) {
+  JournalDirectory directory;
+  for (int run = 0; run < 2; run++) {
+    JournalHandler<int64_t> journal(directory.path, 4096,
+                                    std::chrono::milliseconds(1));
+    for (int64_t i = 0; i < 10; i++) journal.process(&i);
+  }
+  BOOST_REQUIRE_EQUAL(directory.segments(), 2);
+  BOOST_CHECK_EQUAL(
+      ReadSegment(journalSegmentPath(directory.path, "events", 1)).size(), 10);
+}
+
+BOOST_AUTO_TEST_CASE(ShouldRejectSegmentsTooSmall) {
+  JournalDirectory directory;
+  BOOST_CHECK_THROW(JournalHandler<int64_t>(directory.path, 8),
+                    std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+class CollectingHandler : public Handler<int64_t> {
+ public:
+  void process(const int64_t* event) noexcept override {
+    values.push_back(*event);
+  }
+  std::vector<int64_t> values;
+};
+
+void WriteJournal(const std::string& path, int64_t events,
+                  std::chrono::microseconds gap) {
+  JournalHandler<int64_t> journal(path, 4096);
+  for (int64_t i = 0; i < events; i++) {
+    journal.process(&i);
+    if (gap.count() > 0) std::this_thread::sleep_for(gap);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE(Replay)
+
+BOOST_AUTO_TEST_CASE(ShouldReplayAllSegmentsInOrder) {
+  JournalDirectory directory;
+  // a few 4KB segments, with ranges ending on segment boundaries.
+  const int64_t events = 1000;
+  WriteJournal(directory.path, events, std::chrono::microseconds(0));
+  BOOST_CHECK_GT(directory.segments(), 3);
+
+  CollectingHandler collector;
+  ParallelDistributor<int64_t, RING_BUFFER_SIZE> distributor;
+  distributor.addHandler(&collector);
+  distributor.start();
+  JournalReplayer<int64_t> replayer(directory.path);
+  BOOST_CHECK_EQUAL(replayer.replay(distributor), events);
+  distributor.signal();
+  distributor.join();
+
+  BOOST_REQUIRE_EQUAL(collector.values.size(), events);
+  for (int64_t i = 0; i < events; i++) BOOST_CHECK_EQUAL(collector.values[i], i);
+}
+
+BOOST_AUTO_TEST_CASE(ShouldPaceReplayByJournalClock) {
+  JournalDirectory directory;
+  const int64_t events = 20;
+  const auto gap = std::chrono::milliseconds(2);
+  WriteJournal(directory.path, events,
+               std::chrono::duration_cast<std::chrono::microseconds>(gap));
+
+  CollectingHandler collector;
+  ParallelDistributor<int64_t, RING_BUFFER_SIZE> distributor;
+  distributor.addHandler(&collector);
+  distributor.start();
+  JournalReplayer<int64_t> replayer(directory.path);
+  replayer.set_speed(2.0);
+  const auto start = std::chrono::steady_clock::now();
+  BOOST_CHECK_EQUAL(replayer.replay(distributor), events);
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  distributor.signal();
+  distributor.join();
+
+  // the journal spans at least (events - 1) gaps, replayed twice as fast.
+  BOOST_CHECK(elapsed >= (events - 1) * gap / 2);
+  BOOST_CHECK_EQUAL(collector.values.size(), events);
+}
+
+BOOST_AUTO_TEST_CASE(ShouldReplayRunsAppendedToAJournal) {
+  JournalDirectory directory;
+  // each run leaves its last segment partly filled.
+  WriteJournal(directory.path, 10, std::chrono::microseconds(0));
+  WriteJournal(directory.path, 5, std::chrono::microseconds(0));
+  BOOST_REQUIRE_EQUAL(directory.segments(), 2);
+
+  CollectingHandler collector;
+  ParallelDistributor<int64_t, RING_BUFFER_SIZE> distributor;
+  distributor.addHandler(&collector);
+  distributor.start();
+  JournalReplayer<int64_t> replayer(directory.path);
+  BOOST_CHECK_EQUAL(replayer.replay(distributor), 15);
+  distributor.signal();
+  distributor.join();
+
+  BOOST_REQUIRE_EQUAL(collector.values.size(), 15);
+  for (int64_t i = 0; i < 10; i++) BOOST_CHECK_EQUAL(collector.values[i], i);
+  for (int64_t i = 0; i < 5; i++)
+    BOOST_CHECK_EQUAL(collector.values[10 + i], i);
+}
+
+BOOST_AUTO_TEST_CASE(ShouldRejectTruncatedSegments) {
+  JournalDirectory directory;
+  WriteJournal(directory.path, 10, std::chrono::microseconds(0));
+  BOOST_REQUIRE_EQUAL(
+      truncate(journalSegmentPath(directory.path, "events", 0).c_str(), 1024),
+      0);
+  Sequence consumer;
+  Sequencer<int64_t, RING_BUFFER_SIZE> sequencer;
+  sequencer.set_gating_sequences({&consumer});
+  JournalReplayer<int64_t> replayer(directory.path);
+  BOOST_CHECK_THROW(replayer.replay(sequencer), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(ShouldOnlyReplayIntoBlockingDistributors) {
+  using DISTRIBUTOR_TYPE = ParallelDistributor<int64_t, RING_BUFFER_SIZE>;
+  JournalDirectory directory;
+  WriteJournal(directory.path, 10, std::chrono::microseconds(0));
+  JournalReplayer<int64_t> replayer(directory.path);
+
+  // nothing is claimed from a distributor that is not started.
+  DISTRIBUTOR_TYPE stopped;
+  BOOST_CHECK_EQUAL(replayer.replay(stopped), 0);
+
+  DISTRIBUTOR_TYPE dropping;
+  dropping.set_backpressure(DISTRIBUTOR_TYPE::Backpressure::DropNewest);
+  BOOST_CHECK_THROW(replayer.replay(dropping), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(ShouldRejectOtherEventTypes) {
+  JournalDirectory directory;
+  WriteJournal(directory.path, 1, std::chrono::microseconds(0));
+  ParallelDistributor<int32_t, RING_BUFFER_SIZE> distributor;
+  JournalReplayer<int32_t> replayer(directory.path);
+  BOOST_CHECK_THROW(replayer.replay(distributor), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+};  // namespace test
+};  // namespace disruptor
@@ -0,0 +1,154 @@
+// Copyright (c) 2011-2015, Francois Saint-Jacques
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the disruptor-- nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL FRANCOIS SAINT-JACQUES BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE MetricsTest
+
+#include <atomic>
+#include <chrono>
+#include <numeric>
+#include <thread>
+#include <type_traits>
+
+#include <boost/test/unit_test.hpp>
+
+#include <disruptor/handler.hpp>
+#include <disruptor/metrics.h>
+
+#define RING_BUFFER_SIZE 8
+
+namespace disruptor {
+namespace test {
+
+// Holds on to the first event until released, so the ring fills up.
+class StallingHandler : public Handler<int64_t> {
+ public:
+  virtual void process(const int64_t* pMD) noexcept override {
+    entered = true;
+    while (stalled.load()) std::this_thread::yield();
+  }
+
+  std::atomic<bool> stalled{true};
+  std::atomic<bool> entered{false};
+};
+
+BOOST_AUTO_TEST_SUITE(Metrics)
+
+BOOST_AUTO_TEST_CASE(ShouldCompileOutWhenDisabled) {
+  BOOST_CHECK(kMetricsEnabled);
+  BOOST_CHECK(std::is_empty<BasicClaimMetrics<false> >::value);
+  BOOST_CHECK(std::is_empty<BasicConsumerMetrics<false> >::value);
+  BOOST_CHECK_EQUAL(sizeof(BasicConsumerMetrics<false>::Wait), sizeof(int));
+  // disabled metrics cost no byte of the strategy, and change its type.
+  BOOST_CHECK_EQUAL(
+      (sizeof(SingleThreadedStrategy<RING_BUFFER_SIZE, false>)),
+      2 * sizeof(int64_t));
+  BOOST_CHECK((!std::is_same<SingleThreadedStrategy<RING_BUFFER_SIZE, false>,
+                             SingleThreadedStrategy<RING_BUFFER_SIZE> >::value));
+}
+
+BOOST_AUTO_TEST_CASE(ShouldBucketBatchSizesByPowerOfTwo) {
+  BOOST_CHECK_EQUAL(BatchSizeBucket(1), 0);
+  BOOST_CHECK_EQUAL(BatchSizeBucket(2), 1);
+  BOOST_CHECK_EQUAL(BatchSizeBucket(3), 1);
+  BOOST_CHECK_EQUAL(BatchSizeBucket(1024), 10);
+  BOOST_CHECK_EQUAL(BatchSizeBucket(1ULL << 40), kBatchSizeBuckets - 1);
+}
+
+BOOST_AUTO_TEST_CASE(ShouldCountConsumerBatches) {
+  ConsumerMetrics metrics;
+  metrics.Batch(1);
+  metrics.Batch(5);
+  metrics.WaitEnd(metrics.WaitBegin() - std::chrono::microseconds(1));
+
+  const ConsumerMetricsSnapshot snapshot = metrics.Snapshot();
+  BOOST_CHECK_EQUAL(snapshot.batches, 2);
+  BOOST_CHECK_EQUAL(snapshot.events, 6);
+  BOOST_CHECK_EQUAL(snapshot.batch_sizes[0], 1);
+  BOOST_CHECK_EQUAL(snapshot.batch_sizes[2], 1);
+  BOOST_CHECK(snapshot.wait_nanoseconds >= 1000);
+}
+
+BOOST_AUTO_TEST_CASE(ShouldCountStalledClaims) {
+  Sequencer<int64_t, RING_BUFFER_SIZE> sequencer;
+  Sequence consumer;
+  sequencer.set_gating_sequences({&consumer});
+
+  for (int i = 0; i < RING_BUFFER_SIZE; i++)
+    sequencer.Publish(sequencer.Claim());
+  BOOST_CHECK_EQUAL(sequencer.claim_metrics().stalls, 0);
+
+  std::atomic<bool> claiming(false);
+  std::thread producer([&sequencer, &claiming] {
+    claiming = true;
+    sequencer.Publish(sequencer.Claim());
+  });
+  // the stall is only timed once the producer thread runs, leave it margin.
+  while (!claiming.load()) std::this_thread::yield();
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  consumer.set_sequence(0);
+  producer.join();
+
+  const ClaimMetricsSnapshot snapshot = sequencer.claim_metrics();
+  BOOST_CHECK_EQUAL(snapshot.stalls, 1);
+  BOOST_CHECK(snapshot.stall_nanoseconds >= 10000000);
+}
+
+BOOST_AUTO_TEST_CASE(ParallelDistributorShouldReportLagAndBatches) {
+  StallingHandler handler;
+  ParallelDistributor<int64_t, RING_BUFFER_SIZE> distributor;
+  distributor.addHandler(&handler);
+  distributor.start();
+
+  const int64_t events = 4 * RING_BUFFER_SIZE;
+  std::thread producer([&distributor, events] {
+    for (int64_t i = 0; i < events; i++) distributor.distribute(&i);
+  });
+  while (!handler.entered.load()) std::this_thread::yield();
+  // the producer fills the ring behind the stalled handler then stalls too.
+  while (distributor.metrics(&handler).lag < RING_BUFFER_SIZE)
+    std::this_thread::yield();
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  BOOST_CHECK_EQUAL(distributor.metrics(&handler).lag, RING_BUFFER_SIZE);
+
+  handler.stalled = false;
+  producer.join();
+  distributor.signal();
+  distributor.join();
+
+  const ConsumerMetricsSnapshot snapshot = distributor.metrics(&handler);
+  BOOST_CHECK_EQUAL(snapshot.events, events);
+  BOOST_CHECK_EQUAL(snapshot.lag, 0);
+  BOOST_CHECK_EQUAL(std::accumulate(snapshot.batch_sizes.begin(),
+                                    snapshot.batch_sizes.end(), uint64_t(0)),
+                    snapshot.batches);
+  BOOST_CHECK(distributor.claimMetrics().stalls >= 1);
+  BOOST_CHECK(distributor.claimMetrics().stall_nanoseconds >= 10000000);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+};  // namespace test
+};  // namespace disruptor
@@ -0,0 +1,116 @@
+// Copyright (c) 2011-2015, Francois Saint-Jacques
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the disruptor-- nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL FRANCOIS SAINT-JACQUES BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE PipelineTest
+
+#include <atomic>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <disruptor/pipeline.hpp>
+
+#define RING_BUFFER_SIZE 8
+
+namespace disruptor {
+namespace test {
+
+// A stage is a plain type, no Handler base and no virtual call.
+struct RecordingStage {
+  void processEvent(const int64_t* event, int64_t sequence, bool end_of_batch) {
+    values.push_back(*event);
+    if (end_of_batch) batch_ends++;
+  }
+  std::vector<int64_t> values;
+  int64_t batch_ends = 0;
+};
+
+// Adds its own value to the events it runs on, to check stage order.
+struct AddingStage {
+  explicit AddingStage(int64_t value) : value(value) {}
+  void processEvent(const int64_t*, int64_t, bool) { total = total * 10 + value; }
+  int64_t value;
+  int64_t total = 0;
+};
+
+// Counts the life cycle calls forwarded to it.
+struct LifeCycleStage : RecordingStage {
+  void start() { started++; }
+  void signal(int64_t) { signaled++; }
+  void join() { joined++; }
+  int started = 0, signaled = 0, joined = 0;
+};
+
+BOOST_AUTO_TEST_SUITE(Pipeline)
+
+BOOST_AUTO_TEST_CASE(SequentialShouldRunStagesInOrder) {
+  AddingStage first(1), second(2), third(3);
+  auto pipeline = sequential(first, second, third);
+  const int64_t event = 0;
+  pipeline.process(&event);
+  BOOST_CHECK_EQUAL(first.total, 1);
+  BOOST_CHECK_EQUAL(second.total, 2);
+  BOOST_CHECK_EQUAL(third.total, 3);
+
+  AddingStage shared(4);
+  auto pipeline2 = sequential(shared, shared);
+  pipeline2.process(&event);
+  BOOST_CHECK_EQUAL(shared.total, 44);
+}
+
+BOOST_AUTO_TEST_CASE(ParallelShouldFeedEveryStage) {
+  RecordingStage decode;
+  RecordingStage risk;
+  LifeCycleStage audit;
+  auto after_decode = sequential(decode, audit);
+  Parallel<int64_t, RING_BUFFER_SIZE, RecordingStage,
+           Sequential<RecordingStage, LifeCycleStage> >
+      fanout(risk, after_decode);
+  LifeCycleStage source;
+  auto pipeline = sequential(source, fanout);
+  pipeline.start();
+
+  const int64_t events = 10 * RING_BUFFER_SIZE;
+  for (int64_t i = 0; i < events; i++) pipeline.process(&i);
+  pipeline.signal();
+  pipeline.join();
+
+  for (auto stage : std::vector<RecordingStage*>{&source, &risk, &decode, &audit}) {
+    BOOST_REQUIRE_EQUAL(stage->values.size(), events);
+    for (int64_t i = 0; i < events; i++) BOOST_CHECK_EQUAL(stage->values[i], i);
+    BOOST_CHECK_GT(stage->batch_ends, 0);
+  }
+  for (auto stage : {&source, &audit}) {
+    BOOST_CHECK_EQUAL(stage->started, 1);
+    BOOST_CHECK_EQUAL(stage->signaled, 1);
+    BOOST_CHECK_EQUAL(stage->joined, 1);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+};  // namespace test
+};  // namespace disruptor
@@ -0,0 +1,81 @@
+// Copyright (c) 2011-2015, Francois Saint-Jacques
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the disruptor-- nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL FRANCOIS SAINT-JACQUES BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE PlacementTest
+
+#include <sys/mman.h>
+
+#include <thread>
+
+#include <boost/test/unit_test.hpp>
+
+#include <disruptor/placement.h>
+
+namespace disruptor {
+namespace test {
+
+BOOST_AUTO_TEST_SUITE(ThreadPlacementBasic)
+
+BOOST_AUTO_TEST_CASE(DefaultPlacementShouldBeEmpty) {
+  ThreadPlacement placement;
+  BOOST_CHECK(placement.empty());
+  BOOST_CHECK(placement.Apply());
+}
+
+BOOST_AUTO_TEST_CASE(ShouldPinAndNameTheCallingThread) {
+  ThreadPlacement placement;
+  placement.cpus = {sched_getcpu()};
+  placement.name = "disruptor-placement-test";
+  BOOST_CHECK(!placement.empty());
+
+  bool applied = false;
+  cpu_set_t set;
+  char name[16] = {0};
+  std::thread([&]() {
+    applied = placement.Apply();
+    pthread_getaffinity_np(pthread_self(), sizeof(set), &set);
+    pthread_getname_np(pthread_self(), name, sizeof(name));
+  }).join();
+
+  BOOST_CHECK(applied);
+  BOOST_CHECK_EQUAL(CPU_COUNT(&set), 1);
+  BOOST_CHECK(CPU_ISSET(placement.cpus[0], &set));
+  BOOST_CHECK_EQUAL(std::string(name), "disruptor-place");
+}
+
+BOOST_AUTO_TEST_CASE(BindToNumaNodeShouldKeepDefaultPolicy) {
+  const size_t bytes = sysconf(_SC_PAGESIZE);
+  void* region = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  BOOST_REQUIRE(region != MAP_FAILED);
+  BOOST_CHECK(BindToNumaNode(region, bytes, -1));
+  munmap(region, bytes);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+};  // namespace test
+};  // namespace disruptor
@@ -28,6 +28,8 @@
 
 #define RING_BUFFER_SIZE 8
 
+#include <string>
+
 #include <boost/test/unit_test.hpp>
 #include <disruptor/ring_buffer.h>
 
@@ -58,6 +60,53 @@ BOOST_FIXTURE_TEST_CASE(VerifyWrapArround, RingBufferFixture) {
     const auto& t = ring_buffer[i];
 }
 
+BOOST_FIXTURE_TEST_CASE(ContiguousSlotsShouldStopAtWrap, RingBufferFixture) {
+  BOOST_CHECK_EQUAL(ring_buffer.ContiguousSlots(0, 3), 3);
+  BOOST_CHECK_EQUAL(ring_buffer.ContiguousSlots(6, 3), 2);
+  BOOST_CHECK_EQUAL(ring_buffer.ContiguousSlots(RING_BUFFER_SIZE + 7, 3), 1);
+  BOOST_CHECK_EQUAL(ring_buffer.ContiguousSlots(0, RING_BUFFER_SIZE),
+                    RING_BUFFER_SIZE);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(RuntimeRingBuffer)
+
+BOOST_AUTO_TEST_CASE(VerifyWrapArround) {
+  RingBuffer<int64_t, kRuntimeRingBufferSize> ring_buffer(RING_BUFFER_SIZE);
+  BOOST_CHECK_EQUAL(ring_buffer.size(), RING_BUFFER_SIZE);
+  BOOST_CHECK_EQUAL(ring_buffer[0], 0);
+
+  for (int64_t i = 0; i < RING_BUFFER_SIZE; i++) ring_buffer[i] = i + 1;
+  for (int64_t i = 0; i < RING_BUFFER_SIZE * 2; i++)
+    BOOST_CHECK_EQUAL(ring_buffer[i], i % RING_BUFFER_SIZE + 1);
+  BOOST_CHECK_EQUAL(ring_buffer.ContiguousSlots(6, 3), 2);
+}
+
+BOOST_AUTO_TEST_CASE(ShouldConstructEvents) {
+  RingBuffer<std::string, kRuntimeRingBufferSize> ring_buffer(RING_BUFFER_SIZE);
+  ring_buffer[3] = "event";
+  BOOST_CHECK(ring_buffer[2].empty());
+  BOOST_CHECK_EQUAL(ring_buffer[RING_BUFFER_SIZE + 3], "event");
+}
+
+BOOST_AUTO_TEST_CASE(ShouldHonourMemoryOptions) {
+  // without reserved huge pages the ring falls back to regular pages.
+  RingBufferOptions options;
+  options.huge_pages = true;
+  options.prefault = true;
+  options.numa_node = 0;
+  RingBuffer<int64_t, kRuntimeRingBufferSize> ring_buffer(1 << 16, options);
+  ring_buffer[(1 << 16) - 1] = 42;
+  BOOST_CHECK_EQUAL(ring_buffer[-1], 42);
+}
+
+BOOST_AUTO_TEST_CASE(ShouldRejectInvalidSizes) {
+  using RUNTIME_RING_TYPE = RingBuffer<int, kRuntimeRingBufferSize>;
+  BOOST_CHECK_THROW(RUNTIME_RING_TYPE ring_buffer(0), std::invalid_argument);
+  BOOST_CHECK_THROW(RUNTIME_RING_TYPE ring_buffer(12), std::invalid_argument);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 };  // namespace test
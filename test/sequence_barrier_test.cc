@@ -81,6 +81,18 @@ BOOST_AUTO_TEST_CASE(WaitForCursor) {
   BOOST_CHECK_EQUAL(return_value.load(), kFirstSequenceValue + 1L);
 }
 
+BOOST_AUTO_TEST_CASE(TryWaitForShouldNotBlock) {
+  BOOST_CHECK_EQUAL(barrier.TryWaitFor(kFirstSequenceValue),
+                    kInitialCursorValue);
+
+  cursor.IncrementAndGet(2L);
+  BOOST_CHECK_EQUAL(barrier.TryWaitFor(kFirstSequenceValue),
+                    kFirstSequenceValue + 1L);
+
+  barrier.set_alerted(true);
+  BOOST_CHECK_EQUAL(barrier.TryWaitFor(kFirstSequenceValue), kAlertedSignal);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 };  // namespace test
@@ -26,8 +26,13 @@
 #define BOOST_TEST_DYN_LINK
 #define BOOST_TEST_MODULE SequencerTest
 
+#include <poll.h>
+
 #include <atomic>
+#include <chrono>
 #include <iostream>
+#include <limits>
+#include <thread>
 
 #include <boost/test/unit_test.hpp>
 
@@ -59,7 +64,209 @@ BOOST_AUTO_TEST_CASE(ShouldStartWithValueInitialized) {
   BOOST_CHECK(sequencer.GetCursor() == kInitialCursorValue);
 }
 
+BOOST_AUTO_TEST_CASE(ShouldPublishClaimedSequences) {
+  int64_t sequence = sequencer.Claim();
+  sequencer.Publish(sequence);
+  BOOST_CHECK_EQUAL(sequencer.GetCursor(), kFirstSequenceValue);
+
+  sequence = sequencer.Claim(2);
+  sequencer.Publish(sequence, 2);
+  BOOST_CHECK_EQUAL(sequencer.GetCursor(), kFirstSequenceValue + 2L);
+}
+
+BOOST_AUTO_TEST_CASE(ShouldClaimRangeAcrossWrap) {
+  sequencer.Publish(sequencer.Claim(3), 3);
+
+  auto range = sequencer.ClaimRange(3);
+  BOOST_CHECK_EQUAL(range.first(), 3L);
+  BOOST_CHECK_EQUAL(range.last(), 5L);
+  BOOST_CHECK_EQUAL(range.size(), 3);
+  BOOST_CHECK_EQUAL(range.head_size(), 1);
+  BOOST_CHECK_EQUAL(range.tail_size(), 2);
+  BOOST_CHECK_EQUAL(range.head(), &sequencer[3L]);
+  BOOST_CHECK_EQUAL(range.tail(), &sequencer[4L]);
+
+  for (size_t i = 0; i < range.size(); i++) range[i] = 10L + i;
+  BOOST_CHECK_EQUAL(sequencer.GetCursor(), 2L);
+  sequencer.Publish(range);
+  BOOST_CHECK_EQUAL(sequencer.GetCursor(), 5L);
+  BOOST_CHECK_EQUAL(sequencer[3L], 10L);
+  BOOST_CHECK_EQUAL(sequencer[5L], 12L);
+}
+
+BOOST_AUTO_TEST_CASE(TryClaimShouldFailWhenFull) {
+  Sequence consumer;
+  sequencer.set_gating_sequences({&consumer});
+
+  auto range = sequencer.TryClaimRange(RING_BUFFER_SIZE);
+  BOOST_CHECK(!range.empty());
+  sequencer.Publish(range);
+  BOOST_CHECK_EQUAL(sequencer.TryClaim(), kInsufficientCapacitySignal);
+  BOOST_CHECK(sequencer.TryClaimRange(1).empty());
+  BOOST_CHECK_EQUAL(sequencer.GetCursor(), RING_BUFFER_SIZE - 1L);
+
+  consumer.set_sequence(0L);
+  BOOST_CHECK_EQUAL(sequencer.TryClaim(), RING_BUFFER_SIZE);
+}
+
+BOOST_AUTO_TEST_CASE(ShouldSwapGatingSequences) {
+  Sequence stalled, running;
+  sequencer.set_gating_sequences({&stalled});
+  FillBuffer();
+  BOOST_CHECK_EQUAL(sequencer.TryClaim(), kInsufficientCapacitySignal);
+
+  running.set_sequence(sequencer.GetCursor());
+  sequencer.AddGatingSequence(&running);
+  BOOST_CHECK_EQUAL(sequencer.TryClaim(), kInsufficientCapacitySignal);
+  BOOST_CHECK(sequencer.RemoveGatingSequence(&stalled));
+  BOOST_CHECK(!sequencer.RemoveGatingSequence(&stalled));
+  BOOST_CHECK_EQUAL(sequencer.TryClaim(), RING_BUFFER_SIZE);
+}
+
+BOOST_AUTO_TEST_CASE(ShouldFreeGatingSetsOncePublishersAreDone) {
+  Sequence stalled, running;
+  sequencer.set_gating_sequences({&stalled});
+  FillBuffer();
+  running.set_sequence(sequencer.GetCursor());
+  sequencer.AddGatingSequence(&running);
+  BOOST_CHECK(!sequencer.HasRetiredGatingSequences());
+
+  // a claim waiting on the stalled sequence holds the set it was made against.
+  std::thread publisher([this] { sequencer.Claim(); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  BOOST_CHECK(sequencer.RemoveGatingSequence(&stalled));
+  BOOST_CHECK(sequencer.HasRetiredGatingSequences());
+
+  stalled.set_sequence(std::numeric_limits<int64_t>::max());
+  publisher.join();
+  BOOST_CHECK(!sequencer.HasRetiredGatingSequences());
+}
+
 BOOST_AUTO_TEST_SUITE_END()  // BlockingStrategy suite
 
+BOOST_AUTO_TEST_SUITE(SequencerWaitStrategy)
+
+BOOST_AUTO_TEST_CASE(BarrierShouldBeSignaledByPublish) {
+  Sequencer<long, RING_BUFFER_SIZE, SingleThreadedStrategy<RING_BUFFER_SIZE>,
+            FutexBlockingStrategy<>> sequencer;
+  std::unique_ptr<SequenceBarrier<FutexBlockingStrategy<>>> barrier(
+      sequencer.NewBarrier({}));
+  std::atomic<int64_t> return_value(kInitialCursorValue);
+
+  std::thread waiter([&barrier, &return_value]() {
+    return_value.store(barrier->WaitFor(kFirstSequenceValue));
+  });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  BOOST_CHECK_EQUAL(return_value.load(), kInitialCursorValue);
+
+  sequencer.Publish(sequencer.Claim());
+  waiter.join();
+  BOOST_CHECK_EQUAL(return_value.load(), kFirstSequenceValue);
+}
+
+BOOST_AUTO_TEST_CASE(WaitFdShouldBecomeReadableOnPublish) {
+  Sequencer<long, RING_BUFFER_SIZE, SingleThreadedStrategy<RING_BUFFER_SIZE>,
+            EventFdStrategy<>> sequencer;
+  std::unique_ptr<SequenceBarrier<EventFdStrategy<>>> barrier_1(
+      sequencer.NewBarrier({}));
+  std::unique_ptr<SequenceBarrier<EventFdStrategy<>>> barrier_2(
+      sequencer.NewBarrier({}));
+
+  struct pollfd fds[2];
+  fds[0].fd = barrier_1->wait_fd();
+  fds[1].fd = barrier_2->wait_fd();
+  fds[0].events = fds[1].events = POLLIN;
+  BOOST_CHECK(fds[0].fd >= 0);
+  BOOST_CHECK(fds[0].fd != fds[1].fd);
+
+  // nothing published, both consumers may poll
+  BOOST_CHECK_EQUAL(barrier_1->ArmWaitFd(kFirstSequenceValue),
+                    kInitialCursorValue);
+  BOOST_CHECK_EQUAL(barrier_2->ArmWaitFd(kFirstSequenceValue),
+                    kInitialCursorValue);
+  BOOST_CHECK_EQUAL(poll(fds, 2, 0), 0);
+
+  sequencer.Publish(sequencer.Claim());
+  BOOST_CHECK_EQUAL(poll(fds, 2, 1000), 2);
+  BOOST_CHECK_EQUAL(barrier_1->TryWaitFor(kFirstSequenceValue),
+                    kFirstSequenceValue);
+
+  // a disarmed eventfd is not written again
+  barrier_1->ArmWaitFd(kFirstSequenceValue + 1L);
+  sequencer.Publish(sequencer.Claim());
+  sequencer.Publish(sequencer.Claim());
+  uint64_t value = 0;
+  BOOST_CHECK_EQUAL(read(fds[0].fd, &value, sizeof(value)),
+                    sizeof(value));
+  BOOST_CHECK_EQUAL(value, 1UL);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(SequencerRuntimeSize)
+
+BOOST_AUTO_TEST_CASE(ShouldGateOnRuntimeSize) {
+  Sequencer<int64_t, kRuntimeRingBufferSize,
+            MultiProducerStrategy<kRuntimeRingBufferSize>>
+      sequencer(RING_BUFFER_SIZE);
+  Sequence consumer;
+  sequencer.set_gating_sequences({&consumer});
+  BOOST_CHECK_EQUAL(sequencer.size(), RING_BUFFER_SIZE);
+
+  auto range = sequencer.ClaimRange(RING_BUFFER_SIZE);
+  for (size_t i = 0; i < range.size(); i++) range[i] = i;
+  sequencer.Publish(range);
+  BOOST_CHECK_EQUAL(sequencer.GetCursor(), RING_BUFFER_SIZE - 1L);
+  BOOST_CHECK_EQUAL(sequencer.TryClaim(), kInsufficientCapacitySignal);
+
+  consumer.set_sequence(1L);
+  const int64_t sequence = sequencer.Claim(2);
+  BOOST_CHECK_EQUAL(sequence, RING_BUFFER_SIZE + 1L);
+  sequencer[sequence] = 42;
+  BOOST_CHECK_EQUAL(sequencer[1L], 42);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(SequencerMultiProducer)
+
+BOOST_AUTO_TEST_CASE(ShouldDeliverEveryPublishedSequenceInOrder) {
+  constexpr size_t kRingSize = 64;
+  constexpr int64_t kProducers = 4;
+  constexpr int64_t kIterations = 2000;
+
+  Sequencer<int64_t, kRingSize, MultiProducerStrategy<kRingSize>> sequencer;
+  Sequence consumer;
+  sequencer.set_gating_sequences({&consumer});
+  std::unique_ptr<SequenceBarrier<>> barrier(sequencer.NewBarrier({}));
+
+  std::vector<std::thread> producers;
+  for (int64_t p = 0; p < kProducers; p++) {
+    producers.emplace_back([&sequencer]() {
+      for (int64_t i = 0; i < kIterations; i++) {
+        const int64_t sequence = sequencer.Claim();
+        sequencer[sequence] = sequence;
+        sequencer.Publish(sequence);
+      }
+    });
+  }
+
+  int64_t mismatches = 0;
+  int64_t next = kFirstSequenceValue;
+  while (next < kProducers * kIterations) {
+    const int64_t available = barrier->WaitFor(next);
+    for (; next <= available; next++)
+      if (sequencer[next] != next) mismatches++;
+    consumer.set_sequence(available);
+  }
+
+  for (auto& producer : producers) producer.join();
+  BOOST_CHECK_EQUAL(mismatches, 0);
+  BOOST_CHECK_EQUAL(sequencer.GetCursor(), kProducers * kIterations - 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
 };  // namepspace test
 };  // namepspace disruptor
@@ -0,0 +1,205 @@
+// Copyright (c) 2011-2015, Francois Saint-Jacques
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the disruptor-- nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL FRANCOIS SAINT-JACQUES BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE SharedSequencerTest
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <disruptor/shared_sequencer.h>
+
+#define RING_BUFFER_SIZE 8
+
+namespace disruptor {
+namespace test {
+
+struct SharedSequencerFixture {
+  SharedSequencerFixture()
+      : name("/disruptor-test-" + std::to_string(getpid())),
+        producer(name, RING_BUFFER_SIZE) {}
+
+  ~SharedSequencerFixture() { SharedSequencer<int64_t>::Unlink(name); }
+
+  std::string name;
+  SharedSequencer<int64_t> producer;
+};
+
+BOOST_FIXTURE_TEST_SUITE(SharedSequencerBasic, SharedSequencerFixture)
+
+BOOST_AUTO_TEST_CASE(ShouldShareSlotsAndCursor) {
+  SharedSequencer<int64_t> consumer(name);
+  BOOST_CHECK_EQUAL(consumer.size(), RING_BUFFER_SIZE);
+  BOOST_CHECK_EQUAL(consumer.GetCursor(), kInitialCursorValue);
+
+  const int64_t sequence = producer.Claim();
+  producer[sequence] = 42;
+  producer.Publish(sequence);
+
+  BOOST_CHECK_EQUAL(consumer.GetCursor(), sequence);
+  BOOST_CHECK_EQUAL(consumer[sequence], 42);
+}
+
+BOOST_AUTO_TEST_CASE(ConsumersShouldGateProducers) {
+  SharedSequencer<int64_t> consumer(name);
+  Sequence* sequence = consumer.AddConsumer();
+  BOOST_REQUIRE(sequence != nullptr);
+  BOOST_CHECK_EQUAL(sequence->sequence(), kInitialCursorValue);
+
+  producer.Publish(producer.Claim(RING_BUFFER_SIZE), RING_BUFFER_SIZE);
+  BOOST_CHECK_EQUAL(producer.TryClaim(), kInsufficientCapacitySignal);
+  sequence->set_sequence(0L);
+  BOOST_CHECK_EQUAL(producer.TryClaim(), RING_BUFFER_SIZE);
+
+  // a removed consumer no longer gates
+  consumer.RemoveConsumer(sequence);
+  BOOST_CHECK_EQUAL(producer.TryClaim(RING_BUFFER_SIZE), 2 * RING_BUFFER_SIZE);
+}
+
+BOOST_AUTO_TEST_CASE(ConsumersAddedWhileProducersWrapShouldGate) {
+  std::atomic<bool> running(true);
+  std::vector<std::thread> producers;
+  for (int i = 0; i < 2; i++) {
+    producers.emplace_back([this, &running] {
+      while (running.load()) {
+        const int64_t sequence = producer.Claim();
+        producer[sequence] = sequence;
+        producer.Publish(sequence);
+      }
+    });
+  }
+  SharedSequencer<int64_t> consumer(name);
+  int64_t overwritten = 0;
+  for (int run = 0; run < 50; run++) {
+    Sequence* sequence = consumer.AddConsumer();
+    BOOST_REQUIRE(sequence != nullptr);
+    // consume a few laps of the ring, each event holds its own sequence.
+    const int64_t until = sequence->sequence() + 4 * RING_BUFFER_SIZE;
+    for (int64_t next = sequence->sequence() + 1; next <= until; next++) {
+      while (consumer.GetCursor() < next) std::this_thread::yield();
+      if (consumer[next] != next) overwritten++;
+      sequence->set_sequence(next);
+    }
+    consumer.RemoveConsumer(sequence);
+  }
+  running = false;
+  for (auto& thread : producers) thread.join();
+  BOOST_CHECK_EQUAL(overwritten, 0);
+}
+
+BOOST_AUTO_TEST_CASE(ShouldRejectMismatchingRings) {
+  using OTHER_TYPE = SharedSequencer<int32_t>;
+  BOOST_CHECK_THROW(OTHER_TYPE other(name), std::runtime_error);
+  BOOST_CHECK_THROW(SharedSequencer<int64_t> missing(name + "-missing"),
+                    std::system_error);
+}
+
+BOOST_AUTO_TEST_CASE(ShouldReplaceARingStillAttached) {
+  const int64_t sequence = producer.Claim();
+  producer[sequence] = 42;
+  producer.Publish(sequence);
+
+  // the attached process keeps the previous region, intact.
+  SharedSequencer<int64_t> replaced(name, RING_BUFFER_SIZE);
+  BOOST_CHECK_EQUAL(producer.GetCursor(), sequence);
+  BOOST_CHECK_EQUAL(producer[sequence], 42);
+  BOOST_CHECK_EQUAL(replaced.GetCursor(), kInitialCursorValue);
+  SharedSequencer<int64_t> attached(name);
+  BOOST_CHECK_EQUAL(attached.GetCursor(), kInitialCursorValue);
+}
+
+BOOST_AUTO_TEST_CASE(ShouldReclaimConsumersOfExitedProcesses) {
+  const pid_t child = fork();
+  BOOST_REQUIRE(child >= 0);
+  if (child == 0) {
+    // consumer process exiting without RemoveConsumer().
+    SharedSequencer<int64_t> consumer(name);
+    _exit(consumer.AddConsumer() != nullptr ? 0 : 1);
+  }
+  int status = -1;
+  waitpid(child, &status, 0);
+  BOOST_REQUIRE(WIFEXITED(status));
+  BOOST_REQUIRE_EQUAL(WEXITSTATUS(status), 0);
+
+  Sequence* live = producer.AddConsumer();
+  BOOST_REQUIRE(live != nullptr);
+  producer.Publish(producer.Claim(RING_BUFFER_SIZE), RING_BUFFER_SIZE);
+  live->set_sequence(RING_BUFFER_SIZE - 1);
+  BOOST_CHECK_EQUAL(producer.TryClaim(), kInsufficientCapacitySignal);
+
+  // only the consumer of the exited process is removed.
+  BOOST_CHECK_EQUAL(producer.ReclaimConsumers(), 1);
+  BOOST_CHECK_EQUAL(producer.ReclaimConsumers(), 0);
+  BOOST_CHECK_EQUAL(producer.TryClaim(), RING_BUFFER_SIZE);
+  BOOST_CHECK_EQUAL(live->sequence(), RING_BUFFER_SIZE - 1);
+  producer.RemoveConsumer(live);
+}
+
+BOOST_AUTO_TEST_CASE(ShouldDeliverToAnotherProcess) {
+  const int64_t events = 10 * RING_BUFFER_SIZE;
+  std::unique_ptr<SharedSequencer<int64_t>> attached(
+      new SharedSequencer<int64_t>(name));
+  Sequence* consumed = attached->AddConsumer();
+
+  const pid_t child = fork();
+  BOOST_REQUIRE(child >= 0);
+  if (child == 0) {
+    // consumer process
+    std::unique_ptr<SequenceBarrier<>> barrier(attached->NewBarrier());
+    int mismatches = 0;
+    for (int64_t next = 0; next < events;) {
+      const int64_t available = barrier->WaitFor(next);
+      for (; next <= available; next++)
+        if ((*attached)[next] != next * 3) mismatches++;
+      consumed->set_sequence(available);
+    }
+    _exit(mismatches == 0 ? 0 : 1);
+  }
+
+  for (int64_t i = 0; i < events; i++) {
+    const int64_t sequence = producer.Claim();
+    producer[sequence] = sequence * 3;
+    producer.Publish(sequence);
+  }
+
+  int status = -1;
+  waitpid(child, &status, 0);
+  BOOST_CHECK(WIFEXITED(status));
+  BOOST_CHECK_EQUAL(WEXITSTATUS(status), 0);
+  BOOST_CHECK_EQUAL(consumed->sequence(), events - 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+};  // namespace test
+};  // namespace disruptor
@@ -0,0 +1,167 @@
+// Copyright (c) 2011-2015, Francois Saint-Jacques
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the disruptor-- nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL FRANCOIS SAINT-JACQUES BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+// THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE TracingTest
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <disruptor/handler.hpp>
+#include <disruptor/tracing.h>
+
+#define RING_BUFFER_SIZE 16
+
+namespace disruptor {
+namespace test {
+
+class CountingHandler : public Handler<int64_t> {
+ public:
+  virtual void process(const int64_t* pMD) noexcept override { ++events; }
+
+  int64_t events = 0;
+};
+
+BOOST_AUTO_TEST_SUITE(Tracing)
+
+BOOST_AUTO_TEST_CASE(HistogramBucketsShouldBoundTheirValues) {
+  const uint64_t values[] = {0, 1, 31, 32, 33, 63, 64, 65, 1000,
+                             123456789, 1ULL << 40, ~0ULL};
+  for (uint64_t value : values) {
+    const size_t bucket = LatencyHistogram::BucketOf(value);
+    BOOST_REQUIRE(bucket < LatencyHistogram::kBuckets);
+    const uint64_t highest = LatencyHistogram::HighestOf(bucket);
+    BOOST_CHECK(highest >= value);
+    BOOST_CHECK(highest - value <= value / 32);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(HistogramShouldReportPercentiles) {
+  LatencyHistogram histogram;
+  BOOST_CHECK_EQUAL(histogram.ValueAtPercentile(99.9), 0);
+  for (uint64_t i = 1; i <= 1000; i++) histogram.Record(i);
+
+  BOOST_CHECK_EQUAL(histogram.count(), 1000);
+  BOOST_CHECK_EQUAL(histogram.max(), 1000);
+  const uint64_t median = histogram.ValueAtPercentile(50);
+  BOOST_CHECK(median >= 500 && median <= 500 + 500 / 32);
+  const uint64_t p999 = histogram.ValueAtPercentile(99.9);
+  BOOST_CHECK(p999 >= 999 && p999 <= 1000);
+  BOOST_CHECK_EQUAL(histogram.ValueAtPercentile(100), 1000);
+
+  histogram.Reset();
+  BOOST_CHECK_EQUAL(histogram.count(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(TscClockShouldMeasureNanoseconds) {
+  const uint64_t begin = TscClock::Now();
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  const uint64_t elapsed = TscClock::ToNanoseconds(TscClock::Now() - begin);
+  BOOST_CHECK(elapsed >= 4000000);
+  BOOST_CHECK(elapsed < 1000000000);
+}
+
+BOOST_AUTO_TEST_CASE(ParallelDistributorShouldTraceEveryStage) {
+  Tracer tracer(2);
+  CountingHandler first, second;
+  ParallelDistributor<int64_t, RING_BUFFER_SIZE> distributor;
+  distributor.addHandler(&first);
+  distributor.addHandlerAfter(&second, {&first});
+  distributor.setTracer(&tracer);
+  distributor.start();
+
+  const int64_t events = 10 * RING_BUFFER_SIZE;
+  for (int64_t i = 0; i < events; i++) distributor.distribute(&i);
+  std::vector<int64_t> burst(RING_BUFFER_SIZE, 0);
+  distributor.distributeBatch(burst.data(), burst.size());
+  distributor.signal();
+  distributor.join();
+
+  const int64_t total = events + RING_BUFFER_SIZE;
+  BOOST_CHECK_EQUAL(tracer.stage(0).count(), total);
+  BOOST_CHECK_EQUAL(tracer.stage(1).count(), total);
+  const TraceRing* trace = distributor.traceRing();
+  BOOST_REQUIRE(trace != nullptr);
+  for (int64_t i = total - RING_BUFFER_SIZE; i < total; i++) {
+    BOOST_CHECK(trace->origin(i) != 0);
+    BOOST_CHECK(trace->handled(0, i) >= trace->origin(i));
+    BOOST_CHECK(trace->handled(1, i) >= trace->handled(0, i));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(ChainedDistributorsShouldKeepTheOrigin) {
+  Tracer tracer(2);
+  CountingHandler last;
+  // the connector owns the downstream distributor.
+  auto downstream = new ParallelDistributor<int64_t, RING_BUFFER_SIZE>();
+  downstream->addHandler(&last);
+  downstream->setTracer(&tracer, 1);
+  downstream->start();
+  std::unique_ptr<Connector<int64_t> > connector(make_connector(downstream));
+  ParallelDistributor<int64_t, RING_BUFFER_SIZE> upstream;
+  upstream.addHandler(connector.get());
+  upstream.setTracer(&tracer, 0);
+  upstream.start();
+
+  const int64_t events = RING_BUFFER_SIZE / 2;
+  for (int64_t i = 0; i < events; i++) upstream.distribute(&i);
+  upstream.signal();
+  upstream.join();
+  downstream->signal();
+  downstream->join();
+
+  BOOST_CHECK_EQUAL(last.events, events);
+  BOOST_CHECK_EQUAL(tracer.stage(1).count(), events);
+  for (int64_t i = 0; i < events; i++) {
+    BOOST_CHECK_EQUAL(downstream->traceRing()->origin(i),
+                      upstream.traceRing()->origin(i));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(CompositeDistributorShouldTraceItsRings) {
+  Tracer tracer(3);
+  CountingHandler handler_1, handler_2, handler_3;
+  CompositeDistributor<int64_t> distributor;
+  distributor.setTracer(&tracer);
+  distributor.addAsyncHandlerParellel<RING_BUFFER_SIZE>({&handler_1, &handler_2});
+  distributor.addAsyncHandlerSequential<RING_BUFFER_SIZE>({&handler_3});
+  distributor.start();
+
+  const int64_t events = 4 * RING_BUFFER_SIZE;
+  for (int64_t i = 0; i < events; i++) distributor.distribute(&i);
+  distributor.signal();
+  distributor.join();
+
+  for (size_t stage = 0; stage < tracer.stages(); stage++)
+    BOOST_CHECK_EQUAL(tracer.stage(stage).count(), events);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+};  // namespace test
+};  // namespace disruptor
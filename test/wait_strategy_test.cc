@@ -450,5 +450,292 @@ BOOST_AUTO_TEST_CASE(SignalAlertWaitingOnDependents) {
 
 BOOST_AUTO_TEST_SUITE_END()  // BlockingStrategy suite
 
+/* FutexBlockingStrategy */
+using FutexBlockingStrategyFixture = StrategyFixture<FutexBlockingStrategy<>>;
+BOOST_FIXTURE_TEST_SUITE(FutexBlockingStrategy, FutexBlockingStrategyFixture)
+
+BOOST_AUTO_TEST_CASE(WaitForCursor) {
+  std::atomic<int64_t> return_value(kInitialCursorValue);
+
+  std::thread waiter([this, &return_value]() {
+    return_value.store(
+        strategy.WaitFor(kFirstSequenceValue, cursor, dependents, alerted));
+  });
+
+  BOOST_CHECK_EQUAL(return_value.load(), kInitialCursorValue);
+  std::thread([this]() {
+    cursor.IncrementAndGet(1L);
+    strategy.SignalAllWhenBlocking();
+  }).join();
+  waiter.join();
+  BOOST_CHECK_EQUAL(return_value.load(), kFirstSequenceValue);
+}
+
+BOOST_AUTO_TEST_CASE(SignalAlertWaitingOnCursor) {
+  std::atomic<int64_t> return_value(kInitialCursorValue);
+
+  std::thread waiter([this, &return_value]() {
+    return_value.store(
+        strategy.WaitFor(kFirstSequenceValue, cursor, dependents, alerted));
+  });
+
+  std::thread([this]() { strategy.SignalAllWhenBlocking(); }).join();
+  BOOST_CHECK_EQUAL(return_value.load(), kInitialCursorValue);
+
+  std::thread([this]() {
+    alerted.store(true);
+    strategy.SignalAllWhenBlocking();
+  }).join();
+
+  waiter.join();
+  BOOST_CHECK_EQUAL(return_value.load(), kAlertedSignal);
+}
+
+BOOST_AUTO_TEST_CASE(SignalTimeoutWaitingOnCursor) {
+  std::atomic<int64_t> return_value(kInitialCursorValue);
+
+  std::thread waiter([this, &return_value]() {
+    return_value.store(strategy.WaitFor(kFirstSequenceValue, cursor, dependents,
+                                        alerted,
+                                        std::chrono::microseconds(1L)));
+  });
+
+  waiter.join();
+  BOOST_CHECK_EQUAL(return_value.load(), kTimeoutSignal);
+
+  std::thread waiter2([this, &return_value]() {
+    return_value.store(strategy.WaitFor(kFirstSequenceValue, cursor, dependents,
+                                        alerted, std::chrono::seconds(1L)));
+  });
+
+  cursor.IncrementAndGet(1L);
+  strategy.SignalAllWhenBlocking();
+  waiter2.join();
+  BOOST_CHECK_EQUAL(return_value.load(), kFirstSequenceValue);
+}
+
+BOOST_AUTO_TEST_CASE(WaitForDependents) {
+  std::atomic<int64_t> return_value(kInitialCursorValue);
+
+  std::thread waiter([this, &return_value]() {
+    return_value.store(strategy.WaitFor(kFirstSequenceValue, cursor,
+                                        allDependents(), alerted));
+  });
+
+  cursor.IncrementAndGet(1L);
+  strategy.SignalAllWhenBlocking();
+  // dependents haven't moved, WaitFor() should still block.
+  BOOST_CHECK_EQUAL(return_value.load(), kInitialCursorValue);
+
+  sequence_1.IncrementAndGet(1L);
+  BOOST_CHECK_EQUAL(return_value.load(), kInitialCursorValue);
+
+  sequence_2.IncrementAndGet(1L);
+  BOOST_CHECK_EQUAL(return_value.load(), kInitialCursorValue);
+
+  sequence_3.IncrementAndGet(1L);
+  waiter.join();
+  BOOST_CHECK_EQUAL(return_value.load(), kFirstSequenceValue);
+}
+
+BOOST_AUTO_TEST_CASE(SignalAlertWaitingOnDependents) {
+  std::atomic<int64_t> return_value(kInitialCursorValue);
+
+  std::thread waiter([this, &return_value]() {
+    return_value.store(strategy.WaitFor(kFirstSequenceValue, cursor,
+                                        allDependents(), alerted));
+  });
+
+  cursor.IncrementAndGet(1L);
+  strategy.SignalAllWhenBlocking();
+  // dependents haven't moved, WaitFor() should still block.
+  BOOST_CHECK_EQUAL(return_value.load(), kInitialCursorValue);
+
+  sequence_1.IncrementAndGet(1L);
+  BOOST_CHECK_EQUAL(return_value.load(), kInitialCursorValue);
+
+  sequence_2.IncrementAndGet(1L);
+  BOOST_CHECK_EQUAL(return_value.load(), kInitialCursorValue);
+
+  alerted.store(true);
+
+  waiter.join();
+  BOOST_CHECK_EQUAL(return_value.load(), kAlertedSignal);
+}
+
+BOOST_AUTO_TEST_SUITE_END()  // FutexBlockingStrategy suite
+
+/* EventFdStrategy */
+using EventFdStrategyFixture = StrategyFixture<EventFdStrategy<>>;
+BOOST_FIXTURE_TEST_SUITE(EventFdStrategy, EventFdStrategyFixture)
+
+BOOST_AUTO_TEST_CASE(WaitForCursor) {
+  std::atomic<int64_t> return_value(kInitialCursorValue);
+
+  std::thread waiter([this, &return_value]() {
+    return_value.store(
+        strategy.WaitFor(kFirstSequenceValue, cursor, dependents, alerted));
+  });
+
+  BOOST_CHECK_EQUAL(return_value.load(), kInitialCursorValue);
+  std::thread([this]() {
+    cursor.IncrementAndGet(1L);
+    strategy.SignalAllWhenBlocking();
+  }).join();
+  waiter.join();
+  BOOST_CHECK_EQUAL(return_value.load(), kFirstSequenceValue);
+}
+
+BOOST_AUTO_TEST_CASE(SignalAlertWaitingOnCursor) {
+  std::atomic<int64_t> return_value(kInitialCursorValue);
+
+  std::thread waiter([this, &return_value]() {
+    return_value.store(
+        strategy.WaitFor(kFirstSequenceValue, cursor, dependents, alerted));
+  });
+
+  std::thread([this]() { strategy.SignalAllWhenBlocking(); }).join();
+  BOOST_CHECK_EQUAL(return_value.load(), kInitialCursorValue);
+
+  std::thread([this]() {
+    alerted.store(true);
+    strategy.SignalAllWhenBlocking();
+  }).join();
+
+  waiter.join();
+  BOOST_CHECK_EQUAL(return_value.load(), kAlertedSignal);
+}
+
+BOOST_AUTO_TEST_CASE(SignalTimeoutWaitingOnCursor) {
+  std::atomic<int64_t> return_value(kInitialCursorValue);
+
+  std::thread waiter([this, &return_value]() {
+    return_value.store(strategy.WaitFor(kFirstSequenceValue, cursor, dependents,
+                                        alerted,
+                                        std::chrono::microseconds(1L)));
+  });
+
+  waiter.join();
+  BOOST_CHECK_EQUAL(return_value.load(), kTimeoutSignal);
+
+  std::thread waiter2([this, &return_value]() {
+    return_value.store(strategy.WaitFor(kFirstSequenceValue, cursor, dependents,
+                                        alerted, std::chrono::seconds(1L)));
+  });
+
+  cursor.IncrementAndGet(1L);
+  strategy.SignalAllWhenBlocking();
+  waiter2.join();
+  BOOST_CHECK_EQUAL(return_value.load(), kFirstSequenceValue);
+}
+
+BOOST_AUTO_TEST_CASE(WaitForDependents) {
+  std::atomic<int64_t> return_value(kInitialCursorValue);
+
+  std::thread waiter([this, &return_value]() {
+    return_value.store(strategy.WaitFor(kFirstSequenceValue, cursor,
+                                        allDependents(), alerted));
+  });
+
+  cursor.IncrementAndGet(1L);
+  strategy.SignalAllWhenBlocking();
+  // dependents haven't moved, WaitFor() should still block.
+  BOOST_CHECK_EQUAL(return_value.load(), kInitialCursorValue);
+
+  sequence_1.IncrementAndGet(1L);
+  BOOST_CHECK_EQUAL(return_value.load(), kInitialCursorValue);
+
+  sequence_2.IncrementAndGet(1L);
+  BOOST_CHECK_EQUAL(return_value.load(), kInitialCursorValue);
+
+  sequence_3.IncrementAndGet(1L);
+  waiter.join();
+  BOOST_CHECK_EQUAL(return_value.load(), kFirstSequenceValue);
+}
+
+BOOST_AUTO_TEST_CASE(SignalAlertWaitingOnDependents) {
+  std::atomic<int64_t> return_value(kInitialCursorValue);
+
+  std::thread waiter([this, &return_value]() {
+    return_value.store(strategy.WaitFor(kFirstSequenceValue, cursor,
+                                        allDependents(), alerted));
+  });
+
+  cursor.IncrementAndGet(1L);
+  strategy.SignalAllWhenBlocking();
+  // dependents haven't moved, WaitFor() should still block.
+  BOOST_CHECK_EQUAL(return_value.load(), kInitialCursorValue);
+
+  sequence_1.IncrementAndGet(1L);
+  BOOST_CHECK_EQUAL(return_value.load(), kInitialCursorValue);
+
+  sequence_2.IncrementAndGet(1L);
+  BOOST_CHECK_EQUAL(return_value.load(), kInitialCursorValue);
+
+  alerted.store(true);
+
+  waiter.join();
+  BOOST_CHECK_EQUAL(return_value.load(), kAlertedSignal);
+}
+
+BOOST_AUTO_TEST_SUITE_END()  // EventFdStrategy suite
+
+BOOST_FIXTURE_TEST_CASE(WaitForCursorWhileParked,
+                        FutexBlockingStrategyFixture) {
+  std::atomic<int64_t> return_value(kInitialCursorValue);
+
+  std::thread waiter([this, &return_value]() {
+    return_value.store(
+        strategy.WaitFor(kFirstSequenceValue, cursor, dependents, alerted));
+  });
+
+  // leave the waiter enough time to go through its spin and yield phases.
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  BOOST_CHECK_EQUAL(return_value.load(), kInitialCursorValue);
+
+  cursor.IncrementAndGet(1L);
+  strategy.SignalAllWhenBlocking();
+  waiter.join();
+  BOOST_CHECK_EQUAL(return_value.load(), kFirstSequenceValue);
+}
+
+BOOST_AUTO_TEST_CASE(DeadlineShouldOnlyReadTheClockEveryCheckLoops) {
+  Deadline expired(std::chrono::nanoseconds(0));
+  BOOST_CHECK(expired.ExpiredNow());
+  BOOST_CHECK(expired.Remaining().count() <= 0);
+  for (int64_t i = 1; i < kDeadlineCheckLoops; i++)
+    BOOST_CHECK(!expired.Expired());
+  BOOST_CHECK(expired.Expired());
+
+  Deadline pending(std::chrono::seconds(10));
+  for (int64_t i = 0; i < 2 * kDeadlineCheckLoops; i++)
+    BOOST_CHECK(!pending.Expired());
+  BOOST_CHECK(pending.Remaining() > std::chrono::seconds(1));
+}
+
+BOOST_FIXTURE_TEST_CASE(SignalsShouldNotExtendTheTimeout,
+                        BlockingStrategyFixture) {
+  std::atomic<int64_t> return_value(kInitialCursorValue);
+  std::atomic<bool> waiting(true);
+
+  const auto start = std::chrono::steady_clock::now();
+  std::thread waiter([this, &return_value, &waiting]() {
+    return_value.store(strategy.WaitFor(kFirstSequenceValue, cursor, dependents,
+                                        alerted,
+                                        std::chrono::milliseconds(20)));
+    waiting.store(false);
+  });
+
+  // publications that do not reach the sequence keep waking the waiter up.
+  while (waiting.load()) {
+    strategy.SignalAllWhenBlocking();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  waiter.join();
+  BOOST_CHECK_EQUAL(return_value.load(), kTimeoutSignal);
+  BOOST_CHECK(std::chrono::steady_clock::now() - start <
+              std::chrono::seconds(1));
+}
+
 };  // namespace test
 };  // namespace disruptor